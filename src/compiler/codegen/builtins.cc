@@ -100,10 +100,7 @@ namespace verona::compiler
     args.push_back(Register(1));
     args.push_back(Register(0));
 
-    gen_.opcode(Opcode::ClearList);
-    gen_.reglist(args);
-
-    gen_.opcode(Opcode::Return);
+    emit_clear_return(args);
   }
 
   void BuiltinGenerator::builtin_freeze()
@@ -114,9 +111,7 @@ namespace verona::compiler
     gen_.opcode(Opcode::Freeze);
     gen_.reg(Register(0));
     gen_.reg(Register(1));
-    gen_.opcode(Opcode::Clear);
-    gen_.reg(Register(1));
-    gen_.opcode(Opcode::Return);
+    emit_clear_return({Register(1)});
   }
 
   void BuiltinGenerator::builtin_trace_region()
@@ -126,9 +121,7 @@ namespace verona::compiler
 
     gen_.opcode(Opcode::TraceRegion);
     gen_.reg(Register(1));
-    gen_.opcode(Opcode::ClearList);
-    gen_.reglist({Register(0), Register(1)});
-    gen_.opcode(Opcode::Return);
+    emit_clear_return({Register(0), Register(1)});
   }
 
   void BuiltinGenerator::builtin_binop(bytecode::BinaryOperator op)
@@ -141,9 +134,7 @@ namespace verona::compiler
     gen_.u8(static_cast<uint8_t>(op));
     gen_.reg(Register(0));
     gen_.reg(Register(1));
-    gen_.opcode(Opcode::Clear);
-    gen_.reg(Register(1));
-    gen_.opcode(Opcode::Return);
+    emit_clear_return({Register(1)});
   }
 
   void BuiltinGenerator::builtin_cown_create()
@@ -158,9 +149,7 @@ namespace verona::compiler
     gen_.reg(Register(0));
     gen_.reg(Register(1));
 
-    gen_.opcode(Opcode::Clear);
-    gen_.reg(Register(1));
-    gen_.opcode(Opcode::Return);
+    emit_clear_return({Register(1)});
   }
 
   void BuiltinGenerator::builtin_cown_create_sleeping()
@@ -184,8 +173,6 @@ namespace verona::compiler
     gen_.opcode(Opcode::FulfillSleepingCown);
     gen_.reg(Register(0));
     gen_.reg(Register(1));
-    gen_.opcode(Opcode::ClearList);
-    gen_.reglist({Register(0), Register(1)});
-    gen_.opcode(Opcode::Return);
+    emit_clear_return({Register(0), Register(1)});
   }
 }
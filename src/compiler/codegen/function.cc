@@ -98,6 +98,25 @@ namespace verona::compiler
     gen_.descriptor(desc);
   }
 
+  void FunctionGenerator::emit_call(
+    const FunctionABI& child_abi,
+    bytecode::SelectorIdx selector,
+    const std::vector<Register>& args)
+  {
+    assert(args.size() <= child_abi.callspace());
+
+    gen_.opcode(Opcode::CallArgs);
+    gen_.selector(selector);
+    gen_.u8(truncate<uint8_t>(child_abi.callspace()));
+    gen_.reglist(args);
+  }
+
+  void FunctionGenerator::emit_clear_return(const std::vector<Register>& dead)
+  {
+    gen_.opcode(Opcode::ClearReturn);
+    gen_.reglist(dead);
+  }
+
   void emit_function(
     Context& context,
     const Reachability& reachability,
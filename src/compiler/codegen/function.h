@@ -173,6 +173,23 @@ namespace verona::compiler
      */
     void emit_load_descriptor(Register dst, Descriptor desc);
 
+    /**
+     * Emit a call instruction, which first copies each of the `args` registers
+     * to the child-relative register of the same index.
+     */
+    void emit_call(
+      const FunctionABI& child_abi,
+      bytecode::SelectorIdx selector,
+      const std::vector<Register>& args);
+
+    /**
+     * Emit a return instruction, which first clears the `dead` registers.
+     *
+     * The return value must already be in register 0. Any other register still
+     * in use must be listed in `dead`.
+     */
+    void emit_clear_return(const std::vector<Register>& dead);
+
   protected:
     Context& context_;
     Generator& gen_;
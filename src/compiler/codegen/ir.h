@@ -7,6 +7,7 @@
 #include "compiler/visitor.h"
 #include "compiler/zip.h"
 
+#include <algorithm>
 #include <fmt/ostream.h>
 
 namespace verona::compiler
@@ -49,17 +50,45 @@ namespace verona::compiler
       {
         gen_.define_label(basic_block_label(bb));
 
+        const std::vector<Statement>& statements = bb->statements;
         std::vector<Liveness> live_out = liveness_.statements_out(bb);
-        for (const auto& [stmt, stmt_live_out] :
-             safe_zip(bb->statements, live_out))
+        assert(statements.size() == live_out.size());
+
+        // The scope ending just before a return is cleared by the return
+        // instruction itself.
+        const Terminator& term = bb->terminator.value();
+        const auto* end_scope = statements.empty() ?
+          nullptr :
+          std::get_if<EndScopeStmt>(&statements.back());
+        bool returns = std::holds_alternative<ReturnTerminator>(term);
+        size_t count = statements.size();
+        if (end_scope != nullptr && returns)
+          count--;
+        else
+          end_scope = nullptr;
+
+        for (size_t i = 0; i < count; i++)
         {
-          const auto& stmt_live_out_ = stmt_live_out;
+          // Adjacent field reads are done by a single instruction.
+          const auto* read = std::get_if<ReadFieldStmt>(&statements[i]);
+          const auto* next_read = i + 1 < count ?
+            std::get_if<ReadFieldStmt>(&statements[i + 1]) :
+            nullptr;
+          if (read != nullptr && next_read != nullptr)
+          {
+            emit_load_load(*read, *next_read);
+            i++;
+            continue;
+          }
+
           std::visit(
-            [&](const auto& s) { visit_stmt(s, stmt_live_out_); }, stmt);
+            [&](const auto& s) { visit_stmt(s, live_out[i]); }, statements[i]);
         }
 
-        const Terminator& term = bb->terminator.value();
-        std::visit([&](const auto& t) { visit_term(t); }, term);
+        if (end_scope != nullptr)
+          visit_term(std::get<ReturnTerminator>(term), end_scope);
+        else
+          std::visit([&](const auto& t) { visit_term(t); }, term);
       }
     }
 
@@ -155,20 +184,18 @@ namespace verona::compiler
       FunctionABI abi(stmt);
       allocator_.reserve_child_callspace(abi);
 
-      size_t index = 0;
-      emit_copy_to_child(
-        abi, Register(truncate<uint8_t>(index++)), variable(stmt.receiver));
+      std::vector<Register> args;
+      args.push_back(variable(stmt.receiver));
       for (const auto& var : stmt.arguments)
       {
-        Register reg = variable(var);
-        emit_copy_to_child(abi, Register(truncate<uint8_t>(index++)), reg);
+        args.push_back(variable(var));
       }
 
-      protect_live_registers(stmt, live_out, [&]() {
-        gen_.opcode(Opcode::Call);
-        gen_.selector(selector);
-        gen_.u8(truncate<uint8_t>(abi.callspace()));
-      });
+      // The arguments are copied by the call instruction, after the live
+      // registers are protected. This is fine since the copies only write to
+      // the child's registers, which are never protected.
+      protect_live_registers(
+        stmt, live_out, [&]() { emit_call(abi, selector, args); });
 
       Register output = variable(stmt.output);
       emit_move_from_child(abi, output, Register(0));
@@ -257,6 +284,27 @@ namespace verona::compiler
       gen_.selector(field_selector_index(stmt.name));
     }
 
+    /**
+     * Emit a single instruction for two consecutive field reads.
+     */
+    void emit_load_load(const ReadFieldStmt& first, const ReadFieldStmt& second)
+    {
+      // Registers are allocated in the same order as if each read was visited
+      // on its own.
+      Register first_base = variable(first.base);
+      Register first_output = variable(first.output);
+      Register second_base = variable(second.base);
+      Register second_output = variable(second.output);
+
+      gen_.opcode(Opcode::LoadLoad);
+      gen_.reg(first_output);
+      gen_.reg(first_base);
+      gen_.selector(field_selector_index(first.name));
+      gen_.reg(second_output);
+      gen_.reg(second_base);
+      gen_.selector(field_selector_index(second.name));
+    }
+
     void visit_stmt(const WriteFieldStmt& stmt, const Liveness& live_out)
     {
       Register base = variable(stmt.base);
@@ -380,18 +428,45 @@ namespace verona::compiler
       reference_basic_block(term.false_target, opcode_start);
     }
 
-    void visit_term(const ReturnTerminator& term)
+    /**
+     * Emit the return. If the function's last scope ends just before it, its
+     * variables are cleared by the same instruction.
+     */
+    void visit_term(
+      const ReturnTerminator& term, const EndScopeStmt* end_scope = nullptr)
     {
       Register input = variable(term.input);
 
+      std::vector<Register> dead;
+      if (end_scope != nullptr)
+      {
+        for (Variable v : end_scope->dead_variables)
+        {
+          dead.push_back(variable(v));
+        }
+      }
+
       if (input.index != 0)
       {
+        // The copy overwrites register 0, which holds the receiver of a
+        // method. If it is dead, the scope's variables must be cleared before
+        // it is replaced by the return value.
+        bool receiver_dead =
+          std::any_of(dead.begin(), dead.end(), [](Register reg) {
+            return reg.index == 0;
+          });
+        if (receiver_dead)
+        {
+          gen_.opcode(Opcode::ClearList);
+          gen_.reglist(dead);
+          dead.clear();
+        }
+
         emit_copy(Register(0), input);
-        gen_.opcode(Opcode::Clear);
-        gen_.reg(input);
+        dead.push_back(input);
       }
 
-      gen_.opcode(Opcode::Return);
+      emit_clear_return(dead);
     }
 
     /**
@@ -14,6 +14,112 @@ namespace verona::bytecode
     return out;
   }
 
+  std::ostream& operator<<(std::ostream& out, const Opcode& self)
+  {
+    switch (self)
+    {
+      case Opcode::BinOp:
+        fmt::print(out, "BinOp");
+        break;
+      case Opcode::Call:
+        fmt::print(out, "Call");
+        break;
+      case Opcode::Clear:
+        fmt::print(out, "Clear");
+        break;
+      case Opcode::ClearList:
+        fmt::print(out, "ClearList");
+        break;
+      case Opcode::Copy:
+        fmt::print(out, "Copy");
+        break;
+      case Opcode::FulfillSleepingCown:
+        fmt::print(out, "FulfillSleepingCown");
+        break;
+      case Opcode::Freeze:
+        fmt::print(out, "Freeze");
+        break;
+      case Opcode::Int64:
+        fmt::print(out, "Int64");
+        break;
+      case Opcode::String:
+        fmt::print(out, "String");
+        break;
+      case Opcode::Jump:
+        fmt::print(out, "Jump");
+        break;
+      case Opcode::JumpIf:
+        fmt::print(out, "JumpIf");
+        break;
+      case Opcode::Load:
+        fmt::print(out, "Load");
+        break;
+      case Opcode::LoadDescriptor:
+        fmt::print(out, "LoadDescriptor");
+        break;
+      case Opcode::Match:
+        fmt::print(out, "Match");
+        break;
+      case Opcode::Merge:
+        fmt::print(out, "Merge");
+        break;
+      case Opcode::Move:
+        fmt::print(out, "Move");
+        break;
+      case Opcode::MutView:
+        fmt::print(out, "MutView");
+        break;
+      case Opcode::NewObject:
+        fmt::print(out, "NewObject");
+        break;
+      case Opcode::NewCown:
+        fmt::print(out, "NewCown");
+        break;
+      case Opcode::NewRegion:
+        fmt::print(out, "NewRegion");
+        break;
+      case Opcode::NewSleepingCown:
+        fmt::print(out, "NewSleepingCown");
+        break;
+      case Opcode::Print:
+        fmt::print(out, "Print");
+        break;
+      case Opcode::Protect:
+        fmt::print(out, "Protect");
+        break;
+      case Opcode::Return:
+        fmt::print(out, "Return");
+        break;
+      case Opcode::Store:
+        fmt::print(out, "Store");
+        break;
+      case Opcode::TraceRegion:
+        fmt::print(out, "TraceRegion");
+        break;
+      case Opcode::Unprotect:
+        fmt::print(out, "Unprotect");
+        break;
+      case Opcode::Unreachable:
+        fmt::print(out, "Unreachable");
+        break;
+      case Opcode::When:
+        fmt::print(out, "When");
+        break;
+      case Opcode::CallArgs:
+        fmt::print(out, "CallArgs");
+        break;
+      case Opcode::ClearReturn:
+        fmt::print(out, "ClearReturn");
+        break;
+      case Opcode::LoadLoad:
+        fmt::print(out, "LoadLoad");
+        break;
+
+        EXHAUSTIVE_SWITCH;
+    }
+    return out;
+  }
+
   std::ostream& operator<<(std::ostream& out, const BinaryOperator& self)
   {
     switch (self)
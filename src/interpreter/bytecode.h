@@ -115,6 +115,15 @@
  * call stack and the arguments are restored onto that VM instance's register
  * file.
  *
+ * # Superinstructions
+ *
+ * A few opcodes fuse sequences of instructions that the compiler emits very
+ * often, so that the VM dispatches once for the whole sequence:
+ * - CallArgs copies its arguments to the start of the call space, then calls.
+ * - LoadLoad performs two Loads, one after the other.
+ * - ClearReturn clears a list of registers, then returns. It also clears any
+ *   other register of the frame except the return values, so the VM does not
+ *   need to check that they have all been cleared.
  */
 namespace verona::bytecode
 {
@@ -225,7 +234,13 @@ namespace verona::bytecode
     Unreachable,
     When, // codepointer(u32), cown count(u8), capture count(u8)
 
-    maximum_value = When,
+    // Superinstructions come last, so that the other opcodes keep the numbers
+    // they had before superinstructions were added.
+    CallArgs, // selector(u32), callspace(u8), argc(u8), src(u8)...
+    ClearReturn, // argc(u8), dst(u8)...
+    LoadLoad, // 2x (dst(u8), base(u8), selector(u32))
+
+    maximum_value = LoadLoad,
   };
 
   enum class BinaryOperator : uint8_t
@@ -276,6 +291,13 @@ namespace verona::bytecode
     constexpr static std::string_view format = "CALL {}, {:#x}";
   };
 
+  template<>
+  struct OpcodeSpec<Opcode::CallArgs>
+  {
+    using Operands = OpcodeOperands<SelectorIdx, uint8_t, RegisterSpan>;
+    constexpr static std::string_view format = "CALL_ARGS {}, {:#x}, {}";
+  };
+
   template<>
   struct OpcodeSpec<Opcode::Clear>
   {
@@ -290,6 +312,13 @@ namespace verona::bytecode
     constexpr static std::string_view format = "CLEAR_LIST {}";
   };
 
+  template<>
+  struct OpcodeSpec<Opcode::ClearReturn>
+  {
+    using Operands = OpcodeOperands<RegisterSpan>;
+    constexpr static std::string_view format = "CLEAR_RETURN {}";
+  };
+
   template<>
   struct OpcodeSpec<Opcode::Copy>
   {
@@ -346,6 +375,20 @@ namespace verona::bytecode
     constexpr static std::string_view format = "LOAD_DESCRIPTOR {}, {:#x}";
   };
 
+  template<>
+  struct OpcodeSpec<Opcode::LoadLoad>
+  {
+    using Operands = OpcodeOperands<
+      Register,
+      Register,
+      SelectorIdx,
+      Register,
+      Register,
+      SelectorIdx>;
+    constexpr static std::string_view format =
+      "LOAD_LOAD {}, {}[{:#x}], {}, {}[{:#x}]";
+  };
+
   template<>
   struct OpcodeSpec<Opcode::Match>
   {
@@ -459,5 +502,6 @@ namespace verona::bytecode
   };
 
   std::ostream& operator<<(std::ostream& out, const Register& self);
+  std::ostream& operator<<(std::ostream& out, const Opcode& self);
   std::ostream& operator<<(std::ostream& out, const BinaryOperator& self);
 }
@@ -3,10 +3,14 @@
 #pragma once
 
 #include "interpreter/bytecode.h"
+#include "interpreter/function.h"
 #include "interpreter/object.h"
 
 #include <fmt/ostream.h>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <verona.h>
 
 namespace verona::interpreter
@@ -29,12 +33,19 @@ namespace verona::interpreter
     const VMDescriptor* u64;
   };
 
+  class Code;
+
+  /**
+   * Verify a function once it has been decoded. Defined in verifier.cc.
+   */
+  void verify(const Code& code, const Function& function);
+
   class Code
   {
   public:
     void check(size_t ip, size_t len) const
     {
-      if ((ip + len) > data_.size())
+      if ((ip + len) > size_)
       {
         std::stringstream s;
         s << "Instruction overflow " << ip << " " << len;
@@ -135,38 +146,89 @@ namespace verona::interpreter
       return header;
     }
 
-    Code(std::vector<uint8_t> code) : data_(std::move(code))
+    /**
+     * Load a program from a copy of its bytecode.
+     */
+    Code(std::vector<uint8_t> code)
     {
-      size_t ip = 0;
+      auto owned =
+        std::make_shared<const std::vector<uint8_t>>(std::move(code));
+      data_ = owned->data();
+      size_ = owned->size();
+      owner_ = std::move(owned);
+      load();
+    }
 
-      check_verona_nums(ip);
+    /**
+     * Load a program from `size` bytes of bytecode at `data`, which `owner`
+     * keeps alive and unmodified for the lifetime of the Code, for instance a
+     * read-only file mapping.
+     */
+    Code(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+    : owner_(std::move(owner)), data_(data), size_(size)
+    {
+      load();
+    }
 
-      uint32_t descriptors_count = u32(ip);
-      for (uint32_t i = 0; i < descriptors_count; i++)
-      {
-        descriptors_.push_back(load_descriptor(ip));
-      }
+    Code(const Code&) = delete;
+    Code& operator=(const Code&) = delete;
 
-      special_descriptors_.main = get_descriptor(load<DescriptorIdx>(ip));
-      special_descriptors_.main_selector = load<SelectorIdx>(ip);
-      special_descriptors_.u64 =
-        get_optional_descriptor(load<DescriptorIdx>(ip));
+    /**
+     * Get a function ready to be executed, decoding it and, if `verify` is
+     * set, verifying it the first time it is needed.
+     *
+     * This may be called concurrently by the VMs of every thread.
+     */
+    const Function* prepare(const Function* function, bool verify) const
+    {
+      if (!function->decoded.load(std::memory_order_acquire))
+        prepare_slow(const_cast<Function*>(function), verify);
+      return function;
     }
 
-    const std::vector<std::unique_ptr<const VMDescriptor>>& descriptors()
+    const std::vector<std::unique_ptr<const VMDescriptor>>& descriptors() const
     {
       return descriptors_;
     }
 
+    /**
+     * The largest method and field vtables of any descriptor.
+     */
+    size_t max_method_slots() const
+    {
+      return max_method_slots_;
+    }
+
+    size_t max_field_slots() const
+    {
+      return max_field_slots_;
+    }
+
     const SpecialDescriptors& special_descriptors() const
     {
       return special_descriptors_;
     }
 
-    size_t entrypoint() const
+    const Function* entrypoint() const
     {
       SelectorIdx selector = special_descriptors_.main_selector;
-      return special_descriptors_.main->methods[selector];
+      return special_descriptors_.main->method_entries[selector];
+    }
+
+    /**
+     * Get the function whose header starts at `address`. It may not have been
+     * decoded yet, see `prepare`.
+     */
+    const Function* get_function(CodePtr address) const
+    {
+      auto it = functions_.find(address);
+      if (it == functions_.end())
+      {
+        std::stringstream s;
+        s << "Invalid function address " << address;
+        throw std::logic_error(s.str());
+      }
+      return it->second.get();
     }
 
     const VMDescriptor* get_descriptor(DescriptorIdx desc) const
@@ -189,11 +251,71 @@ namespace verona::interpreter
     }
 
   private:
-    const std::vector<uint8_t> data_;
+    std::shared_ptr<const void> owner_;
+    const uint8_t* data_;
+    size_t size_;
+
     std::vector<std::unique_ptr<const VMDescriptor>> descriptors_;
+    std::unordered_map<CodePtr, std::unique_ptr<Function>> functions_;
+    size_t max_method_slots_ = 0;
+    size_t max_field_slots_ = 0;
 
     SpecialDescriptors special_descriptors_;
 
+    // Functions are decoded lazily, and one at a time.
+    mutable std::mutex decode_mutex_;
+
+    // String literals of the program, keyed by their contents in `data_`.
+    // Only used while decoding.
+    mutable std::unordered_map<std::string_view, std::unique_ptr<VMString>>
+      strings_;
+
+    /**
+     * Load the program header and descriptors, and find the functions. The
+     * bodies of the functions are only decoded when they are first needed.
+     */
+    void load()
+    {
+      size_t ip = 0;
+
+      check_verona_nums(ip);
+
+      std::vector<std::unique_ptr<VMDescriptor>> descriptors;
+      uint32_t descriptors_count = u32(ip);
+      for (uint32_t i = 0; i < descriptors_count; i++)
+      {
+        descriptors.push_back(load_descriptor(ip));
+      }
+
+      DescriptorIdx main = load<DescriptorIdx>(ip);
+      SelectorIdx main_selector = load<SelectorIdx>(ip);
+      DescriptorIdx u64 = load<DescriptorIdx>(ip);
+
+      // Functions follow the program header, up to the end of the bytecode.
+      find_functions(ip);
+
+      for (auto& descriptor : descriptors)
+      {
+        resolve_methods(*descriptor);
+        max_method_slots_ =
+          std::max<size_t>(max_method_slots_, descriptor->method_slots);
+        max_field_slots_ =
+          std::max<size_t>(max_field_slots_, descriptor->field_slots);
+        descriptors_.push_back(std::move(descriptor));
+      }
+
+      special_descriptors_.main = get_descriptor(main);
+      special_descriptors_.main_selector = main_selector;
+      special_descriptors_.u64 = get_optional_descriptor(u64);
+
+      if (
+        (main_selector >= special_descriptors_.main->method_slots) ||
+        (entrypoint() == nullptr))
+      {
+        throw std::logic_error("Invalid main method");
+      }
+    }
+
     void check_verona_nums(size_t& ip)
     {
       uint32_t nums = u32(ip);
@@ -232,6 +354,176 @@ namespace verona::interpreter
       return descriptor;
     }
 
+    /**
+     * Create an undecoded Function for each function header, skipping over
+     * their bodies.
+     */
+    void find_functions(size_t ip)
+    {
+      while (ip < size_)
+      {
+        auto function = std::make_unique<Function>();
+        function->address = truncate<CodePtr>(ip);
+        function->header = function_header(ip);
+        check(ip, function->header.size);
+        ip += function->header.size;
+
+        CodePtr address = function->address;
+        functions_.emplace(address, std::move(function));
+      }
+    }
+
+    void prepare_slow(Function* function, bool verify) const
+    {
+      std::lock_guard<std::mutex> guard(decode_mutex_);
+      if (function->decoded.load(std::memory_order_relaxed))
+        return;
+
+      decode_function(*function);
+      if (verify)
+        interpreter::verify(*this, *function);
+
+      function->decoded.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Decode the body of a function.
+     */
+    void decode_function(Function& function) const
+    {
+      size_t ip = function.address;
+      function_header(ip);
+
+      size_t start = ip;
+      size_t end = start + function.header.size;
+
+      // The first pass finds where each instruction starts, so that jumps can
+      // be resolved in the second pass. The position just past the end of the
+      // body maps to the trailing Unreachable instruction.
+      static constexpr size_t NOT_AN_INSTRUCTION = SIZE_MAX;
+      std::vector<size_t> index(function.header.size + 1, NOT_AN_INSTRUCTION);
+      size_t count = 0;
+      size_t calls = 0;
+      for (ip = start; ip < end;)
+      {
+        index[ip - start] = count++;
+        visit_opcode(opcode(ip), [&](auto op) {
+          constexpr Opcode opcode = decltype(op)::value;
+          load_operands<opcode>(ip);
+          if constexpr (opcode == Opcode::Call || opcode == Opcode::CallArgs)
+            calls++;
+        });
+      }
+      index[function.header.size] = count;
+
+      if (ip != end)
+        throw std::logic_error("Instruction overflows function body");
+
+      auto& instructions = function.instructions;
+      instructions.resize(count + 1);
+      function.call_caches = std::make_unique<CallCache[]>(calls);
+      CallCache* call_cache = function.call_caches.get();
+
+      auto label = [&](size_t position, int16_t offset) -> const Instruction* {
+        ptrdiff_t target = static_cast<ptrdiff_t>(position - start) + offset;
+        if (
+          (target < 0) || (static_cast<size_t>(target) > (end - start)) ||
+          (index[target] == NOT_AN_INSTRUCTION))
+        {
+          std::stringstream s;
+          s << "Invalid jump target "
+            << (static_cast<ptrdiff_t>(position) + offset);
+          throw std::logic_error(s.str());
+        }
+        return &instructions[index[target]];
+      };
+
+      Instruction* instruction = instructions.data();
+      for (ip = start; ip < end; instruction++)
+      {
+        size_t position = ip;
+        instruction->offset = truncate<uint32_t>(position);
+        visit_opcode(opcode(ip), [&](auto op) {
+          constexpr Opcode opcode = decltype(op)::value;
+          auto operands = load_operands<opcode>(ip);
+
+          if constexpr (opcode == Opcode::Jump)
+          {
+            auto [offset] = operands;
+            instruction->set_operands<opcode>({label(position, offset)});
+          }
+          else if constexpr (opcode == Opcode::JumpIf)
+          {
+            auto [condition, offset] = operands;
+            instruction->set_operands<opcode>(
+              {condition, label(position, offset)});
+          }
+          else if constexpr (opcode == Opcode::Call)
+          {
+            auto [selector, callspace] = operands;
+            instruction->set_operands<opcode>(
+              {selector, callspace, call_cache++});
+          }
+          else if constexpr (opcode == Opcode::CallArgs)
+          {
+            auto [selector, callspace, args] = operands;
+            instruction->set_operands<opcode>(
+              {selector,
+               callspace,
+               truncate<uint8_t>(args.size()),
+               args.begin(),
+               call_cache++});
+          }
+          else if constexpr (opcode == Opcode::String)
+          {
+            auto [dst, value] = operands;
+            instruction->set_operands<opcode>({dst, intern(value)});
+          }
+          else if constexpr (opcode == Opcode::When)
+          {
+            auto [closure, cown_count, capture_count] = operands;
+            instruction->set_operands<opcode>(
+              {get_function(closure), cown_count, capture_count});
+          }
+          else
+          {
+            instruction->set_operands<opcode>(operands);
+          }
+        });
+      }
+
+      instruction->offset = truncate<uint32_t>(end);
+      instruction->set_operands<Opcode::Unreachable>({});
+    }
+
+    /**
+     * Get the interned copy of a string literal, shared by every occurrence of
+     * the literal in the program. `value` must point into `data_`.
+     */
+    const VMString* intern(std::string_view value) const
+    {
+      auto& entry = strings_[value];
+      if (entry == nullptr)
+        entry = std::make_unique<VMString>(VMString{std::string(value)});
+      return entry.get();
+    }
+
+    /**
+     * Resolve the method and finaliser offsets of a descriptor to decoded
+     * functions.
+     */
+    void resolve_methods(VMDescriptor& descriptor)
+    {
+      for (size_t i = 0; i < descriptor.method_slots; i++)
+      {
+        if (descriptor.methods[i] != 0)
+          descriptor.method_entries[i] = get_function(descriptor.methods[i]);
+      }
+
+      if (descriptor.finaliser_ip > 0)
+        descriptor.finaliser = get_function(descriptor.finaliser_ip);
+    }
+
     /**
      * Helper class that allows us to override the behaviour based on the type
      * of the operand we want to load.
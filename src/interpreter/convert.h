@@ -22,7 +22,10 @@ namespace verona::interpreter
    * Given an argument type `T` and a wire value `operand`, the following call
    * performs the conversion:
    *
-   *   convert_operand<T>::convert(vm, operand);
+   *   convert_operand<T>::convert<Checked>(vm, operand);
+   *
+   * `Checked` is false when the program has been verified, in which case
+   * registers are accessed without bounds checks.
    *
    * The conversions are implemented by specializing the `convert_operand`
    * struct. Specializations are picked using the argument type. Each
@@ -39,6 +42,7 @@ namespace verona::interpreter
   template<typename T>
   struct convert_operand
   {
+    template<bool Checked>
     static T convert(VM* vm, T value)
     {
       return value;
@@ -53,9 +57,24 @@ namespace verona::interpreter
      * underlying register. The opcode handler receives ownership of the Value
      * and must use it or clear it before exiting.
      */
+    template<bool Checked>
     static Value convert(VM* vm, Register reg)
     {
-      return vm->read(reg).maybe_consume();
+      return vm->read<Checked>(reg).maybe_consume();
+    }
+  };
+
+  template<>
+  struct convert_operand<Value&>
+  {
+    /**
+     * Operand conversion from a Register to a mutable reference to the Value
+     * it holds.
+     */
+    template<bool Checked>
+    static Value& convert(VM* vm, Register reg)
+    {
+      return vm->read<Checked>(reg);
     }
   };
 
@@ -65,9 +84,10 @@ namespace verona::interpreter
     /**
      * Operand conversion from a Register to a borrowed Value.
      */
+    template<bool Checked>
     static const Value& convert(VM* vm, Register reg)
     {
-      return vm->read(reg);
+      return vm->read<Checked>(reg);
     }
   };
 
@@ -80,9 +100,10 @@ namespace verona::interpreter
      * This conversion loads the register, assuming it has tag DESCRIPTOR, and
      * returns its contents.
      */
+    template<bool Checked>
     static const VMDescriptor* convert(VM* vm, Register reg)
     {
-      const Value& value = vm->read(reg);
+      const Value& value = vm->read<Checked>(reg);
       vm->check_type(value, Value::Tag::DESCRIPTOR);
       return value->descriptor;
     }
@@ -95,6 +116,7 @@ namespace verona::interpreter
      * Identity conversion, used when the operand in the bytecode is already a
      * uint64_t.
      */
+    template<bool Checked>
     static uint64_t convert(VM* vm, uint64_t value)
     {
       return value;
@@ -106,9 +128,10 @@ namespace verona::interpreter
      * This conversion loads the register, assuming it has tag U64, and
      * returns its contents.
      */
+    template<bool Checked>
     static uint64_t convert(VM* vm, Register reg)
     {
-      const Value& value = vm->read(reg);
+      const Value& value = vm->read<Checked>(reg);
       vm->check_type(value, Value::U64);
       return value->u64;
     }
@@ -121,6 +144,7 @@ namespace verona::interpreter
      * Identity conversion, used when the operand in the bytecode is already a
      * string literal.
      */
+    template<bool Checked>
     static std::string_view convert(VM* vm, std::string_view value)
     {
       return value;
@@ -129,9 +153,10 @@ namespace verona::interpreter
     /**
      * Operand conversion from a Register to a std::string_view.
      */
+    template<bool Checked>
     static std::string_view convert(VM* vm, Register reg)
     {
-      const Value& value = vm->read(reg);
+      const Value& value = vm->read<Checked>(reg);
       vm->check_type(value, Value::STRING);
       return value->string();
     }
@@ -140,6 +165,7 @@ namespace verona::interpreter
   template<bool IsConst>
   struct convert_operand<BaseValueList<IsConst>>
   {
+    template<bool Checked>
     static BaseValueList<IsConst> convert(VM* vm, RegisterSpan regs)
     {
       return BaseValueList<IsConst>(vm, regs);
@@ -161,21 +187,23 @@ namespace verona::interpreter
   template<typename... Args>
   struct execute_handler<void (VM::*)(Args...)>
   {
-    template<void (VM::*Fn)(Args...), typename... Ts>
+    template<void (VM::*Fn)(Args...), bool Checked, typename... Ts>
     static void execute(VM* vm, Ts... operands)
     {
-      (vm->*Fn)(convert_operand<Args>::convert(vm, operands)...);
+      (vm->*Fn)(
+        convert_operand<Args>::template convert<Checked>(vm, operands)...);
     }
   };
 
   template<typename... Args>
   struct execute_handler<Value (VM::*)(Args...)>
   {
-    template<Value (VM::*Fn)(Args...), typename... Ts>
+    template<Value (VM::*Fn)(Args...), bool Checked, typename... Ts>
     static void execute(VM* vm, Register dst, Ts... operands)
     {
-      Value result = (vm->*Fn)(convert_operand<Args>::convert(vm, operands)...);
-      vm->write(dst, std::move(result));
+      Value result = (vm->*Fn)(
+        convert_operand<Args>::template convert<Checked>(vm, operands)...);
+      vm->write<Checked>(dst, std::move(result));
     }
   };
 }
@@ -45,7 +45,7 @@ struct fmt::formatter<verona::interpreter::Value>
   template<typename FormatContext>
   auto format(const verona::interpreter::Value& value, FormatContext& ctx)
   {
-    return format_value(value.tag, value.inner, ctx.out());
+    return format_value(value.tag(), value.inner(), ctx.out());
   }
 
 private:
@@ -119,8 +119,8 @@ private:
         if (i > 0)
           it = fmt::format_to(it, ", ");
 
-        const verona::interpreter::FieldValue& v = object->fields[i];
-        it = format_value(v.tag, v.inner, it);
+        const verona::interpreter::FieldValue& v = object->fields()[i];
+        it = format_value(v.tag(), v.inner(), it);
       }
       it = fmt::format_to(it, " }}");
     }
@@ -0,0 +1,315 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "ds/helpers.h"
+#include "interpreter/bytecode.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/**
+ * # Decoded instructions
+ *
+ * The VM does not execute the variable length bytecode directly. The first
+ * time a function is needed, its body is decoded into an array of fixed-width
+ * `Instruction`s, whose operands have already been read, validated and
+ * resolved. Executing an instruction therefore never touches the bytecode.
+ *
+ * Most operands are kept as they appear on the wire. Jump offsets are resolved
+ * to the instruction they target, the code pointer of a `When` to the decoded
+ * function, and string literals to their entry in the Code's string table.
+ * Each `Call` and `CallArgs` is also given an inline cache of the methods it
+ * dispatched to.
+ *
+ * Every decoded function ends with an extra `Unreachable` instruction, so that
+ * execution running off the end of a function is caught.
+ */
+namespace verona::interpreter
+{
+  using bytecode::CodePtr;
+  using bytecode::FunctionHeader;
+  using bytecode::Opcode;
+  using bytecode::OpcodeOperands;
+  using bytecode::Register;
+
+  struct Instruction;
+  struct Function;
+  struct VMDescriptor;
+  struct VMString;
+  struct CallCache;
+  class NativeCode;
+
+  /**
+   * Operand specification of decoded instructions.
+   *
+   * By default this is the same as the wire operands of the opcode, but it is
+   * specialized for opcodes whose operands are resolved by the decoder.
+   */
+  template<Opcode opcode>
+  struct DecodedSpec
+  {
+    using Operands = typename bytecode::OpcodeSpec<opcode>::Operands;
+  };
+
+  template<>
+  struct DecodedSpec<Opcode::Call>
+  {
+    using Operands =
+      OpcodeOperands<bytecode::SelectorIdx, uint8_t, CallCache*>;
+  };
+
+  /**
+   * The arguments of a CallArgs are kept as a count and a pointer into the
+   * bytecode rather than a RegisterSpan, so that its operands fit in an
+   * Instruction.
+   */
+  template<>
+  struct DecodedSpec<Opcode::CallArgs>
+  {
+    using Operands = OpcodeOperands<
+      bytecode::SelectorIdx,
+      uint8_t,
+      uint8_t,
+      const Register*,
+      CallCache*>;
+  };
+
+  template<>
+  struct DecodedSpec<Opcode::Jump>
+  {
+    using Operands = OpcodeOperands<const Instruction*>;
+  };
+
+  template<>
+  struct DecodedSpec<Opcode::JumpIf>
+  {
+    using Operands = OpcodeOperands<Register, const Instruction*>;
+  };
+
+  template<>
+  struct DecodedSpec<Opcode::String>
+  {
+    using Operands = OpcodeOperands<Register, const VMString*>;
+  };
+
+  template<>
+  struct DecodedSpec<Opcode::When>
+  {
+    using Operands = OpcodeOperands<const Function*, uint8_t, uint8_t>;
+  };
+
+  template<typename... Args>
+  std::tuple<Args...> operand_tuple(OpcodeOperands<Args...>);
+
+  /**
+   * Tuple of the decoded operands of an opcode, as stored in an Instruction.
+   */
+  template<Opcode opcode>
+  using DecodedOperands =
+    decltype(operand_tuple(typename DecodedSpec<opcode>::Operands()));
+
+  struct Instruction
+  {
+    static constexpr size_t OPERANDS_SIZE = 24;
+
+    Opcode opcode;
+
+    /**
+     * Offset of the instruction in the bytecode. It is only used for tracing
+     * and error messages.
+     */
+    uint32_t offset;
+
+    template<Opcode op>
+    const DecodedOperands<op>& operands() const
+    {
+      assert(opcode == op);
+      return *reinterpret_cast<const DecodedOperands<op>*>(storage);
+    }
+
+    template<Opcode op>
+    DecodedOperands<op>& operands()
+    {
+      assert(opcode == op);
+      return *reinterpret_cast<DecodedOperands<op>*>(storage);
+    }
+
+    template<Opcode op>
+    void set_operands(DecodedOperands<op> operands)
+    {
+      static_assert(sizeof(DecodedOperands<op>) <= OPERANDS_SIZE);
+      static_assert(alignof(DecodedOperands<op>) <= alignof(uint64_t));
+      static_assert(std::is_trivially_destructible_v<DecodedOperands<op>>);
+
+      opcode = op;
+      new (storage) DecodedOperands<op>(std::move(operands));
+    }
+
+  private:
+    alignas(uint64_t) std::byte storage[OPERANDS_SIZE];
+  };
+
+  /**
+   * Polymorphic inline cache of a Call instruction, mapping the descriptors of
+   * the receivers seen at the call site to the method they dispatched to.
+   *
+   * The code is shared by the VMs of every thread, so caches are filled
+   * concurrently. An entry is claimed by setting its descriptor, and never
+   * changes afterwards. Until its method is set, lookups miss. The method is
+   * published with release ordering, so that a thread that finds it through
+   * the cache also sees the instructions that were decoded for it.
+   *
+   * Once every entry is claimed, other receivers always take the slow path.
+   */
+  struct CallCache
+  {
+    static constexpr size_t ENTRIES = 4;
+
+    struct Entry
+    {
+      std::atomic<const VMDescriptor*> descriptor = nullptr;
+      std::atomic<const Function*> function = nullptr;
+    };
+
+    Entry entries[ENTRIES];
+
+    /**
+     * Get the cached method for `descriptor`, or null on a miss.
+     */
+    const Function* lookup(const VMDescriptor* descriptor) const
+    {
+      for (const Entry& entry : entries)
+      {
+        const VMDescriptor* key =
+          entry.descriptor.load(std::memory_order_relaxed);
+        if (key == descriptor)
+          return entry.function.load(std::memory_order_acquire);
+        if (key == nullptr)
+          break;
+      }
+      return nullptr;
+    }
+
+    void insert(const VMDescriptor* descriptor, const Function* function)
+    {
+      for (Entry& entry : entries)
+      {
+        const VMDescriptor* key = nullptr;
+        if (entry.descriptor.compare_exchange_strong(
+              key, descriptor, std::memory_order_relaxed))
+        {
+          entry.function.store(function, std::memory_order_release);
+          return;
+        }
+        if (key == descriptor)
+          return;
+      }
+    }
+  };
+
+  struct Function
+  {
+    FunctionHeader header;
+
+    /**
+     * Whether `instructions` and `call_caches` have been filled in. Functions
+     * are decoded the first time they are needed, see `Code::prepare`.
+     */
+    std::atomic<bool> decoded = false;
+
+    /**
+     * Offset of the function's header in the bytecode.
+     */
+    CodePtr address;
+
+    std::vector<Instruction> instructions;
+
+    /**
+     * Inline caches of the function's Call and CallArgs instructions, which
+     * point into them.
+     */
+    std::unique_ptr<CallCache[]> call_caches;
+
+    /**
+     * Number of times execution entered the function, by a call, a return into
+     * it or a backward jump, while it was interpreted. The Jit compiles the
+     * function once this reaches its threshold.
+     *
+     * Every thread's VM updates it without synchronisation, so a few entries
+     * may be lost. It only needs to be roughly right.
+     */
+    mutable std::atomic<uint32_t> hotness = 0;
+
+    /**
+     * Native code of the function, set by the Jit once it is compiled.
+     */
+    mutable std::atomic<const NativeCode*> native = nullptr;
+
+    const Instruction* entry() const
+    {
+      return instructions.data();
+    }
+  };
+
+  /**
+   * Call `f` with `std::integral_constant<Opcode, op>`, allowing an opcode
+   * known only at runtime to be used as a template argument.
+   */
+  template<typename F>
+  decltype(auto) visit_opcode(Opcode op, F&& f)
+  {
+    switch (op)
+    {
+#define OP(NAME) \
+  case Opcode::NAME: \
+    return f(std::integral_constant<Opcode, Opcode::NAME>());
+
+      OP(BinOp);
+      OP(Call);
+      OP(Clear);
+      OP(ClearList);
+      OP(Copy);
+      OP(FulfillSleepingCown);
+      OP(Freeze);
+      OP(Int64);
+      OP(String);
+      OP(Jump);
+      OP(JumpIf);
+      OP(Load);
+      OP(LoadDescriptor);
+      OP(Match);
+      OP(Move);
+      OP(MutView);
+      OP(NewObject);
+      OP(NewCown);
+      OP(NewRegion);
+      OP(NewSleepingCown);
+      OP(Print);
+      OP(Protect);
+      OP(Return);
+      OP(Store);
+      OP(TraceRegion);
+      OP(Unprotect);
+      OP(Unreachable);
+      OP(When);
+      OP(CallArgs);
+      OP(ClearReturn);
+      OP(LoadLoad);
+
+#undef OP
+
+      case Opcode::Merge:
+        throw std::logic_error("Unsupported opcode Merge");
+
+        EXHAUSTIVE_SWITCH;
+    }
+  }
+}
@@ -4,22 +4,62 @@
 #include "interpreter/vm.h"
 #include "options.h"
 
+#include <fstream>
 #include <iterator>
+#include <memory>
+#include <optional>
 #include <verona.h>
 
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 namespace verona::interpreter
 {
   Code load_file(std::istream& input)
   {
-    input.unsetf(std::ios_base::skipws);
+    std::vector<uint8_t> data(
+      (std::istreambuf_iterator<char>(input)),
+      std::istreambuf_iterator<char>());
 
-    std::vector<uint8_t> data;
-    std::copy(
-      std::istream_iterator<uint8_t>(input),
-      std::istream_iterator<uint8_t>(),
-      std::back_inserter(data));
+    return Code(std::move(data));
+  }
 
-    return Code(data);
+  Code load_file(const std::string& path)
+  {
+#ifdef _WIN32
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open())
+      throw std::runtime_error(fmt::format("Cannot open file {}", path));
+    return load_file(input);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error(fmt::format("Cannot open file {}", path));
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+      // Empty files can't be mapped, and aren't valid programs anyway.
+      close(fd);
+      return Code(std::vector<uint8_t>());
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      throw std::runtime_error(fmt::format("Cannot map file {}", path));
+
+    // The mapping is only read from, and functions are decoded from it as they
+    // are first called, so most of a large program is never paged in.
+    std::shared_ptr<const void> mapping(
+      data, [size](void* p) { munmap(p, size); });
+    return Code(std::move(mapping), static_cast<const uint8_t*>(data), size);
+#endif
   }
 
   class EmptyCown : public rt::VCown<EmptyCown>
@@ -28,8 +68,15 @@ namespace verona::interpreter
     EmptyCown() {}
   };
 
-  void
-  instantiate(size_t cores, const Code& code, bool verbose, size_t seed = 1234)
+  void instantiate(
+    size_t cores,
+    const Code& code,
+    bool verbose,
+    bool checked,
+    std::optional<size_t> jit_threshold,
+    bool profile_bigrams,
+    const std::optional<std::string>& profile_file,
+    size_t seed = 1234)
   {
 #ifdef USE_SYSTEMATIC_TESTING
     Systematic::set_seed(seed);
@@ -37,7 +84,7 @@ namespace verona::interpreter
     rt::Scheduler& sched = rt::Scheduler::get();
     sched.init(cores);
 
-    size_t ip = code.entrypoint();
+    const Function* entrypoint = code.entrypoint();
 
     rt::Cown* cown = new EmptyCown();
 
@@ -45,21 +92,77 @@ namespace verona::interpreter
     // the receiver. This matches the usual calling convention for static
     // methods.
     // TODO: Should this contain command line arguments in the future?
-    std::vector<Value> args;
-    args.push_back(Value::descriptor(code.special_descriptors().main));
+    rt::Alloc* alloc = rt::ThreadAlloc::get();
+    ExecuteMessage* message = ExecuteMessage::make(alloc, entrypoint, 1, 0);
+    message->args()[0].overwrite(
+      alloc, Value::descriptor(code.special_descriptors().main));
 
-    rt::Cown::schedule<ExecuteMessage>(cown, ip, std::move(args), 0);
+    rt::Cown::schedule_behaviour(1, &cown, message);
 
-    rt::Alloc* alloc = rt::ThreadAlloc::get();
     rt::Cown::release(alloc, cown);
 
-    sched.run_with_startup<const Code*, bool>(VM::init_vm, &code, verbose);
+    // Destroying the Jit resets the functions it compiled, so every run starts
+    // with all of them interpreted.
+    std::unique_ptr<Jit> jit;
+    if (jit_threshold.has_value())
+    {
+      Jit::Handlers handlers =
+        VM::native_handlers(checked, profile_file.has_value());
+
+      // Instructions executed inline are not traced.
+      if (verbose)
+        handlers.inline_instructions = false;
+
+      jit = std::make_unique<Jit>(handlers, jit_threshold.value());
+    }
+
+    std::unique_ptr<BigramProfile> bigrams;
+    if (profile_bigrams)
+      bigrams = std::make_unique<BigramProfile>();
+
+    std::unique_ptr<Profile> profile;
+    if (profile_file.has_value())
+      profile = std::make_unique<Profile>();
+
+    sched.run_with_startup<
+      const Code*,
+      bool,
+      bool,
+      Jit*,
+      BigramProfile*,
+      Profile*>(
+      VM::init_vm,
+      &code,
+      verbose,
+      checked,
+      jit.get(),
+      bigrams.get(),
+      profile.get());
+
+    // Every VM has been destroyed along with its thread, and has added its
+    // counts to the profiles.
+    if (bigrams != nullptr)
+      bigrams->report(std::cerr);
+
+    if (profile != nullptr)
+    {
+      profile->report(std::cerr);
+
+      std::ofstream stacks(profile_file.value());
+      profile->write_stacks(stacks);
+      if (!stacks)
+        std::cerr << "Could not write " << profile_file.value() << std::endl;
+    }
 
     snmalloc::current_alloc_pool()->debug_check_empty();
   }
 
   void instantiate(InterpreterOptions& options, const Code& code)
   {
+    std::optional<size_t> jit_threshold;
+    if (options.jit)
+      jit_threshold = options.jit_threshold;
+
 #ifdef USE_SYSTEMATIC_TESTING
     if (options.run_seed.has_value())
     {
@@ -72,21 +175,50 @@ namespace verona::interpreter
              i++)
         {
           std::cout << "Seed: " << i << std::endl;
-          interpreter::instantiate(options.cores, code, options.verbose, i);
+          interpreter::instantiate(
+            options.cores,
+            code,
+            options.verbose,
+            options.checked,
+            jit_threshold,
+            options.profile_bigrams,
+            options.profile,
+            i);
         }
       }
       else
       {
         interpreter::instantiate(
-          options.cores, code, options.verbose, options.run_seed.value());
+          options.cores,
+          code,
+          options.verbose,
+          options.checked,
+          jit_threshold,
+          options.profile_bigrams,
+          options.profile,
+          options.run_seed.value());
       }
     }
     else
     {
-      interpreter::instantiate(options.cores, code, options.verbose);
+      interpreter::instantiate(
+        options.cores,
+        code,
+        options.verbose,
+        options.checked,
+        jit_threshold,
+        options.profile_bigrams,
+        options.profile);
     }
 #else
-    interpreter::instantiate(options.cores, code, options.verbose);
+    interpreter::instantiate(
+      options.cores,
+      code,
+      options.verbose,
+      options.checked,
+      jit_threshold,
+      options.profile_bigrams,
+      options.profile);
 #endif
   }
 }
@@ -8,5 +8,11 @@
 namespace verona::interpreter
 {
   Code load_file(std::istream& input);
+
+  /**
+   * Load a program by mapping the file at `path` into memory. The Code borrows
+   * the mapping.
+   */
+  Code load_file(const std::string& path);
   void instantiate(InterpreterOptions& options, const Code& code);
 }
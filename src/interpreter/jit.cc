@@ -0,0 +1,644 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include "interpreter/jit.h"
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <tuple>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#  define VERONA_JIT_X86_64
+#  include <sys/mman.h>
+#endif
+
+namespace verona::interpreter
+{
+#ifdef VERONA_JIT_X86_64
+  namespace
+  {
+    /**
+     * Emits x86-64 machine code for a function.
+     *
+     * The native code starts with an entry sequence, called as a
+     * `NativeCode::Entry`. It saves rbx and r12, keeps the VM in rbx and the
+     * frame's registers in r12, and jumps to the code of the instruction
+     * execution starts at. The exit sequence restores them and returns to the
+     * caller of the entry sequence.
+     *
+     * rbx and r12 are callee-saved, so they stay the same across calls to the
+     * steps. The frame's registers don't move while native code runs: it
+     * leaves the function at every call and return, and a finaliser run by a
+     * step uses registers past the frame's. The entry sequence also aligns the
+     * stack to 16 bytes, as the System V ABI requires at calls.
+     *
+     * Instructions executed inline only use caller-saved registers: rax, rcx,
+     * rdx and r8 hold Values and addresses, and r10 and r11 are used by the
+     * kind guards.
+     */
+    class Emitter
+    {
+    public:
+      Emitter(const Function& function, const Jit::Handlers& handlers)
+      : function_(function), handlers_(handlers)
+      {}
+
+      /**
+       * Generate the code of the function, and allocate the caches it uses.
+       * Returns false if it contains an instruction that can't be compiled.
+       */
+      bool emit(
+        std::vector<uint8_t>& code,
+        std::vector<uint32_t>& offsets,
+        std::unique_ptr<FieldCache[]>& caches)
+      {
+        const std::vector<Instruction>& instructions = function_.instructions;
+        for (const Instruction& instruction : instructions)
+        {
+          if (!compilable(instruction.opcode))
+            return false;
+        }
+
+        // The code of an instruction has the same size wherever its jumps go
+        // and its cache is, so a first pass with neither finds where the code
+        // of every instruction starts.
+        offsets_ = nullptr;
+        caches_ = nullptr;
+        emit_function(offsets);
+
+        caches = std::make_unique<FieldCache[]>(cache_count_);
+        offsets_ = &offsets;
+        caches_ = caches.get();
+        std::vector<uint32_t> final_offsets;
+        emit_function(final_offsets);
+        assert(final_offsets == offsets);
+
+        code = std::move(code_);
+        return true;
+      }
+
+    private:
+      using Jumps = std::vector<size_t>;
+
+      /**
+       * Numbers of the x86-64 registers used by inline instructions.
+       */
+      static constexpr uint8_t RAX = 0;
+      static constexpr uint8_t RDX = 2;
+      static constexpr uint8_t R8 = 8;
+
+      bool compilable(Opcode opcode) const
+      {
+        switch (opcode)
+        {
+          case Opcode::Jump:
+            return true;
+          case Opcode::JumpIf:
+            return handlers_.branch != nullptr;
+          default:
+            return step(opcode) != nullptr;
+        }
+      }
+
+      Jit::Step step(Opcode opcode) const
+      {
+        return handlers_.steps[static_cast<size_t>(opcode)];
+      }
+
+      size_t index(const Instruction* instruction) const
+      {
+        return static_cast<size_t>(instruction - function_.entry());
+      }
+
+      void emit_function(std::vector<uint32_t>& offsets)
+      {
+        code_.clear();
+        offsets.clear();
+        cache_count_ = 0;
+
+        // push rbx; push r12; sub rsp, 8
+        bytes({0x53, 0x41, 0x54, 0x48, 0x83, 0xec, 0x08});
+        // mov rbx, rdi; mov r12, rdx; jmp rsi
+        bytes({0x48, 0x89, 0xfb, 0x49, 0x89, 0xd4, 0xff, 0xe6});
+
+        for (const Instruction& instruction : function_.instructions)
+        {
+          offsets.push_back(static_cast<uint32_t>(code_.size()));
+          emit_instruction(instruction);
+        }
+      }
+
+      void emit_instruction(const Instruction& instruction)
+      {
+        switch (instruction.opcode)
+        {
+          case Opcode::Jump:
+            // jmp rel32
+            bytes({0xe9});
+            rel32(std::get<0>(instruction.operands<Opcode::Jump>()));
+            break;
+
+          case Opcode::JumpIf:
+            call(handlers_.branch, instruction);
+            // test al, al; jnz rel32
+            bytes({0x84, 0xc0, 0x0f, 0x85});
+            rel32(std::get<1>(instruction.operands<Opcode::JumpIf>()));
+            break;
+
+          case Opcode::Call:
+          case Opcode::CallArgs:
+          case Opcode::Return:
+          case Opcode::ClearReturn:
+            // Leave the native code, so the interpreter can pick the next
+            // function to run.
+            call(step(instruction.opcode), instruction);
+            exit();
+            break;
+
+          case Opcode::Int64:
+          case Opcode::Copy:
+          case Opcode::Move:
+          case Opcode::Load:
+          case Opcode::Store:
+            if (inlinable(instruction))
+              emit_inline(instruction);
+            else
+              call(step(instruction.opcode), instruction);
+            break;
+
+          default:
+            call(step(instruction.opcode), instruction);
+            break;
+        }
+      }
+
+      bool inlinable(const Instruction& instruction) const
+      {
+        if (!handlers_.inline_instructions)
+          return false;
+
+        // Registers are only bounds checked by the steps.
+        auto in_frame = [&](auto... registers) {
+          return ((registers.index < function_.header.locals) && ...);
+        };
+
+        switch (instruction.opcode)
+        {
+          case Opcode::Int64:
+          {
+            auto [dst, imm] = instruction.operands<Opcode::Int64>();
+            return in_frame(dst) && small_u64(imm).has_value();
+          }
+          case Opcode::Copy:
+          {
+            auto [dst, src] = instruction.operands<Opcode::Copy>();
+            return in_frame(dst, src);
+          }
+          case Opcode::Move:
+          {
+            auto [dst, src] = instruction.operands<Opcode::Move>();
+            return in_frame(dst, src);
+          }
+          case Opcode::Load:
+          {
+            auto [dst, base, selector] = instruction.operands<Opcode::Load>();
+            return in_frame(dst, base);
+          }
+          case Opcode::Store:
+          {
+            auto [dst, base, selector, src] =
+              instruction.operands<Opcode::Store>();
+            return in_frame(dst, base, src);
+          }
+          default:
+            return false;
+        }
+      }
+
+      /**
+       * Bits of the Value holding `value`, if it fits unboxed.
+       */
+      std::optional<uint64_t> small_u64(uint64_t value) const
+      {
+        const Jit::Layout& layout = handlers_.layout;
+        uint64_t bits = value << layout.kind_bits;
+        if ((static_cast<int64_t>(bits) >> layout.kind_bits) !=
+            static_cast<int64_t>(value))
+          return std::nullopt;
+        return bits | layout.u64_kind;
+      }
+
+      /**
+       * Execute the instruction inline, or call its step if a guard fails.
+       *
+       * Every guard comes before the first write, so the step always starts
+       * from the state the instruction started from.
+       */
+      void emit_inline(const Instruction& instruction)
+      {
+        const Jit::Layout& layout = handlers_.layout;
+        Jumps slow;
+        FieldCache* cache = nullptr;
+
+        switch (instruction.opcode)
+        {
+          case Opcode::Int64:
+          {
+            auto [dst, imm] = instruction.operands<Opcode::Int64>();
+            load(RAX, dst);
+            guard(RAX, layout.unowned_kinds, slow);
+            // mov rax, imm64
+            bytes({0x48, 0xb8});
+            imm64(*small_u64(imm));
+            store(dst, RAX);
+            break;
+          }
+
+          case Opcode::Copy:
+          {
+            auto [dst, src] = instruction.operands<Opcode::Copy>();
+            load(RAX, dst);
+            guard(RAX, layout.unowned_kinds, slow);
+            load(RAX, src);
+            guard(RAX, layout.copyable_kinds, slow);
+            store(dst, RAX);
+            break;
+          }
+
+          case Opcode::Move:
+          {
+            // Moving any Value only transfers its bits, so only the Value it
+            // replaces needs a guard.
+            auto [dst, src] = instruction.operands<Opcode::Move>();
+            load(RAX, dst);
+            guard(RAX, layout.unowned_kinds, slow);
+            load(RAX, src);
+            clear(src);
+            store(dst, RAX);
+            break;
+          }
+
+          case Opcode::Load:
+          {
+            auto [dst, base, selector] = instruction.operands<Opcode::Load>();
+            cache = next_cache();
+            load(RAX, dst);
+            guard(RAX, layout.unowned_kinds, slow);
+            load(RAX, base);
+            guard(RAX, layout.loadable_kinds, slow);
+            field(cache, slow);
+            guard(RDX, layout.plain_kinds, slow);
+            store(dst, RDX);
+            break;
+          }
+
+          case Opcode::Store:
+          {
+            auto [dst, base, selector, src] =
+              instruction.operands<Opcode::Store>();
+            cache = next_cache();
+            load(RAX, dst);
+            guard(RAX, layout.unowned_kinds, slow);
+            load(R8, src);
+            guard(R8, layout.plain_kinds, slow);
+            load(RAX, base);
+            guard(RAX, layout.storable_kinds, slow);
+            field(cache, slow);
+            guard(RDX, layout.plain_kinds, slow);
+            // mov [rax], r8
+            bytes({0x4c, 0x89, 0x00});
+            store(dst, RDX);
+            break;
+          }
+
+          default:
+            abort();
+        }
+
+        // jmp done
+        bytes({0xe9});
+        size_t done = label();
+
+        bind(slow);
+        if (
+          instruction.opcode == Opcode::Load ||
+          instruction.opcode == Opcode::Store)
+          fill_cache(instruction, cache);
+        call(step(instruction.opcode), instruction);
+
+        bind({done});
+      }
+
+      /**
+       * Load the register `src` of the frame into the x86 register `reg`.
+       */
+      void load(uint8_t reg, Register src)
+      {
+        // mov reg, [r12 + disp32]
+        bytes({rex(reg, 0x49), 0x8b, modrm_r12(reg), 0x24});
+        imm32(displacement(src));
+      }
+
+      /**
+       * Store the x86 register `reg` to the register `dst` of the frame.
+       */
+      void store(Register dst, uint8_t reg)
+      {
+        // mov [r12 + disp32], reg
+        bytes({rex(reg, 0x49), 0x89, modrm_r12(reg), 0x24});
+        imm32(displacement(dst));
+      }
+
+      /**
+       * Set the register `dst` of the frame to UNINIT.
+       */
+      void clear(Register dst)
+      {
+        // mov qword [r12 + disp32], 0
+        bytes({0x49, 0xc7, 0x84, 0x24});
+        imm32(displacement(dst));
+        imm32(0);
+      }
+
+      /**
+       * Jump to `slow` unless the kind of the Value in `reg` is in `kinds`.
+       */
+      void guard(uint8_t reg, uint32_t kinds, Jumps& slow)
+      {
+        uint32_t kind_mask = (uint32_t(1) << handlers_.layout.kind_bits) - 1;
+        assert(kind_mask <= 0x7f);
+
+        // mov r10d, reg32
+        bytes(
+          {rex(reg, 0x41), 0x89, static_cast<uint8_t>(0xc2 | (reg & 7) << 3)});
+        // and r10d, kind_mask
+        bytes({0x41, 0x83, 0xe2, static_cast<uint8_t>(kind_mask)});
+        // mov r11d, kinds
+        bytes({0x41, 0xbb});
+        imm32(kinds);
+        // bt r11d, r10d; jnc slow
+        bytes({0x45, 0x0f, 0xa3, 0xd3, 0x0f, 0x83});
+        slow.push_back(label());
+      }
+
+      /**
+       * Find the field of the object in rax, using `cache`. Leaves the address
+       * of the field in rax and its contents in rdx, or jumps to `slow` if the
+       * cache misses.
+       */
+      void field(FieldCache* cache, Jumps& slow)
+      {
+        const Jit::Layout& layout = handlers_.layout;
+        auto object_mask = static_cast<int8_t>(~((1 << layout.kind_bits) - 1));
+        auto descriptor_offset = static_cast<int8_t>(layout.descriptor_offset);
+        auto descriptor_mask = static_cast<int8_t>(layout.descriptor_mask);
+        assert(descriptor_offset == layout.descriptor_offset);
+        assert(
+          static_cast<uintptr_t>(descriptor_mask) == layout.descriptor_mask);
+
+        // and rax, object_mask
+        bytes({0x48, 0x83, 0xe0, static_cast<uint8_t>(object_mask)});
+        // mov rdx, [rax + descriptor_offset]
+        bytes({0x48, 0x8b, 0x50, static_cast<uint8_t>(descriptor_offset)});
+        // and rdx, descriptor_mask
+        bytes({0x48, 0x83, 0xe2, static_cast<uint8_t>(descriptor_mask)});
+        // mov rcx, imm64
+        bytes({0x48, 0xb9});
+        imm64(cache);
+        // cmp rdx, [rcx]; jne slow
+        static_assert(offsetof(FieldCache, descriptor) == 0);
+        bytes({0x48, 0x3b, 0x11, 0x0f, 0x85});
+        slow.push_back(label());
+        // mov rcx, [rcx + offset]; add rax, rcx; mov rdx, [rax]
+        static_assert(offsetof(FieldCache, offset) < 0x80);
+        bytes({0x48, 0x8b, 0x49, offsetof(FieldCache, offset)});
+        bytes({0x48, 0x01, 0xc8, 0x48, 0x8b, 0x10});
+      }
+
+      FieldCache* next_cache()
+      {
+        size_t index = cache_count_++;
+        return caches_ != nullptr ? &caches_[index] : nullptr;
+      }
+
+      /**
+       * Call `fn(vm, &instruction)`.
+       */
+      template<typename Fn>
+      void call(Fn fn, const Instruction& instruction)
+      {
+        // mov rdi, rbx
+        bytes({0x48, 0x89, 0xdf});
+        // mov rsi, imm64
+        bytes({0x48, 0xbe});
+        imm64(&instruction);
+        // mov rax, imm64
+        bytes({0x48, 0xb8});
+        imm64(reinterpret_cast<const void*>(fn));
+        // call rax
+        bytes({0xff, 0xd0});
+      }
+
+      /**
+       * Call `fill_cache(vm, &instruction, cache)`.
+       */
+      void fill_cache(const Instruction& instruction, FieldCache* cache)
+      {
+        // mov rdx, imm64
+        bytes({0x48, 0xba});
+        imm64(cache);
+        call(handlers_.fill_cache, instruction);
+      }
+
+      void exit()
+      {
+        // add rsp, 8; pop r12; pop rbx; ret
+        bytes({0x48, 0x83, 0xc4, 0x08, 0x41, 0x5c, 0x5b, 0xc3});
+      }
+
+      /**
+       * REX prefix for an instruction whose ModRM reg field is `reg`, adding
+       * the extension bit of `reg` to `prefix`.
+       */
+      static uint8_t rex(uint8_t reg, uint8_t prefix)
+      {
+        return static_cast<uint8_t>(prefix | (reg >= 8 ? 0x04 : 0));
+      }
+
+      /**
+       * ModRM byte addressing [r12 + disp32], followed by a SIB byte.
+       */
+      static uint8_t modrm_r12(uint8_t reg)
+      {
+        return static_cast<uint8_t>(0x84 | (reg & 7) << 3);
+      }
+
+      static uint32_t displacement(Register reg)
+      {
+        return static_cast<uint32_t>(reg.index * sizeof(uintptr_t));
+      }
+
+      void bytes(std::initializer_list<uint8_t> values)
+      {
+        code_.insert(code_.end(), values);
+      }
+
+      void imm32(uint32_t value)
+      {
+        for (size_t i = 0; i < sizeof(value); i++)
+          code_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+      }
+
+      void imm64(uint64_t value)
+      {
+        for (size_t i = 0; i < sizeof(value); i++)
+          code_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+      }
+
+      void imm64(const void* value)
+      {
+        imm64(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+      }
+
+      /**
+       * Displacement to the code of `target`, from the end of the jump.
+       */
+      void rel32(const Instruction* target)
+      {
+        int64_t displacement = 0;
+        if (offsets_ != nullptr)
+        {
+          int64_t end = static_cast<int64_t>(code_.size()) + 4;
+          displacement = (*offsets_)[index(target)] - end;
+        }
+        imm32(static_cast<uint32_t>(static_cast<int32_t>(displacement)));
+      }
+
+      /**
+       * Emit the rel32 of a jump within the code of an instruction, to be set
+       * by `bind`. Returns its position.
+       */
+      size_t label()
+      {
+        size_t position = code_.size();
+        imm32(0);
+        return position;
+      }
+
+      /**
+       * Make the jumps go to the current position.
+       */
+      void bind(const Jumps& jumps)
+      {
+        for (size_t position : jumps)
+        {
+          auto displacement =
+            static_cast<uint32_t>(code_.size() - (position + 4));
+          for (size_t i = 0; i < sizeof(displacement); i++)
+            code_[position + i] = static_cast<uint8_t>(displacement >> (8 * i));
+        }
+      }
+
+      const Function& function_;
+      const Jit::Handlers& handlers_;
+      std::vector<uint8_t> code_;
+      const std::vector<uint32_t>* offsets_ = nullptr;
+      FieldCache* caches_ = nullptr;
+      size_t cache_count_ = 0;
+    };
+
+    /**
+     * Copy code into newly mapped executable memory. Returns null if the
+     * memory can't be mapped.
+     */
+    uint8_t* map_code(const std::vector<uint8_t>& code)
+    {
+      void* memory = mmap(
+        nullptr,
+        code.size(),
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+      if (memory == MAP_FAILED)
+        return nullptr;
+
+      std::memcpy(memory, code.data(), code.size());
+      if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0)
+      {
+        munmap(memory, code.size());
+        return nullptr;
+      }
+
+      return static_cast<uint8_t*>(memory);
+    }
+  }
+#endif
+
+  NativeCode::NativeCode(const Function* function, uint8_t* code, size_t size)
+  : function_(function), code_(code), size_(size)
+  {}
+
+  NativeCode::~NativeCode()
+  {
+#ifdef VERONA_JIT_X86_64
+    munmap(code_, size_);
+#endif
+  }
+
+  void NativeCode::run(VM* vm, const Instruction* ip, Value* registers) const
+  {
+    size_t index = static_cast<size_t>(ip - function_->entry());
+    assert(index < offsets_.size());
+    reinterpret_cast<Entry>(code_)(vm, code_ + offsets_[index], registers);
+  }
+
+  Jit::~Jit()
+  {
+    for (const auto& native : compiled_)
+    {
+      const Function* function = native->function();
+      function->native.store(nullptr, std::memory_order_relaxed);
+      function->hotness.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  const NativeCode* Jit::compile(const Function* function)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Another thread may have compiled the function while we waited.
+    const NativeCode* native =
+      function->native.load(std::memory_order_relaxed);
+    if (native != nullptr)
+      return native;
+
+    // If the function can't be compiled, don't try again until it has been
+    // entered as many times again.
+    function->hotness.store(0, std::memory_order_relaxed);
+
+#ifdef VERONA_JIT_X86_64
+    std::vector<uint8_t> code;
+    std::vector<uint32_t> offsets;
+    std::unique_ptr<FieldCache[]> caches;
+    if (!Emitter(*function, handlers_).emit(code, offsets, caches))
+      return nullptr;
+
+    uint8_t* memory = map_code(code);
+    if (memory == nullptr)
+      return nullptr;
+
+    std::unique_ptr<NativeCode> result(
+      new NativeCode(function, memory, code.size()));
+    result->offsets_ = std::move(offsets);
+    result->field_caches_ = std::move(caches);
+
+    native = result.get();
+    compiled_.push_back(std::move(result));
+    function->native.store(native, std::memory_order_release);
+    return native;
+#else
+    return nullptr;
+#endif
+  }
+}
@@ -0,0 +1,232 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "interpreter/function.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * # Baseline JIT
+ *
+ * Functions start out interpreted. Every time execution enters a function, by
+ * a call, a return into it or a backward jump, its hotness is incremented.
+ * Once it reaches a threshold the function is compiled to native code, which
+ * the VM switches to the next time it enters the function.
+ *
+ * The native code is call-threaded: each instruction becomes a direct call to
+ * the handler of its opcode, the same one the interpreter uses, with the
+ * instruction's address embedded as an immediate. This removes the indirect
+ * dispatch branch and the instruction pointer bookkeeping of the interpreter.
+ * Jumps are compiled to native jumps, and a JumpIf to a call returning whether
+ * the branch is taken followed by a conditional jump.
+ *
+ * Int64, Copy, Move, Load and Store are also executed inline, on the registers
+ * of the frame, which native code addresses from the frame's base. The inline
+ * code guards on the kinds of the Values it reads, and only handles those
+ * which don't need any reference counting, region bookkeeping or allocation,
+ * such as small integers. Anything else falls back to the call. Load and Store
+ * find the field in the object with a cache of its offset, see `FieldCache`.
+ *
+ * Native code returns to the interpreter after a call or a return, leaving the
+ * VM on the first instruction of the callee or the instruction following the
+ * call in the caller. The interpreter then enters the native code of that
+ * function, if it has any. Native code can be entered at any instruction, so
+ * a function which becomes hot during a loop switches to native code at the
+ * loop's next iteration.
+ *
+ * Code is only generated for x86-64, on System V platforms. Elsewhere
+ * functions are never compiled and always interpreted.
+ */
+namespace verona::interpreter
+{
+  class VM;
+  class Jit;
+  struct Value;
+
+  /**
+   * Inline cache of a Load or Store compiled to native code, holding the
+   * offset of the field it accesses in objects of one descriptor.
+   *
+   * Native code is shared by the VMs of every thread. The cache is claimed by
+   * the first thread to miss on it, which sets the offset and then publishes
+   * the descriptor with release ordering. Native code only reads the offset
+   * once it has found the descriptor. The cache never changes afterwards, and
+   * objects of other descriptors always take the slow path.
+   */
+  struct FieldCache
+  {
+    std::atomic<const void*> descriptor = nullptr;
+    std::atomic<uintptr_t> offset = 0;
+    std::atomic<bool> claimed = false;
+  };
+
+  /**
+   * Executable memory holding the native code of a function.
+   */
+  class NativeCode
+  {
+  public:
+    ~NativeCode();
+
+    /**
+     * Run the native code from the given instruction of the function, until
+     * it calls another function or returns. `registers` are those of the
+     * function's frame.
+     */
+    void run(VM* vm, const Instruction* ip, Value* registers) const;
+
+    const Function* function() const
+    {
+      return function_;
+    }
+
+  private:
+    NativeCode(const Function* function, uint8_t* code, size_t size);
+
+    using Entry = void (*)(VM*, const uint8_t*, Value*);
+
+    const Function* function_;
+    uint8_t* code_;
+    size_t size_;
+
+    /**
+     * Offset in `code_` of the native code of each instruction.
+     */
+    std::vector<uint32_t> offsets_;
+
+    /**
+     * Caches of the Load and Store instructions executed inline.
+     */
+    std::unique_ptr<FieldCache[]> field_caches_;
+
+    friend class Jit;
+  };
+
+  class Jit
+  {
+  public:
+    /**
+     * Handler called by native code to execute an instruction.
+     */
+    using Step = void (*)(VM*, const Instruction*);
+
+    /**
+     * Handler called by native code to execute a JumpIf. Returns whether the
+     * jump is taken.
+     */
+    using Branch = bool (*)(VM*, const Instruction*);
+
+    /**
+     * Handler called by native code when the cache of a Load or Store misses,
+     * before the instruction's step. It fills the cache if it is unclaimed.
+     */
+    using FillCache = void (*)(VM*, const Instruction*, FieldCache*);
+
+    /**
+     * Encoding of Values and objects, used by the instructions executed
+     * inline. Each set of kinds is a bitset, indexed by the kind held in the
+     * low `kind_bits` of a Value.
+     */
+    struct Layout
+    {
+      uint8_t kind_bits;
+      uint8_t u64_kind;
+
+      /**
+       * Kinds that can be overwritten without releasing anything.
+       */
+      uint32_t unowned_kinds;
+
+      /**
+       * Kinds that can be copied bit for bit, and moved between registers and
+       * fields without any bookkeeping.
+       */
+      uint32_t plain_kinds;
+
+      /**
+       * Kinds that Copy copies bit for bit.
+       */
+      uint32_t copyable_kinds;
+
+      /**
+       * Kinds of objects Load can read from and Store can write to.
+       */
+      uint32_t loadable_kinds;
+      uint32_t storable_kinds;
+
+      /**
+       * Offset from an object to the word holding its descriptor, and mask of
+       * the descriptor's bits in that word.
+       */
+      int32_t descriptor_offset;
+      uintptr_t descriptor_mask;
+    };
+
+    struct Handlers
+    {
+      /**
+       * Step of each opcode, indexed by opcode. Functions containing an opcode
+       * without a step are never compiled.
+       */
+      Step steps[static_cast<size_t>(Opcode::maximum_value) + 1];
+      Branch branch;
+      FillCache fill_cache;
+      Layout layout;
+
+      /**
+       * Whether Int64, Copy, Move, Load and Store may be executed inline.
+       * Inline instructions are not traced or profiled.
+       */
+      bool inline_instructions;
+    };
+
+    Jit(const Handlers& handlers, size_t threshold)
+    : handlers_(handlers), threshold_(threshold)
+    {}
+
+    /**
+     * Resets the functions that were compiled, so the Code can be run again
+     * without the Jit.
+     */
+    ~Jit();
+
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    /**
+     * Count an entry into the function, compiling it if it has become hot.
+     *
+     * Returns the function's native code, or null if it is still interpreted.
+     */
+    const NativeCode* enter(const Function* function)
+    {
+      const NativeCode* native =
+        function->native.load(std::memory_order_acquire);
+      if (native != nullptr)
+        return native;
+
+      uint32_t hotness = function->hotness.load(std::memory_order_relaxed) + 1;
+      function->hotness.store(hotness, std::memory_order_relaxed);
+      if (hotness < threshold_)
+        return nullptr;
+
+      return compile(function);
+    }
+
+  private:
+    const NativeCode* compile(const Function* function);
+
+    const Handlers handlers_;
+    const size_t threshold_;
+
+    // Functions are compiled by one thread at a time.
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<NativeCode>> compiled_;
+  };
+}
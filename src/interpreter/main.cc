@@ -35,8 +35,7 @@ int main(int argc, const char** argv)
 
   verona::interpreter::validate_args(options);
 
-  std::ifstream file(options.input_file, std::ios::binary);
-  auto code = verona::interpreter::load_file(file);
+  auto code = verona::interpreter::load_file(options.input_file);
 
   verona::interpreter::instantiate(options, code);
 
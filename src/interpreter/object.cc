@@ -4,6 +4,7 @@
 
 #include "vm.h"
 
+#include <algorithm>
 #include <fmt/ostream.h>
 
 namespace verona::interpreter
@@ -15,12 +16,17 @@ namespace verona::interpreter
     size_t field_count,
     uint32_t finaliser_ip)
   : name(name),
+    method_slots(method_slots),
+    field_slots(field_slots),
     methods(std::make_unique<uint32_t[]>(method_slots)),
     fields(std::make_unique<uint32_t[]>(field_slots)),
     field_count(field_count),
-    finaliser_ip(finaliser_ip)
+    finaliser_ip(finaliser_ip),
+    method_entries(std::make_unique<const Function*[]>(method_slots))
   {
-    rt::Descriptor::size = rt::vsizeof<VMObject>;
+    std::fill_n(fields.get(), field_slots, ABSENT_FIELD);
+
+    rt::Descriptor::size = VMObject::size_for(field_count);
     rt::Descriptor::trace = VMObject::trace_fn;
 
     // Try to be on the trivial ring as much as possible. This requires the
@@ -41,10 +47,22 @@ namespace verona::interpreter
   VMObject::VMObject(VMObject* region, const VMDescriptor* desc)
   : Object(), parent_(region)
   {
-    if (descriptor()->field_count > 0)
-      fields = std::make_unique<FieldValue[]>(descriptor()->field_count);
-    else
-      fields = nullptr;
+    static_assert(sizeof(VMObject) % alignof(FieldValue) == 0);
+
+    FieldValue* storage = fields();
+    for (size_t i = 0; i < desc->field_count; i++)
+    {
+      new (&storage[i]) FieldValue();
+    }
+  }
+
+  VMObject::~VMObject()
+  {
+    FieldValue* storage = fields();
+    for (size_t i = 0; i < descriptor()->field_count; i++)
+    {
+      storage[i].~FieldValue();
+    }
   }
 
   VMObject* VMObject::region()
@@ -67,7 +85,7 @@ namespace verona::interpreter
 
     for (size_t i = 0; i < descriptor->field_count; i++)
     {
-      object->fields[i].trace(stack);
+      object->fields()[i].trace(stack);
     }
   }
 
@@ -93,7 +111,7 @@ namespace verona::interpreter
 
     for (size_t i = 0; i < descriptor->field_count; i++)
     {
-      object->fields[i].add_isos(sub_regions);
+      object->fields()[i].add_isos(sub_regions);
     }
   }
 
@@ -5,12 +5,19 @@
 #include "interpreter/bytecode.h"
 #include "interpreter/value.h"
 
+#include <limits>
 #include <verona.h>
 
 namespace verona::interpreter
 {
-  struct VMDescriptor : public rt::Descriptor
+  struct Function;
+
+  // Aligned so that Values can refer to descriptors with tagged pointers.
+  struct alignas(16) VMDescriptor : public rt::Descriptor
   {
+    static constexpr uint32_t ABSENT_FIELD =
+      std::numeric_limits<uint32_t>::max();
+
     VMDescriptor(
       std::string_view name,
       size_t method_slots,
@@ -19,10 +26,24 @@ namespace verona::interpreter
       uint32_t finaliser_ip);
 
     const std::string name;
+    const size_t method_slots;
+    const size_t field_slots;
     const size_t field_count;
+
+    /**
+     * Index in the object of the field of each selector, or ABSENT_FIELD if
+     * objects of this descriptor have no such field.
+     */
     std::unique_ptr<uint32_t[]> fields;
     std::unique_ptr<uint32_t[]> methods;
     const uint32_t finaliser_ip;
+
+    /**
+     * Decoded functions for each method slot and for the finaliser, or null if
+     * there are none. Set when the program is loaded.
+     */
+    std::unique_ptr<const Function*[]> method_entries;
+    const Function* finaliser = nullptr;
   };
 
   struct VMObject : public rt::Object
@@ -33,8 +54,31 @@ namespace verona::interpreter
      * If the object is in a new region, nullptr should be passed instead.
      */
     explicit VMObject(VMObject* region, const VMDescriptor* desc);
+    ~VMObject();
 
-    std::unique_ptr<FieldValue[]> fields;
+    /**
+     * Size of the allocation needed for an object with `field_count` fields.
+     *
+     * The fields are stored inline, immediately after the VMObject, so that an
+     * object is a single allocation in its region.
+     */
+    static constexpr size_t size_for(size_t field_count)
+    {
+      return snmalloc::bits::align_up(
+        sizeof(rt::Object::Header) + sizeof(VMObject) +
+          field_count * sizeof(FieldValue),
+        rt::Object::ALIGNMENT);
+    }
+
+    FieldValue* fields()
+    {
+      return reinterpret_cast<FieldValue*>(this + 1);
+    }
+
+    const FieldValue* fields() const
+    {
+      return reinterpret_cast<const FieldValue*>(this + 1);
+    }
 
     const VMDescriptor* descriptor() const
     {
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include <CLI/CLI.hpp>
+#include <optional>
 #include <string>
 
 namespace verona::interpreter
@@ -10,6 +11,18 @@ namespace verona::interpreter
   {
     uint8_t cores = 4;
     bool verbose = false;
+    // Bounds check every register access instead of verifying the program.
+    bool checked = false;
+    // Compile functions to native code once they have been entered
+    // jit_threshold times.
+    bool jit = false;
+    size_t jit_threshold = 1000;
+    // Print the pairs of instructions executed most often, as candidates for
+    // superinstructions.
+    bool profile_bigrams = false;
+    // Profile execution, printing the costliest functions and opcodes at exit
+    // and writing the sampled call stacks to this file, for flamegraph.pl.
+    std::optional<std::string> profile;
     bool run = false;
 #ifdef USE_SYSTEMATIC_TESTING
     std::optional<size_t> run_seed;
@@ -33,6 +46,11 @@ namespace verona::interpreter
 
     app.add_option("--" + tag + "cores", options.cores);
     app.add_flag("--" + tag + "verbose", options.verbose);
+    app.add_flag("--" + tag + "checked", options.checked);
+    app.add_flag("--" + tag + "jit", options.jit);
+    app.add_option("--" + tag + "jit-threshold", options.jit_threshold);
+    app.add_flag("--" + tag + "profile-bigrams", options.profile_bigrams);
+    app.add_option("--" + tag + "profile", options.profile);
 #ifdef USE_SYSTEMATIC_TESTING
     app.add_option("--" + tag + "seed", options.run_seed);
     app.add_option("--" + tag + "seed_upper", options.run_seed_upper);
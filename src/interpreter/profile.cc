@@ -0,0 +1,173 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include "interpreter/profile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace verona::interpreter
+{
+  void BigramProfile::merge(const BigramProfile& other)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < OPCODES; i++)
+    {
+      for (size_t j = 0; j < OPCODES; j++)
+        counts_[i][j] += other.counts_[i][j];
+    }
+  }
+
+  void BigramProfile::report(std::ostream& out, size_t limit) const
+  {
+    std::vector<std::tuple<uint64_t, Opcode, Opcode>> pairs;
+    uint64_t total = 0;
+    for (size_t i = 0; i < OPCODES; i++)
+    {
+      for (size_t j = 0; j < OPCODES; j++)
+      {
+        uint64_t count = counts_[i][j];
+        if (count == 0)
+          continue;
+
+        total += count;
+        pairs.push_back(
+          {count, static_cast<Opcode>(i), static_cast<Opcode>(j)});
+      }
+    }
+
+    std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) {
+      return std::get<0>(a) > std::get<0>(b);
+    });
+    pairs.resize(std::min(pairs.size(), limit));
+
+    out << "Instruction pairs executed: " << total << std::endl;
+    for (const auto& [count, first, second] : pairs)
+    {
+      double percent = 100.0 * static_cast<double>(count) / total;
+      out << std::setw(14) << count << std::setw(8) << std::fixed
+          << std::setprecision(2) << percent << "%  " << first << " -> "
+          << second << std::endl;
+    }
+  }
+
+  void Profile::end_sample()
+  {
+    uint64_t cycles =
+      (snmalloc::Aal::tick() - sample_start_) * SAMPLE_INTERVAL;
+    sampling_ = false;
+
+    opcodes_[static_cast<size_t>(sample_opcode_)].cycles += cycles;
+    functions_[stack_.back()].cycles += cycles;
+    stacks_[stack_] += cycles;
+  }
+
+  void Profile::merge(const Profile& other)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < opcodes_.size(); i++)
+    {
+      opcodes_[i].count += other.opcodes_[i].count;
+      opcodes_[i].cycles += other.opcodes_[i].cycles;
+    }
+
+    for (const auto& [function, profile] : other.functions_)
+    {
+      FunctionProfile& mine = functions_[function];
+      mine.calls += profile.calls;
+      mine.whens += profile.whens;
+      mine.cowns += profile.cowns;
+      mine.cycles += profile.cycles;
+    }
+
+    for (const auto& [stack, cycles] : other.stacks_)
+    {
+      stacks_[stack] += cycles;
+    }
+  }
+
+  void Profile::report(std::ostream& out, size_t limit) const
+  {
+    uint64_t instructions = 0;
+    uint64_t total = 0;
+    for (const OpcodeProfile& profile : opcodes_)
+    {
+      instructions += profile.count;
+      total += profile.cycles;
+    }
+
+    auto percent = [&](uint64_t cycles) {
+      return total == 0 ? 0.0 : 100.0 * static_cast<double>(cycles) / total;
+    };
+
+    out << "Instructions executed: " << instructions
+        << ", estimated cycles: " << total << std::endl;
+
+    std::vector<std::pair<const Function*, FunctionProfile>> functions(
+      functions_.begin(), functions_.end());
+    std::sort(
+      functions.begin(), functions.end(), [](const auto& a, const auto& b) {
+        return a.second.cycles > b.second.cycles;
+      });
+    functions.resize(std::min(functions.size(), limit));
+
+    out << std::fixed << std::setprecision(2);
+    out << std::setw(14) << "cycles" << std::setw(9) << "" << std::setw(12)
+        << "calls" << std::setw(12) << "whens" << std::setw(12) << "cowns"
+        << "  function" << std::endl;
+    for (const auto& [function, profile] : functions)
+    {
+      out << std::setw(14) << profile.cycles << std::setw(8)
+          << percent(profile.cycles) << "%" << std::setw(12) << profile.calls
+          << std::setw(12) << profile.whens << std::setw(12) << profile.cowns
+          << "  " << function->header.name << std::endl;
+    }
+
+    std::vector<std::pair<Opcode, OpcodeProfile>> opcodes;
+    for (size_t i = 0; i < opcodes_.size(); i++)
+    {
+      if (opcodes_[i].count > 0)
+        opcodes.push_back({static_cast<Opcode>(i), opcodes_[i]});
+    }
+    std::sort(opcodes.begin(), opcodes.end(), [](const auto& a, const auto& b) {
+      return a.second.cycles > b.second.cycles;
+    });
+    opcodes.resize(std::min(opcodes.size(), limit));
+
+    out << std::setw(14) << "cycles" << std::setw(9) << "" << std::setw(12)
+        << "count" << std::setw(12) << "cycles/op"
+        << "  opcode" << std::endl;
+    for (const auto& [opcode, profile] : opcodes)
+    {
+      double average = static_cast<double>(profile.cycles) / profile.count;
+      out << std::setw(14) << profile.cycles << std::setw(8)
+          << percent(profile.cycles) << "%" << std::setw(12) << profile.count
+          << std::setw(12) << average << "  " << opcode << std::endl;
+    }
+  }
+
+  void Profile::write_stacks(std::ostream& out) const
+  {
+    // Stacks are kept by Function, and merged here in case two functions share
+    // a name. Sorting them by name also keeps the output deterministic.
+    std::map<std::string, uint64_t> collapsed;
+    for (const auto& [stack, cycles] : stacks_)
+    {
+      std::string line;
+      for (const Function* function : stack)
+      {
+        if (!line.empty())
+          line += ';';
+        line += function->header.name;
+      }
+      collapsed[line] += cycles;
+    }
+
+    for (const auto& [line, cycles] : collapsed)
+    {
+      out << line << " " << cycles << "\n";
+    }
+  }
+}
@@ -0,0 +1,225 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "interpreter/bytecode.h"
+#include "interpreter/function.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include <verona.h>
+
+namespace verona::interpreter
+{
+  using bytecode::Opcode;
+
+  /**
+   * Number of times each pair of opcodes was executed one after the other.
+   *
+   * This is used to pick the sequences of instructions worth fusing into
+   * superinstructions. Every VM counts the instructions it interprets in its
+   * own profile, and adds it to a profile shared by all threads when it is
+   * destroyed. Instructions run as native code by the Jit are not counted.
+   */
+  class BigramProfile
+  {
+  public:
+    static constexpr size_t OPCODES =
+      static_cast<size_t>(Opcode::maximum_value) + 1;
+
+    /**
+     * Count an instruction, paired with the previous one.
+     */
+    void record(Opcode opcode)
+    {
+      size_t index = static_cast<size_t>(opcode);
+      if (previous_ < OPCODES)
+        counts_[previous_][index]++;
+      previous_ = index;
+    }
+
+    /**
+     * Don't pair the next instruction with the previous one, because the VM
+     * has started running other code.
+     */
+    void restart()
+    {
+      previous_ = OPCODES;
+    }
+
+    /**
+     * Add the counts of another profile to this one. This may be called
+     * concurrently.
+     */
+    void merge(const BigramProfile& other);
+
+    /**
+     * Print the `limit` most frequent pairs.
+     */
+    void report(std::ostream& out, size_t limit = 20) const;
+
+  private:
+    std::array<std::array<uint64_t, OPCODES>, OPCODES> counts_ = {};
+    size_t previous_ = OPCODES;
+    std::mutex mutex_;
+  };
+
+  /**
+   * Where execution time is spent, by function, opcode and call stack.
+   *
+   * Instructions are counted by opcode, frames by function and `when`s by the
+   * function issuing them, along with the number of cowns they acquire. These
+   * counts are exact, except that jumps compiled by the Jit are not seen.
+   *
+   * Cycles are sampled, so that profiling stays cheap enough to leave on. On
+   * average one in `SAMPLE_INTERVAL` instructions is timed, from its dispatch
+   * to the dispatch of the next one, and charged `SAMPLE_INTERVAL` times to its
+   * opcode, its function and the stack of functions it was executed from. The
+   * gap between samples is random, so that loops don't always sample the same
+   * instructions. Time spent outside the VM, between behaviours, is never
+   * charged.
+   *
+   * Like BigramProfile, every VM has its own profile and adds it to a profile
+   * shared by all threads when it is destroyed.
+   */
+  class Profile
+  {
+  public:
+    static constexpr uint64_t SAMPLE_INTERVAL = 1024;
+
+    Profile()
+    {
+      countdown_ = next_countdown();
+    }
+
+    /**
+     * Count an instruction about to be executed, ending the current sample if
+     * any. Returns whether this instruction should be sampled, in which case
+     * `start_sample` must be called.
+     */
+    bool record(Opcode opcode)
+    {
+      if (sampling_)
+        end_sample();
+
+      opcodes_[static_cast<size_t>(opcode)].count++;
+      if (--countdown_ > 0)
+        return false;
+
+      countdown_ = next_countdown();
+      return true;
+    }
+
+    /**
+     * Start timing an instruction. `frames` is the VM's call stack, whose
+     * last frame is executing the instruction.
+     */
+    template<typename Frames>
+    void start_sample(Opcode opcode, const Frames& frames)
+    {
+      stack_.clear();
+      for (const auto& frame : frames)
+      {
+        stack_.push_back(frame.function);
+      }
+
+      sample_opcode_ = opcode;
+      sampling_ = true;
+      sample_start_ = snmalloc::Aal::tick();
+    }
+
+    /**
+     * End the current sample, if any, because the VM stopped running code.
+     */
+    void finish()
+    {
+      if (sampling_)
+        end_sample();
+    }
+
+    /**
+     * Count a new frame for the function.
+     */
+    void enter(const Function* function)
+    {
+      functions_[function].calls++;
+    }
+
+    /**
+     * Count a `when` issued by the function.
+     */
+    void when(const Function* function, size_t cown_count)
+    {
+      FunctionProfile& profile = functions_[function];
+      profile.whens++;
+      profile.cowns += cown_count;
+    }
+
+    /**
+     * Add the counts of another profile to this one. This may be called
+     * concurrently.
+     */
+    void merge(const Profile& other);
+
+    /**
+     * Print the `limit` functions and opcodes with the most cycles.
+     */
+    void report(std::ostream& out, size_t limit = 20) const;
+
+    /**
+     * Write the cycles of every sampled call stack in the collapsed stack
+     * format, one stack per line, as read by flamegraph.pl.
+     */
+    void write_stacks(std::ostream& out) const;
+
+  private:
+    struct OpcodeProfile
+    {
+      uint64_t count = 0;
+      uint64_t cycles = 0;
+    };
+
+    struct FunctionProfile
+    {
+      uint64_t calls = 0;
+      uint64_t whens = 0;
+      uint64_t cowns = 0;
+      uint64_t cycles = 0;
+    };
+
+    void end_sample();
+
+    /**
+     * Number of instructions until the next sample, uniformly distributed
+     * between 1 and `2 * SAMPLE_INTERVAL - 1`.
+     */
+    uint64_t next_countdown()
+    {
+      // xorshift64
+      random_ ^= random_ << 13;
+      random_ ^= random_ >> 7;
+      random_ ^= random_ << 17;
+      return 1 + random_ % (2 * SAMPLE_INTERVAL - 1);
+    }
+
+    std::array<OpcodeProfile, BigramProfile::OPCODES> opcodes_ = {};
+    std::unordered_map<const Function*, FunctionProfile> functions_;
+    std::map<std::vector<const Function*>, uint64_t> stacks_;
+
+    uint64_t countdown_;
+    uint64_t random_ = 0x9e3779b97f4a7c15;
+
+    bool sampling_ = false;
+    Opcode sample_opcode_;
+    uint64_t sample_start_;
+    std::vector<const Function*> stack_;
+
+    std::mutex mutex_;
+  };
+}
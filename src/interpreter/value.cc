@@ -7,95 +7,74 @@
 
 namespace verona::interpreter
 {
+  static_assert(rt::Object::ALIGNMENT >= alignof(VMString));
+  static_assert(alignof(VMDescriptor) >= alignof(VMString));
+
   Value Value::u64(uint64_t value)
   {
-    Value v;
-    v.tag = U64;
-    v.inner.u64 = value;
-    return v;
-  }
+    uintptr_t bits = static_cast<uintptr_t>(value) << KIND_BITS;
+    if (
+      (static_cast<int64_t>(bits) >> static_cast<int64_t>(KIND_BITS)) ==
+      static_cast<int64_t>(value))
+    {
+      return Value(bits | static_cast<uintptr_t>(Kind::U64));
+    }
 
-  Value Value::string(std::string value)
-  {
-    Value v;
-    v.tag = STRING;
-    v.inner.string_ptr = new std::string(std::move(value));
-    return v;
+    return Value(encode(Kind::U64_BOXED, new BoxedU64{value}));
   }
 
-  Value Value::string(std::string_view value)
+  Value Value::string(const VMString* value)
   {
-    return Value::string(std::string(value));
+    return Value(encode(Kind::STRING, value));
   }
 
   Value Value::iso(VMObject* object)
   {
     assert(object->debug_is_iso());
-    Value v;
-    v.tag = ISO;
-    v.inner.object = object;
-    return v;
+    return Value(encode(Kind::ISO, object));
   }
 
   Value Value::mut(VMObject* object)
   {
     assert(object->debug_is_iso() || object->debug_is_mutable());
-    Value v;
-    v.tag = MUT;
-    v.inner.object = object;
-    return v;
+    return Value(encode(Kind::MUT, object));
   }
 
   Value Value::imm(VMObject* object)
   {
     assert(object->debug_is_immutable());
-    Value v;
-    v.tag = IMM;
-    v.inner.object = object;
-    return v;
+    return Value(encode(Kind::IMM, object));
   }
 
   Value Value::cown(VMCown* cown)
   {
-    Value v;
-    v.tag = COWN;
-    v.inner.cown = cown;
-    return v;
+    return Value(encode(Kind::COWN, cown));
   }
 
   Value Value::unowned_cown(VMCown* cown)
   {
-    Value v;
-    v.tag = COWN_UNOWNED;
-    v.inner.cown = cown;
-    return v;
+    return Value(encode(Kind::COWN_UNOWNED, cown));
   }
 
   Value Value::descriptor(const VMDescriptor* descriptor)
   {
-    Value v;
-    v.tag = DESCRIPTOR;
-    v.inner.descriptor = descriptor;
-    return v;
+    return Value(encode(Kind::DESCRIPTOR, descriptor));
   }
 
-  Value::Value(Value&& other)
+  Value::Value(Value&& other) : bits_(other.bits_)
   {
-    this->tag = other.tag;
-    this->inner = other.inner;
-    other.tag = UNINIT;
+    other.bits_ = 0;
   }
 
   void Value::overwrite(rt::Alloc* alloc, Value&& other)
   {
-    std::swap(this->tag, other.tag);
-    std::swap(this->inner, other.inner);
+    std::swap(this->bits_, other.bits_);
     other.clear(alloc);
   }
 
   Value::~Value()
   {
-    if (tag != UNINIT)
+    if (bits_ != 0)
     {
       std::cerr << "Dropped an initialized Value" << std::endl;
       abort();
@@ -104,41 +83,45 @@ namespace verona::interpreter
 
   void Value::clear(rt::Alloc* alloc)
   {
-    switch (tag)
+    switch (kind_of(bits_))
     {
-      case COWN:
-        rt::Cown::release(alloc, inner.cown);
+      case Kind::COWN:
+        rt::Cown::release(alloc, pointer<VMCown>(bits_));
         break;
 
-      case ISO:
-        rt::Region::release(alloc, inner.object);
+      case Kind::ISO:
+        rt::Region::release(alloc, pointer<VMObject>(bits_));
         break;
 
-      case IMM:
-        rt::Immutable::release(alloc, inner.object);
+      case Kind::IMM:
+        rt::Immutable::release(alloc, pointer<VMObject>(bits_));
         break;
 
-      case STRING:
-        delete inner.string_ptr;
+      case Kind::U64_BOXED:
+        delete pointer<BoxedU64>(bits_);
         break;
 
-      case MUT:
-      case UNINIT:
-      case U64:
-      case DESCRIPTOR:
-      case COWN_UNOWNED:
+      case Kind::MUT:
+      case Kind::UNINIT:
+      case Kind::U64:
+      case Kind::STRING:
+      case Kind::DESCRIPTOR:
+      case Kind::COWN_UNOWNED:
         break;
     }
-    tag = UNINIT;
+    bits_ = 0;
   }
 
   VMCown* Value::consume_cown()
   {
-    switch (tag)
+    switch (kind_of(bits_))
     {
-      case COWN:
-        tag = UNINIT;
-        return inner.cown;
+      case Kind::COWN:
+      {
+        VMCown* cown = pointer<VMCown>(bits_);
+        bits_ = 0;
+        return cown;
+      }
       default:
         abort();
     }
@@ -146,10 +129,10 @@ namespace verona::interpreter
 
   Value Value::as_unowned_cown() const
   {
-    switch (tag)
+    switch (kind_of(bits_))
     {
-      case COWN:
-        return Value::unowned_cown(inner.cown);
+      case Kind::COWN:
+        return Value::unowned_cown(pointer<VMCown>(bits_));
 
       default:
         abort();
@@ -158,51 +141,55 @@ namespace verona::interpreter
 
   Value Value::cown_body() const
   {
-    switch (tag)
+    switch (kind_of(bits_))
     {
-      case COWN:
-      case COWN_UNOWNED:
-        return Value::mut(inner.cown->contents);
+      case Kind::COWN:
+      case Kind::COWN_UNOWNED:
+        return Value::mut(pointer<VMCown>(bits_)->contents);
       default:
         abort();
     }
   }
 
-  Value Value::maybe_consume()
+  Value Value::copy_unowned(uintptr_t bits)
   {
-    switch (tag)
-    {
-      case UNINIT:
-        return Value();
-
-      case U64:
-        return Value::u64(inner.u64);
-
-      case STRING:
-        return Value::string(inner.string());
+    if (kind_of(bits) == Kind::U64_BOXED)
+      return Value::u64(pointer<const BoxedU64>(bits)->value);
 
-      case DESCRIPTOR:
-        return Value::descriptor(inner.descriptor);
-
-      case COWN:
-        rt::Cown::acquire(inner.cown);
-        return Value::cown(inner.cown);
+    return Value(bits);
+  }
 
-      case COWN_UNOWNED:
+  Value Value::maybe_consume()
+  {
+    switch (kind_of(bits_))
+    {
+      case Kind::UNINIT:
+      case Kind::U64:
+      case Kind::U64_BOXED:
+      case Kind::STRING:
+      case Kind::DESCRIPTOR:
+      case Kind::MUT:
+        return copy_unowned(bits_);
+
+      case Kind::COWN:
+        rt::Cown::acquire(pointer<VMCown>(bits_));
+        return Value(bits_);
+
+      case Kind::COWN_UNOWNED:
         abort();
 
-      case ISO:
+      case Kind::ISO:
+      {
         // Mark the Value as empty, since we are transferring ownership of the
         // region out of it.
-        tag = UNINIT;
-        return Value::iso(inner.object);
+        Value result(bits_);
+        bits_ = 0;
+        return result;
+      }
 
-      case MUT:
-        return Value::mut(inner.object);
-
-      case IMM:
-        rt::Immutable::acquire(inner.object);
-        return Value::imm(inner.object);
+      case Kind::IMM:
+        rt::Immutable::acquire(pointer<VMObject>(bits_));
+        return Value(bits_);
 
         EXHAUSTIVE_SWITCH
     }
@@ -210,58 +197,51 @@ namespace verona::interpreter
 
   VMObject* Value::consume_iso()
   {
-    assert(tag == ISO);
-    tag = UNINIT;
-    return inner.object;
+    assert(tag() == ISO);
+    VMObject* object = pointer<VMObject>(bits_);
+    bits_ = 0;
+    return object;
   }
 
   Value FieldValue::read(Value::Tag parent)
   {
     assert(
       parent == Value::ISO || parent == Value::MUT || parent == Value::IMM);
-    switch (tag)
-    {
-      case Value::UNINIT:
-        return Value();
 
-      case Value::U64:
-        return Value::u64(inner.u64);
-
-      case Value::STRING:
-        return Value::string(inner.string());
-
-      case Value::DESCRIPTOR:
-        return Value::descriptor(inner.descriptor);
-
-      case Value::ISO:
+    using Kind = Value::Kind;
+    switch (Value::kind_of(bits_))
+    {
+      case Kind::UNINIT:
+      case Kind::U64:
+      case Kind::U64_BOXED:
+      case Kind::STRING:
+      case Kind::DESCRIPTOR:
+        return Value::copy_unowned(bits_);
+
+      case Kind::ISO:
+      case Kind::MUT:
+      {
+        VMObject* object = Value::pointer<VMObject>(bits_);
         if (parent == Value::IMM)
         {
-          rt::Immutable::acquire(inner.object);
-          return Value::imm(inner.object);
+          rt::Immutable::acquire(object);
+          return Value::imm(object);
         }
 
         // We return a MUT value, even if this is an ISO field.
         // FieldValue::exchange must be used to extract the field as ISO.
-        return Value::mut(inner.object);
+        return Value::mut(object);
+      }
 
-      case Value::MUT:
-        if (parent == Value::IMM)
-        {
-          rt::Immutable::acquire(inner.object);
-          return Value::imm(inner.object);
-        }
-
-        return Value::mut(inner.object);
+      case Kind::IMM:
+        rt::Immutable::acquire(Value::pointer<VMObject>(bits_));
+        return Value(bits_);
 
-      case Value::IMM:
-        rt::Immutable::acquire(inner.object);
-        return Value::imm(inner.object);
-
-      case Value::COWN:
-        rt::Cown::acquire(inner.cown);
-        return Value::cown(inner.cown);
+      case Kind::COWN:
+        rt::Cown::acquire(Value::pointer<VMCown>(bits_));
+        return Value(bits_);
 
-      case Value::COWN_UNOWNED:
+      case Kind::COWN_UNOWNED:
         // Cannot be used in the heap.  Only used in messages
         abort();
 
@@ -272,62 +252,57 @@ namespace verona::interpreter
   Value
   FieldValue::exchange(rt::Alloc* alloc, rt::Object* region, Value&& value)
   {
-    switch (value.tag)
+    switch (value.tag())
     {
       case Value::IMM:
-        assert(value.inner.object->debug_is_immutable());
+        assert(value->object->debug_is_immutable());
         // TODO(region): For now, only allow inserting into trace regions.
         assert(rt::RegionTrace::is_trace_region(rt::Region::get(region)));
-        rt::RegionTrace::insert<rt::YesTransfer>(
-          alloc, region, value.inner.object);
+        rt::RegionTrace::insert<rt::YesTransfer>(alloc, region, value->object);
         break;
       case Value::COWN:
         // TODO(region): For now, only allow inserting into trace regions.
         assert(rt::RegionTrace::is_trace_region(rt::Region::get(region)));
-        rt::RegionTrace::insert<rt::YesTransfer>(
-          alloc, region, value.inner.cown);
+        rt::RegionTrace::insert<rt::YesTransfer>(alloc, region, value->cown);
         break;
       default:
         break;
     }
 
-    switch (tag)
+    switch (tag())
     {
       case Value::IMM:
-        assert(inner.object->debug_is_immutable());
-        rt::Immutable::acquire(inner.object);
+        assert(inner().object->debug_is_immutable());
+        rt::Immutable::acquire(inner().object);
         break;
 
       case Value::COWN:
-        rt::Cown::acquire(inner.cown);
+        rt::Cown::acquire(inner().cown);
         break;
 
       default:
         break;
     }
 
-    Value result;
-    result.tag = this->tag;
-    result.inner = this->inner;
-    this->tag = value.tag;
-    this->inner = value.inner;
-    value.tag = Value::UNINIT;
+    Value result(this->bits_);
+    this->bits_ = value.bits_;
+    value.bits_ = 0;
 
     return result;
   }
 
   void FieldValue::trace(rt::ObjectStack& stack) const
   {
-    switch (tag)
+    switch (tag())
     {
       case Value::ISO:
       case Value::MUT:
       case Value::IMM:
-        stack.push(inner.object);
+        stack.push(inner().object);
         break;
 
       case Value::COWN:
-        stack.push(inner.cown);
+        stack.push(inner().cown);
         break;
 
       case Value::UNINIT:
@@ -346,10 +321,10 @@ namespace verona::interpreter
 
   void FieldValue::add_isos(rt::ObjectStack& stack) const
   {
-    switch (tag)
+    switch (tag())
     {
       case Value::ISO:
-        stack.push(inner.object);
+        stack.push(inner().object);
         break;
 
       case Value::COWN:
@@ -371,25 +346,27 @@ namespace verona::interpreter
 
   FieldValue::~FieldValue()
   {
-    switch (tag)
+    using Kind = Value::Kind;
+    switch (Value::kind_of(bits_))
     {
-      case Value::STRING:
-        delete inner.string_ptr;
+      case Kind::U64_BOXED:
+        delete Value::pointer<Value::BoxedU64>(bits_);
         break;
 
-      case Value::ISO:
-      case Value::MUT:
-      case Value::IMM:
-      case Value::COWN:
+      case Kind::ISO:
+      case Kind::MUT:
+      case Kind::IMM:
+      case Kind::COWN:
         // These are handled by the GC.
         break;
 
-      case Value::DESCRIPTOR:
-      case Value::U64:
-      case Value::UNINIT:
+      case Kind::STRING:
+      case Kind::DESCRIPTOR:
+      case Kind::U64:
+      case Kind::UNINIT:
         break;
 
-      case Value::COWN_UNOWNED:
+      case Kind::COWN_UNOWNED:
         // Cannot be part of the heap.
         abort();
 
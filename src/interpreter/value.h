@@ -12,6 +12,18 @@ namespace verona::interpreter
   struct VMDescriptor;
   struct VMObject;
   struct VMCown;
+  struct FieldValue;
+
+  /**
+   * A string literal of the program.
+   *
+   * Literals are interned in the Code's string table, which outlives every
+   * Value, so Values refer to them without owning them.
+   */
+  struct alignas(16) VMString
+  {
+    std::string value;
+  };
 
   /**
    * Tagged Verona value, which handles ownership of objects and reference
@@ -20,6 +32,10 @@ namespace verona::interpreter
    * Used for stack variables, and temporaries through out the VM
    * implementation.
    *
+   * A Value is a single word. Its low bits hold the kind of value and the rest
+   * holds either a pointer, which must be aligned to 16 bytes, or a small
+   * integer. Integers which don't fit are boxed on the heap.
+   *
    * Because releasing ownership may require access to the local allocator, a
    * Value must explicitly be cleared before destruction, by calling
    * `clear(Alloc*)`. Failing to do so will result in an abort.
@@ -42,6 +58,9 @@ namespace verona::interpreter
       STRING,
     };
 
+    /**
+     * Decoded contents of a Value.
+     */
     union Inner
     {
       // Used by the ISO, MUT and IMM variants.
@@ -49,27 +68,31 @@ namespace verona::interpreter
       VMCown* cown;
       const VMDescriptor* descriptor;
       uint64_t u64;
-      std::string* string_ptr;
+      const VMString* string_ptr;
 
-      std::string& string()
+      const std::string& string() const
       {
-        return *string_ptr;
+        return string_ptr->value;
       }
+    };
 
-      const std::string& string() const
+    /**
+     * Result of `operator->`, holding the decoded contents of the Value.
+     */
+    struct InnerRef
+    {
+      Inner inner;
+
+      const Inner* operator->() const
       {
-        return *string_ptr;
+        return &inner;
       }
     };
 
-    Tag tag;
-    Inner inner;
-
-    Value() : tag(Tag::UNINIT) {}
+    Value() : bits_(0) {}
 
     static Value u64(uint64_t value);
-    static Value string(std::string value);
-    static Value string(std::string_view value);
+    static Value string(const VMString* value);
 
     // Takes ownership of the region.
     static Value iso(VMObject* object);
@@ -149,13 +172,19 @@ namespace verona::interpreter
      */
     Value cown_body() const;
 
-    Inner* operator->()
+    Tag tag() const
     {
-      return &inner;
+      return tag_of(bits_);
     }
-    const Inner* operator->() const
+
+    Inner inner() const
     {
-      return &inner;
+      return decode(bits_);
+    }
+
+    InnerRef operator->() const
+    {
+      return {inner()};
     }
 
     void trace(rt::ObjectStack& stack) const;
@@ -169,8 +198,143 @@ namespace verona::interpreter
     static constexpr Tag COWN = Tag::COWN;
     static constexpr Tag COWN_UNOWNED = Tag::COWN_UNOWNED;
     static constexpr Tag STRING = Tag::STRING;
+
+  private:
+    friend FieldValue;
+
+    /**
+     * Kind of value held in the low bits of the word. The values match those
+     * of Tag, except that integers have a second kind for boxed values.
+     */
+    enum class Kind : uintptr_t
+    {
+      UNINIT = static_cast<uintptr_t>(Tag::UNINIT),
+      ISO = static_cast<uintptr_t>(Tag::ISO),
+      MUT = static_cast<uintptr_t>(Tag::MUT),
+      IMM = static_cast<uintptr_t>(Tag::IMM),
+      DESCRIPTOR = static_cast<uintptr_t>(Tag::DESCRIPTOR),
+      U64 = static_cast<uintptr_t>(Tag::U64),
+      COWN = static_cast<uintptr_t>(Tag::COWN),
+      COWN_UNOWNED = static_cast<uintptr_t>(Tag::COWN_UNOWNED),
+      STRING = static_cast<uintptr_t>(Tag::STRING),
+      U64_BOXED,
+    };
+
+    static constexpr size_t KIND_BITS = 4;
+    static constexpr uintptr_t KIND_MASK = (uintptr_t(1) << KIND_BITS) - 1;
+
+    /**
+     * Heap storage for integers that don't fit in the word. A boxed integer is
+     * owned by a single Value or FieldValue, and copied with it.
+     */
+    struct alignas(16) BoxedU64
+    {
+      uint64_t value;
+    };
+
+    uintptr_t bits_;
+
+    explicit Value(uintptr_t bits) : bits_(bits) {}
+
+    static Kind kind_of(uintptr_t bits)
+    {
+      return static_cast<Kind>(bits & KIND_MASK);
+    }
+
+    static Tag tag_of(uintptr_t bits)
+    {
+      Kind kind = kind_of(bits);
+      if (kind == Kind::U64_BOXED)
+        return Tag::U64;
+      return static_cast<Tag>(kind);
+    }
+
+    template<typename T>
+    static uintptr_t encode(Kind kind, T* pointer)
+    {
+      uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+      assert((address & KIND_MASK) == 0);
+      return address | static_cast<uintptr_t>(kind);
+    }
+
+    template<typename T>
+    static T* pointer(uintptr_t bits)
+    {
+      return reinterpret_cast<T*>(bits & ~KIND_MASK);
+    }
+
+    static Inner decode(uintptr_t bits)
+    {
+      Inner inner;
+      switch (kind_of(bits))
+      {
+        case Kind::ISO:
+        case Kind::MUT:
+        case Kind::IMM:
+          inner.object = pointer<VMObject>(bits);
+          break;
+
+        case Kind::COWN:
+        case Kind::COWN_UNOWNED:
+          inner.cown = pointer<VMCown>(bits);
+          break;
+
+        case Kind::DESCRIPTOR:
+          inner.descriptor = pointer<const VMDescriptor>(bits);
+          break;
+
+        case Kind::STRING:
+          inner.string_ptr = pointer<const VMString>(bits);
+          break;
+
+        case Kind::U64:
+          // Small integers are stored sign-extended.
+          inner.u64 = static_cast<uint64_t>(
+            static_cast<int64_t>(bits) >> static_cast<int64_t>(KIND_BITS));
+          break;
+
+        case Kind::U64_BOXED:
+          inner.u64 = pointer<const BoxedU64>(bits)->value;
+          break;
+
+        case Kind::UNINIT:
+          inner.u64 = 0;
+          break;
+      }
+      return inner;
+    }
+
+    /**
+     * Copy the word `bits`, where a copy of the contents doesn't need any
+     * ownership. Boxed integers are copied into a new box.
+     */
+    static Value copy_unowned(uintptr_t bits);
+
+  public:
+    /**
+     * Encoding of Values, for native code that reads and writes their words
+     * directly. Sets of kinds are bitsets, indexed by the low `KIND_BITS` of a
+     * word.
+     *
+     * Words of an unowned kind can be overwritten without releasing anything.
+     * Words of a plain kind can also be copied bit for bit, and moved between
+     * registers and fields without any bookkeeping.
+     */
+    static constexpr size_t ENCODING_KIND_BITS = KIND_BITS;
+    static constexpr uintptr_t ENCODING_U64_KIND =
+      static_cast<uintptr_t>(Kind::U64);
+    static constexpr uint32_t PLAIN_KINDS =
+      (uint32_t(1) << static_cast<uint32_t>(Kind::UNINIT)) |
+      (uint32_t(1) << static_cast<uint32_t>(Kind::DESCRIPTOR)) |
+      (uint32_t(1) << static_cast<uint32_t>(Kind::U64)) |
+      (uint32_t(1) << static_cast<uint32_t>(Kind::STRING));
+    static constexpr uint32_t UNOWNED_KINDS = PLAIN_KINDS |
+      (uint32_t(1) << static_cast<uint32_t>(Kind::MUT)) |
+      (uint32_t(1) << static_cast<uint32_t>(Kind::COWN_UNOWNED));
   };
 
+  static_assert(sizeof(Value) == sizeof(uintptr_t));
+
   /**
    * Alternative to Value used for fields.
    *
@@ -180,7 +344,7 @@ namespace verona::interpreter
   struct FieldValue
   {
   public:
-    FieldValue() : tag(Value::UNINIT) {}
+    FieldValue() : bits_(0) {}
     ~FieldValue();
 
     /**
@@ -214,7 +378,17 @@ namespace verona::interpreter
     friend fmt::formatter<Value>;
 
   private:
-    Value::Tag tag;
-    Value::Inner inner;
+    // Uses the same encoding as Value.
+    uintptr_t bits_;
+
+    Value::Tag tag() const
+    {
+      return Value::tag_of(bits_);
+    }
+
+    Value::Inner inner() const
+    {
+      return Value::decode(bits_);
+    }
   };
 }
@@ -0,0 +1,164 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include "interpreter/verifier.h"
+
+#include <fmt/format.h>
+
+namespace verona::interpreter
+{
+  namespace
+  {
+    class Verifier
+    {
+    public:
+      explicit Verifier(const Code& code)
+      : code_(code),
+        method_slots_(code.max_method_slots()),
+        field_slots_(code.max_field_slots())
+      {}
+
+      void verify_function(const Function& function)
+      {
+        function_ = &function;
+        const FunctionHeader& header = function.header;
+
+        if (header.locals < header.argc || header.locals < header.retc)
+        {
+          error(
+            function.address,
+            "frame of {:d} registers is too small for {:d} arguments and {:d} "
+            "return values",
+            header.locals,
+            header.argc,
+            header.retc);
+        }
+
+        for (const Instruction& instruction : function.instructions)
+        {
+          visit_opcode(instruction.opcode, [&](auto op) {
+            constexpr Opcode opcode = decltype(op)::value;
+            verify_instruction<opcode>(
+              instruction, instruction.operands<opcode>());
+          });
+        }
+      }
+
+    private:
+      const Code& code_;
+      const Function* function_ = nullptr;
+      const size_t method_slots_;
+      const size_t field_slots_;
+
+      template<typename... Args>
+      [[noreturn]] void
+      error(size_t offset, std::string_view fmt, Args&&... args) const
+      {
+        throw std::logic_error(fmt::format(
+          "Invalid bytecode in {} at {:#x}: {}",
+          function_->header.name,
+          offset,
+          fmt::format(fmt, std::forward<Args>(args)...)));
+      }
+
+      template<Opcode opcode, typename... Args>
+      void verify_instruction(
+        const Instruction& instruction, const std::tuple<Args...>& operands)
+      {
+        std::apply(
+          [&](const auto&... args) {
+            (verify_operand(instruction, args), ...);
+          },
+          operands);
+
+        if constexpr (opcode == Opcode::Call)
+        {
+          auto [selector, callspace, cache] = operands;
+          if (callspace == 0 || callspace > function_->header.locals)
+            error(instruction.offset, "invalid call space {:d}", callspace);
+          if (selector >= method_slots_)
+            error(instruction.offset, "invalid method selector {}", selector);
+        }
+        else if constexpr (opcode == Opcode::CallArgs)
+        {
+          auto [selector, callspace, argc, args, cache] = operands;
+          if (callspace == 0 || callspace > function_->header.locals)
+            error(instruction.offset, "invalid call space {:d}", callspace);
+          if (argc > callspace)
+          {
+            error(
+              instruction.offset,
+              "{:d} arguments do not fit in call space {:d}",
+              argc,
+              callspace);
+          }
+          if (selector >= method_slots_)
+            error(instruction.offset, "invalid method selector {}", selector);
+          verify_operand(instruction, bytecode::RegisterSpan(args, argc));
+        }
+        else if constexpr (opcode == Opcode::When)
+        {
+          auto [closure, cown_count, capture_count] = operands;
+          size_t callspace = cown_count + capture_count + 1;
+          if (callspace > function_->header.locals)
+            error(instruction.offset, "invalid call space {:d}", callspace);
+          if (callspace > closure->header.argc)
+          {
+            error(
+              instruction.offset,
+              "call space {:d} too large for {}",
+              callspace,
+              closure->header.name);
+          }
+        }
+        else if constexpr (
+          opcode == Opcode::Load || opcode == Opcode::Store)
+        {
+          verify_field(instruction, std::get<2>(operands));
+        }
+        else if constexpr (opcode == Opcode::LoadLoad)
+        {
+          verify_field(instruction, std::get<2>(operands));
+          verify_field(instruction, std::get<5>(operands));
+        }
+        else if constexpr (opcode == Opcode::LoadDescriptor)
+        {
+          DescriptorIdx descriptor = std::get<1>(operands);
+          if (descriptor >= code_.descriptors().size())
+            error(instruction.offset, "invalid descriptor {}", descriptor);
+        }
+      }
+
+      void verify_field(const Instruction& instruction, SelectorIdx selector)
+      {
+        if (selector >= field_slots_)
+          error(instruction.offset, "invalid field selector {}", selector);
+      }
+
+      template<typename T>
+      void verify_operand(const Instruction& instruction, const T& operand)
+      {
+        if constexpr (std::is_same_v<T, Register>)
+        {
+          if (operand.index >= function_->header.locals)
+          {
+            error(
+              instruction.offset,
+              "register {:d} outside of frame of {:d} registers",
+              operand.index,
+              function_->header.locals);
+          }
+        }
+        else if constexpr (std::is_same_v<T, bytecode::RegisterSpan>)
+        {
+          for (const Register& reg : operand)
+            verify_operand(instruction, reg);
+        }
+      }
+    };
+  }
+
+  void verify(const Code& code, const Function& function)
+  {
+    Verifier(code).verify_function(function);
+  }
+}
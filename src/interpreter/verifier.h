@@ -0,0 +1,31 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "interpreter/code.h"
+
+namespace verona::interpreter
+{
+  /**
+   * Check that a decoded function is well-formed, throwing a std::logic_error
+   * if it is not. Functions are verified as they are decoded, by
+   * `Code::prepare`.
+   *
+   * Once a function has been verified, the VM can execute it without checking
+   * register accesses and call sizes on every instruction. The verifier
+   * checks:
+   * - the frame is large enough for the arguments and return values.
+   * - every register operand is within the frame.
+   * - the call space of every Call, CallArgs and When fits in the frame, the
+   *   arguments of a CallArgs fit in its call space, and a When's call space
+   *   matches the arguments of its closure.
+   * - selector and descriptor operands are in range for the program.
+   *
+   * Jump targets are already checked when the program is decoded.
+   *
+   * Properties that depend on the values in registers, such as their types or
+   * whether the receiver of a call has the method, are still checked when the
+   * program runs.
+   */
+  void verify(const Code& code, const Function& function);
+}
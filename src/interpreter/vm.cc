@@ -6,23 +6,39 @@
 #include "interpreter/format.h"
 #include "interpreter/value_list.h"
 
+#include <array>
+#include <cstddef>
 #include <fmt/ranges.h>
+#include <limits>
 
 namespace verona::interpreter
 {
-  void VM::run(std::vector<Value> args, size_t cown_count, size_t start)
+  VM::~VM()
+  {
+    if (bigrams_ != nullptr)
+      shared_bigrams_->merge(*bigrams_);
+    if (profile_ != nullptr)
+      shared_profile_->merge(*profile_);
+
+    for (size_t i = 0; i < stack_size_; i++)
+      stack_[i].~Value();
+    std::free(stack_);
+  }
+
+  void VM::run(
+    Value* args, size_t argc, size_t cown_count, const Function* start)
   {
     assert(cfstack_.empty());
 
     halt_ = false;
-    push_frame(start, 0, OnReturn::Halt);
+    push_frame(prepare(start), 0, OnReturn::Halt);
 
-    assert(static_cast<size_t>(frame().argc) == args.size());
+    assert(static_cast<size_t>(frame().argc) == argc);
 
     // First argument is the receiver, followed by cown_count cowns that are
     // being acquired, followed by captures. The cowns need to be transformed
     // so we actually pass their contents to the behaviour instead.
-    for (size_t i = 0; i < args.size(); i++)
+    for (size_t i = 0; i < argc; i++)
     {
       Register reg(truncate<uint8_t>(i));
       Value& value = args[i];
@@ -40,11 +56,23 @@ namespace verona::interpreter
     dispatch_loop();
   }
 
-  void VM::push_frame(size_t ip, size_t base, OnReturn on_return)
+  const Function* VM::prepare(const Function* function)
   {
-    FunctionHeader header = code_.function_header(ip);
+    try
+    {
+      return code_.prepare(function, !checked_);
+    }
+    catch (const std::logic_error& e)
+    {
+      fatal("{}", e.what());
+    }
+  }
+
+  void VM::push_frame(const Function* function, size_t base, OnReturn on_return)
+  {
+    const FunctionHeader& header = function->header;
 
-    start_ip_ = ip;
+    start_ip_ = function->address;
     trace(
       "Calling function {}, base={:d}, argc={:d} retc={:d} locals={:d}",
       header.name,
@@ -54,7 +82,8 @@ namespace verona::interpreter
       header.locals);
 
     Frame frame;
-    frame.ip = ip;
+    frame.function = function;
+    frame.ip = function->entry();
     frame.argc = header.argc;
     frame.retc = header.retc;
     frame.locals = header.locals;
@@ -63,16 +92,231 @@ namespace verona::interpreter
 
     grow_stack(frame.base + frame.locals);
     cfstack_.push_back(frame);
+
+    if (profile_ != nullptr)
+      profile_->enter(function);
   }
 
   void VM::dispatch_loop()
   {
+    if (bigrams_ != nullptr || profile_ != nullptr)
+    {
+      if (checked_)
+        dispatch_loop<true, true>();
+      else
+        dispatch_loop<false, true>();
+    }
+    else
+    {
+      if (checked_)
+        dispatch_loop<true, false>();
+      else
+        dispatch_loop<false, false>();
+    }
+
+    // The last instruction ran until the loop returned.
+    if (profile_ != nullptr)
+      profile_->finish();
+  }
+
+  void VM::profile_instruction(const Instruction& instruction)
+  {
+    if (bigrams_ != nullptr)
+      bigrams_->record(instruction.opcode);
+    if (profile_ != nullptr)
+      profile_opcode(instruction.opcode);
+  }
+
+  void VM::profile_opcode(Opcode opcode)
+  {
+    if (profile_->record(opcode))
+      profile_->start_sample(opcode, cfstack_);
+  }
+
+  template<bool Checked, bool Profiled>
+  void VM::dispatch_loop()
+  {
+    if (Profiled && bigrams_ != nullptr)
+      bigrams_->restart();
+
+#if defined(__GNUC__) || defined(__clang__)
+    // Handler addresses, indexed by opcode. These must be in the same order as
+    // the Opcode enum.
+    static const void* const handlers[] = {
+      &&op_BinOp,
+      &&op_Call,
+      &&op_Clear,
+      &&op_ClearList,
+      &&op_Copy,
+      &&op_FulfillSleepingCown,
+      &&op_Freeze,
+      &&op_Int64,
+      &&op_String,
+      &&op_Jump,
+      &&op_JumpIf,
+      &&op_Load,
+      &&op_LoadDescriptor,
+      &&op_Match,
+      &&op_Merge,
+      &&op_Move,
+      &&op_MutView,
+      &&op_NewObject,
+      &&op_NewCown,
+      &&op_NewRegion,
+      &&op_NewSleepingCown,
+      &&op_Print,
+      &&op_Protect,
+      &&op_Return,
+      &&op_Store,
+      &&op_TraceRegion,
+      &&op_Unprotect,
+      &&op_Unreachable,
+      &&op_When,
+      &&op_CallArgs,
+      &&op_ClearReturn,
+      &&op_LoadLoad,
+    };
+    static_assert(
+      std::size(handlers) == static_cast<size_t>(Opcode::maximum_value) + 1);
+
+    const Instruction* instruction;
+
+#  define DISPATCH() \
+    do \
+    { \
+      instruction = frame().ip++; \
+      start_ip_ = instruction->offset; \
+      if constexpr (Profiled) \
+        profile_instruction(*instruction); \
+      goto* handlers[static_cast<size_t>(instruction->opcode)]; \
+    } while (0)
+
+#  define OP(NAME, FN) \
+    op_##NAME: \
+      execute_opcode<Opcode::NAME, &VM::FN, Checked>(*instruction); \
+      DISPATCH();
+
+    // Execution enters a function at the start of the loop, after a call or a
+    // return, and at backward jumps. These are the points where it may switch
+    // to native code.
+#  define TIER_UP() \
+    do \
+    { \
+      if (jit_ != nullptr && run_native()) \
+        return; \
+    } while (0)
+
+#  define CALL_OP(NAME, FN) \
+    op_##NAME: \
+      execute_opcode<Opcode::NAME, &VM::FN, Checked>(*instruction); \
+      TIER_UP(); \
+      DISPATCH();
+
+#  define JUMP_OP(NAME, FN) \
+    op_##NAME: \
+      execute_opcode<Opcode::NAME, &VM::FN, Checked>(*instruction); \
+      if (frame().ip <= instruction) \
+        TIER_UP(); \
+      DISPATCH();
+
+#  define RETURN_OP(NAME, FN) \
+    op_##NAME: \
+      execute_opcode<Opcode::NAME, &VM::FN, Checked>(*instruction); \
+      if (halt_) \
+        return; \
+      TIER_UP(); \
+      DISPATCH();
+
+    TIER_UP();
+    DISPATCH();
+
+    OP(BinOp, opcode_binop);
+    OP(Clear, opcode_clear);
+    OP(ClearList, opcode_clear_list);
+    OP(Copy, opcode_copy);
+    OP(FulfillSleepingCown, opcode_fulfill_sleeping_cown);
+    OP(Freeze, opcode_freeze);
+    OP(Int64, opcode_int64);
+    OP(Load, opcode_load);
+    OP(LoadDescriptor, opcode_load_descriptor);
+    OP(LoadLoad, opcode_load_load<Checked>);
+    OP(Match, opcode_match);
+    OP(Move, opcode_move);
+    OP(MutView, opcode_mut_view);
+    OP(NewObject, opcode_new_object);
+    OP(NewRegion, opcode_new_region);
+    OP(NewSleepingCown, opcode_new_sleeping_cown);
+    OP(NewCown, opcode_new_cown);
+    OP(Print, opcode_print);
+    OP(Protect, opcode_protect);
+    OP(Store, opcode_store);
+    OP(String, opcode_string);
+    OP(TraceRegion, opcode_trace_region);
+    OP(When, opcode_when);
+    OP(Unprotect, opcode_unprotect);
+    OP(Unreachable, opcode_unreachable);
+
+    CALL_OP(Call, opcode_call);
+    CALL_OP(CallArgs, opcode_call_args<Checked>);
+    JUMP_OP(Jump, opcode_jump);
+    JUMP_OP(JumpIf, opcode_jump_if);
+    RETURN_OP(Return, opcode_return);
+    RETURN_OP(ClearReturn, opcode_clear_return);
+
+  op_Merge:
+    // Programs using Merge are rejected when they are loaded.
+    fatal("Invalid opcode {:#x}", static_cast<int>(instruction->opcode));
+
+#  undef OP
+#  undef CALL_OP
+#  undef JUMP_OP
+#  undef RETURN_OP
+#  undef TIER_UP
+#  undef DISPATCH
+#else
+    if (jit_ != nullptr && run_native())
+      return;
+
     while (!halt_)
     {
-      start_ip_ = frame().ip;
-      Opcode op = code_.opcode(frame().ip);
-      dispatch_opcode(op);
+      const Instruction& instruction = *frame().ip++;
+      start_ip_ = instruction.offset;
+      if constexpr (Profiled)
+        profile_instruction(instruction);
+      dispatch_opcode<Checked>(instruction);
+
+      if (jit_ == nullptr || halt_)
+        continue;
+
+      bool entered;
+      switch (instruction.opcode)
+      {
+        case Opcode::Call:
+        case Opcode::CallArgs:
+        case Opcode::Return:
+        case Opcode::ClearReturn:
+          entered = true;
+          break;
+        default:
+          entered = frame().ip <= &instruction;
+          break;
+      }
+
+      if (entered && run_native())
+        return;
+    }
+#endif
+  }
+
+  bool VM::run_native()
+  {
+    while (const NativeCode* native = jit_->enter(frame().function))
+    {
+      native->run(this, frame().ip, registers());
+      if (halt_)
+        return true;
     }
+    return false;
   }
 
   void VM::execute_finaliser(VMObject* object)
@@ -94,7 +338,7 @@ namespace verona::interpreter
     // reasonable state.
     bool old_halt = std::exchange(vm->halt_, false);
     size_t old_start_ip =
-      std::exchange(vm->start_ip_, descriptor->finaliser_ip);
+      std::exchange(vm->start_ip_, descriptor->finaliser->address);
 
     vm->trace("Running the finaliser for: {}", descriptor->name);
 
@@ -109,7 +353,8 @@ namespace verona::interpreter
     else
       base = vm->frame().base + vm->frame().locals;
 
-    vm->push_frame(descriptor->finaliser_ip, base, OnReturn::Halt);
+    vm->push_frame(
+      vm->prepare(descriptor->finaliser), base, OnReturn::Halt);
 
     if (vm->frame().argc != 1)
     {
@@ -127,41 +372,59 @@ namespace verona::interpreter
 
   void VM::grow_stack(size_t size)
   {
-    size = snmalloc::bits::next_pow2(size);
-    if (stack_.size() < size)
-      stack_.resize(size);
+    if (size > MAX_STACK_SIZE)
+      fatal("Stack overflow");
+
+    for (; stack_size_ < size; stack_size_++)
+      new (&stack_[stack_size_]) Value();
   }
 
+  template<bool Checked>
   Value& VM::read(Register reg)
   {
-    if (reg.index >= frame().locals)
+    if constexpr (Checked)
+    {
+      if (reg.index >= frame().locals)
+      {
+        fatal("Out of bounds stack access (register {})", reg.index);
+      }
+      return stack_[frame().base + reg.index];
+    }
+    else
     {
-      fatal("Out of bounds stack access (register {})", reg.index);
+      assert(reg.index < frame().locals);
+      return stack_[frame().base + reg.index];
     }
-    return stack_.at(frame().base + reg.index);
   }
 
+  template<bool Checked>
   const Value& VM::read(Register reg) const
   {
-    if (reg.index >= frame().locals)
+    if constexpr (Checked)
     {
-      fatal("Out of bounds stack access (register {})", reg.index);
+      if (reg.index >= frame().locals)
+      {
+        fatal("Out of bounds stack access (register {})", reg.index);
+      }
+      return stack_[frame().base + reg.index];
+    }
+    else
+    {
+      assert(reg.index < frame().locals);
+      return stack_[frame().base + reg.index];
     }
-    return stack_.at(frame().base + reg.index);
   }
 
+  template<bool Checked>
   void VM::write(Register reg, Value value)
   {
-    if (reg.index >= frame().locals)
-      fatal("Out of bounds stack access (register {})", reg.index);
-
-    stack_.at(frame().base + reg.index).overwrite(alloc_, std::move(value));
+    read<Checked>(reg).overwrite(alloc_, std::move(value));
   }
 
   const VMDescriptor* VM::find_dispatch_descriptor(Register receiver) const
   {
     const Value& value = read(receiver);
-    switch (value.tag)
+    switch (value.tag())
     {
       case Value::MUT:
       case Value::IMM:
@@ -181,19 +444,22 @@ namespace verona::interpreter
 
   void VM::check_type(const Value& value, Value::Tag expected)
   {
-    if (value.tag != expected)
+    if (value.tag() != expected)
       fatal(
-        "Invalid tag {} for value {}, expected {}", value.tag, value, expected);
+        "Invalid tag {} for value {}, expected {}",
+        value.tag(),
+        value,
+        expected);
   }
 
   void VM::check_type(const Value& value, std::vector<Value::Tag> expected)
   {
-    if (
-      std::find(expected.begin(), expected.end(), value.tag) == expected.end())
+    auto it = std::find(expected.begin(), expected.end(), value.tag());
+    if (it == expected.end())
     {
       fatal(
         "Invalid tag {} for value {}, expected one of {}",
-        value.tag,
+        value.tag(),
         value,
         expected);
     }
@@ -243,7 +509,8 @@ namespace verona::interpreter
     }
   }
 
-  void VM::opcode_call(SelectorIdx selector, uint8_t callspace)
+  void
+  VM::opcode_call(SelectorIdx selector, uint8_t callspace, CallCache* cache)
   {
     if (callspace == 0)
       fatal("Not enough call space to find a receiver");
@@ -254,10 +521,26 @@ namespace verona::interpreter
     const VMDescriptor* descriptor =
       find_dispatch_descriptor(Register(frame().locals - callspace));
 
-    size_t addr = descriptor->methods[selector];
+    const Function* function = cache->lookup(descriptor);
+    if (function == nullptr)
+    {
+      // The selector was only verified against the largest vtable, not the
+      // receiver's.
+      if (selector >= descriptor->method_slots)
+        fatal("No method {:#x} in {}", selector, descriptor->name);
+
+      function = descriptor->method_entries[selector];
+      if (function == nullptr)
+        fatal("No method {:#x} in {}", selector, descriptor->name);
+
+      // Only decoded functions are cached, so hits don't need to check.
+      function = prepare(function);
+      cache->insert(descriptor, function);
+    }
+
     size_t base = frame().base + frame().locals - callspace;
 
-    push_frame(addr, base, OnReturn::Continue);
+    push_frame(function, base, OnReturn::Continue);
 
     if (callspace < frame().argc || callspace < frame().retc)
     {
@@ -269,6 +552,29 @@ namespace verona::interpreter
     }
   }
 
+  template<bool Checked>
+  void VM::opcode_call_args(
+    SelectorIdx selector,
+    uint8_t callspace,
+    uint8_t argc,
+    const Register* args,
+    CallCache* cache)
+  {
+    if (callspace > frame().locals)
+      fatal("Call space does not fit in current frame");
+
+    // Copy the arguments, as a sequence of Copy instructions to the call space
+    // would.
+    size_t base = frame().locals - callspace;
+    for (size_t i = 0; i < argc; i++)
+    {
+      Register dst(truncate<uint8_t>(base + i));
+      write<Checked>(dst, read<Checked>(args[i]).maybe_consume());
+    }
+
+    opcode_call(selector, callspace, cache);
+  }
+
   Value VM::opcode_clear()
   {
     return Value();
@@ -282,6 +588,24 @@ namespace verona::interpreter
     }
   }
 
+  void VM::opcode_clear_return(ValueList values)
+  {
+    for (Value& value : values)
+    {
+      value.clear(alloc_);
+    }
+
+    // Codegen clears every register it tracks, so the only other values left
+    // are the DESCRIPTOR and U64 temporaries tolerated by opcode_return. They
+    // are cleared without checking each register's tag first.
+    for (int i = frame().retc; i < frame().locals; i++)
+    {
+      read<false>(Register(i)).clear(alloc_);
+    }
+
+    pop_frame();
+  }
+
   void VM::opcode_fulfill_sleeping_cown(const Value& cown, Value result)
   {
     check_type(cown, Value::COWN);
@@ -311,20 +635,20 @@ namespace verona::interpreter
     return Value::u64(imm);
   }
 
-  Value VM::opcode_string(std::string_view imm)
+  Value VM::opcode_string(const VMString* imm)
   {
     return Value::string(imm);
   }
 
-  void VM::opcode_jump(int16_t offset)
+  void VM::opcode_jump(const Instruction* target)
   {
-    frame().ip = start_ip_ + offset;
+    frame().ip = target;
   }
 
-  void VM::opcode_jump_if(uint64_t condition, int16_t offset)
+  void VM::opcode_jump_if(uint64_t condition, const Instruction* target)
   {
     if (condition > 0)
-      frame().ip = start_ip_ + offset;
+      frame().ip = target;
   }
 
   Value VM::opcode_load(const Value& base, SelectorIdx selector)
@@ -332,23 +656,52 @@ namespace verona::interpreter
     check_type(base, {Value::ISO, Value::MUT, Value::IMM});
 
     VMObject* object = base->object;
-    const VMDescriptor* descriptor = object->descriptor();
-    size_t index = descriptor->fields[selector];
+    size_t index = field_index(object->descriptor(), selector);
 
-    Value value = object->fields[index].read(base.tag);
+    Value value = object->fields()[index].read(base.tag());
     return std::move(value);
   }
 
+  size_t
+  VM::field_index(const VMDescriptor* descriptor, SelectorIdx selector) const
+  {
+    // The selector was only verified against the largest field table, not the
+    // object's.
+    if (selector >= descriptor->field_slots)
+      fatal("No field {:#x} in {}", selector, descriptor->name);
+
+    uint32_t index = descriptor->fields[selector];
+    if (index == VMDescriptor::ABSENT_FIELD)
+      fatal("No field {:#x} in {}", selector, descriptor->name);
+
+    return index;
+  }
+
   Value VM::opcode_load_descriptor(DescriptorIdx desc_idx)
   {
     const VMDescriptor* descriptor = code_.get_descriptor(desc_idx);
     return Value::descriptor(descriptor);
   }
 
+  template<bool Checked>
+  void VM::opcode_load_load(
+    Register dst1,
+    Register base1,
+    SelectorIdx selector1,
+    Register dst2,
+    Register base2,
+    SelectorIdx selector2)
+  {
+    // The second base is only read once the first load is done, since it may
+    // be the first destination.
+    write<Checked>(dst1, opcode_load(read<Checked>(base1), selector1));
+    write<Checked>(dst2, opcode_load(read<Checked>(base2), selector2));
+  }
+
   Value VM::opcode_match(const Value& src, const VMDescriptor* descriptor)
   {
     uint64_t result;
-    switch (src.tag)
+    switch (src.tag())
     {
       case Value::UNINIT:
       case Value::U64:
@@ -373,9 +726,9 @@ namespace verona::interpreter
     return Value::u64(result);
   }
 
-  Value VM::opcode_move(Register src)
+  Value VM::opcode_move(Value& src)
   {
-    return std::move(read(src));
+    return std::move(src);
   }
 
   Value VM::opcode_mut_view(const Value& src)
@@ -442,8 +795,8 @@ namespace verona::interpreter
     // already.
     for (int i = frame().retc; i < frame().locals; i++)
     {
-      Value& value = read(Register(i));
-      switch (value.tag)
+      Value& value = read<false>(Register(i));
+      switch (value.tag())
       {
         case Value::UNINIT:
           break;
@@ -462,13 +815,18 @@ namespace verona::interpreter
       }
     }
 
+    pop_frame();
+  }
+
+  void VM::pop_frame()
+  {
     if (frame().on_return == OnReturn::Halt)
     {
       // We currently never use the return value of the top function, so just
       // clear the return registers.
       for (int i = frame().retc; i < frame().locals; i++)
       {
-        read(Register(i)).clear(alloc_);
+        read<false>(Register(i)).clear(alloc_);
       }
 
       halt_ = true;
@@ -485,21 +843,22 @@ namespace verona::interpreter
     check_type(base, {Value::ISO, Value::MUT});
 
     VMObject* object = base->object;
-    const VMDescriptor* desc = object->descriptor();
-    size_t index = desc->fields[selector];
+    size_t index = field_index(object->descriptor(), selector);
 
-    if (src.tag == Value::Tag::MUT && object->region() != src->object->region())
+    if (
+      src.tag() == Value::Tag::MUT &&
+      object->region() != src->object->region())
     {
       fatal("Writing reference to incorrect region");
     }
 
-    Value old_value =
-      object->fields[index].exchange(alloc_, object->region(), std::move(src));
+    Value old_value = object->fields()[index].exchange(
+      alloc_, object->region(), std::move(src));
     return std::move(old_value);
   }
 
   void VM::opcode_when(
-    CodePtr closure_body, uint8_t cown_count, uint8_t capture_count)
+    const Function* closure, uint8_t cown_count, uint8_t capture_count)
   {
     // One added for unused receiver
     // TODO-Better-Static-codegen
@@ -507,9 +866,7 @@ namespace verona::interpreter
     if (callspace > frame().locals)
       fatal("Call space does not fit in current frame");
 
-    size_t entry_addr = closure_body;
-    size_t addr = entry_addr;
-    FunctionHeader header = code_.function_header(addr);
+    const FunctionHeader& header = closure->header;
 
     if (callspace > header.argc)
     {
@@ -523,14 +880,19 @@ namespace verona::interpreter
     // We use this to copy these values into the message
     size_t base = frame().locals - callspace;
 
-    // Prepare the cowns and the arguments for the method invocation.
-    std::vector<Value> args;
-    std::vector<rt::Cown*> cowns;
-    args.reserve(header.argc);
-    cowns.reserve(cown_count);
+    if (profile_ != nullptr)
+      profile_->when(frame().function, cown_count);
+
+    // Prepare the cowns and the arguments for the method invocation. The
+    // arguments are moved straight into the message, and the cowns are at most
+    // 255, so neither needs a separate allocation.
+    ExecuteMessage* message =
+      ExecuteMessage::make(alloc_, closure, header.argc, cown_count);
+    Value* args = message->args();
+    rt::Cown* cowns[std::numeric_limits<uint8_t>::max() + 1];
 
-    // First argument is a placeholder for the receiver.
-    args.push_back(Value());
+    // First argument is a placeholder for the receiver, and is left as
+    // UNINIT.
 
     // The rest are the cowns
     for (size_t i = 0; i < cown_count; i++)
@@ -545,12 +907,12 @@ namespace verona::interpreter
       //
       // We can't look up the pointer to the cown's contents, since for promise
       // cowns it is not set until the promise is fulfilled.
-      args.push_back(v.as_unowned_cown());
+      args[1 + i].overwrite(alloc_, v.as_unowned_cown());
 
-      // Transfer ownership of the cown from `v` into the `cowns` vector. The
+      // Transfer ownership of the cown from `v` into the `cowns` array. The
       // runtime will hold on to the references until after the message is
       // executed.
-      cowns.push_back(v.consume_cown());
+      cowns[i] = v.consume_cown();
     }
 
     // The rest are the captured values
@@ -558,20 +920,21 @@ namespace verona::interpreter
     {
       Value& v = read(Register(truncate<uint8_t>(base + 1 + cown_count + i)));
       trace("Capturing variable {:d}: {}", i + cown_count, v);
-      args.push_back(std::move(v));
+      args[1 + cown_count + i].overwrite(alloc_, std::move(v));
     }
 
     trace(
       "Dispatching when to function {}, argc={:d}", header.name, header.argc);
 
-    // If no cowns create a fake one to run the code on.
-    if (cowns.size() == 0)
+    // If no cowns create a fake one to run the code on. A cown shared between
+    // `when`s would serialise them, so each gets its own.
+    size_t count = cown_count;
+    if (count == 0)
     {
-      cowns.push_back(new VMCown(nullptr, nullptr));
+      cowns[count++] = new VMCown(nullptr, nullptr);
     }
 
-    rt::Cown::schedule<ExecuteMessage, rt::YesTransfer>(
-      cowns.size(), cowns.data(), entry_addr, std::move(args), cown_count);
+    rt::Cown::schedule_behaviour<rt::YesTransfer>(count, cowns, message);
   }
 
   void VM::opcode_protect(ConstValueList values)
@@ -581,7 +944,7 @@ namespace verona::interpreter
       // Only MUTs need to be protected against GC. ISOs are the entrypoint to
       // the region, hence are always traced. IMM and COWNs hold reference
       // counts to their object. The rest aren't managed by the runtime.
-      if (value.tag == Value::MUT)
+      if (value.tag() == Value::MUT)
       {
         VMObject* object = value->object;
         VMObject* region = object->region();
@@ -597,7 +960,7 @@ namespace verona::interpreter
     for (auto it = values.rbegin(); it != values.rend(); ++it)
     {
       const Value& value = *it;
-      if (value.tag == Value::MUT)
+      if (value.tag() == Value::MUT)
       {
         VMObject* object = value->object;
         VMObject* region = object->region();
@@ -611,19 +974,22 @@ namespace verona::interpreter
     fatal("Reached unreachable opcode");
   }
 
-  void VM::dispatch_opcode(Opcode op)
+  template<bool Checked>
+  void VM::dispatch_opcode(const Instruction& instruction)
   {
-    switch (op)
+    switch (instruction.opcode)
     {
 #define OP(NAME, FN) \
   case Opcode::NAME: \
-    execute_opcode<Opcode::NAME, &VM::FN>(frame().ip); \
+    execute_opcode<Opcode::NAME, &VM::FN, Checked>(instruction); \
     break;
 
       OP(BinOp, opcode_binop);
       OP(Call, opcode_call);
+      OP(CallArgs, opcode_call_args<Checked>);
       OP(Clear, opcode_clear);
       OP(ClearList, opcode_clear_list);
+      OP(ClearReturn, opcode_clear_return);
       OP(Copy, opcode_copy);
       OP(FulfillSleepingCown, opcode_fulfill_sleeping_cown);
       OP(Freeze, opcode_freeze);
@@ -632,6 +998,7 @@ namespace verona::interpreter
       OP(JumpIf, opcode_jump_if);
       OP(Load, opcode_load);
       OP(LoadDescriptor, opcode_load_descriptor);
+      OP(LoadLoad, opcode_load_load<Checked>);
       OP(Match, opcode_match);
       OP(Move, opcode_move);
       OP(MutView, opcode_mut_view);
@@ -652,24 +1019,264 @@ namespace verona::interpreter
 #undef OP
 
       default:
-        fatal("Invalid opcode {:#x}", static_cast<int>(op));
+        fatal("Invalid opcode {:#x}", static_cast<int>(instruction.opcode));
     }
   }
 
-  template<Opcode opcode, auto Fn>
-  void VM::execute_opcode(size_t& ip)
+  template<Opcode opcode, auto Fn, bool Checked>
+  void VM::execute_opcode(const Instruction& instruction)
   {
     static_assert(std::is_member_function_pointer_v<decltype(Fn)>);
 
-    auto operands = code_.load_operands<opcode>(ip);
+    if (verbose_)
+      trace_instruction<opcode>(instruction);
 
     // The std::apply with a lambda trick turns the operands tuple into a
     // parameter pack, so it can more easily be used.
     std::apply(
       [&](const auto&... args) {
-        this->trace(bytecode::OpcodeSpec<opcode>::format, args...);
-        execute_handler<decltype(Fn)>::template execute<Fn>(this, args...);
+        execute_handler<decltype(Fn)>::template execute<Fn, Checked>(
+          this, args...);
       },
-      operands);
+      instruction.operands<opcode>());
+  }
+
+  template<Opcode opcode>
+  void VM::trace_instruction(const Instruction& instruction) const
+  {
+    using Spec = bytecode::OpcodeSpec<opcode>;
+
+    // The trailing Unreachable of a function does not exist in the bytecode,
+    // so operand-less instructions are not read back.
+    if constexpr (std::is_same_v<typename Spec::Operands, OpcodeOperands<>>)
+    {
+      trace(Spec::format);
+    }
+    else
+    {
+      size_t ip = instruction.offset;
+      code_.opcode(ip);
+      std::apply(
+        [&](const auto&... args) { trace(Spec::format, args...); },
+        code_.load_operands<opcode>(ip));
+    }
+  }
+
+  template<Opcode opcode, auto Fn, bool Checked, bool Profiled>
+  void VM::native_step(VM* vm, const Instruction* instruction)
+  {
+    vm->start_ip_ = instruction->offset;
+    if constexpr (Profiled)
+      vm->profile_opcode(opcode);
+
+    // Native code doesn't keep the frame's ip up to date. A call must leave it
+    // on the following instruction, for the callee to return to.
+    if constexpr (opcode == Opcode::Call || opcode == Opcode::CallArgs)
+      vm->frame().ip = instruction + 1;
+
+    vm->execute_opcode<opcode, Fn, Checked>(*instruction);
+  }
+
+  template<bool Checked, bool Profiled>
+  bool VM::native_branch(VM* vm, const Instruction* instruction)
+  {
+    vm->start_ip_ = instruction->offset;
+    if constexpr (Profiled)
+      vm->profile_opcode(Opcode::JumpIf);
+    vm->frame().ip = instruction + 1;
+    vm->execute_opcode<Opcode::JumpIf, &VM::opcode_jump_if, Checked>(
+      *instruction);
+    return vm->frame().ip != instruction + 1;
+  }
+
+  void VM::native_fill_cache(
+    VM* vm, const Instruction* instruction, FieldCache* cache)
+  {
+    // Native code only executes instructions inline if their registers are in
+    // the frame.
+    bool load = instruction->opcode == Opcode::Load;
+    Register base = load ? std::get<1>(instruction->operands<Opcode::Load>()) :
+                           std::get<1>(instruction->operands<Opcode::Store>());
+    SelectorIdx selector = load ?
+      std::get<2>(instruction->operands<Opcode::Load>()) :
+      std::get<2>(instruction->operands<Opcode::Store>());
+
+    const Value& value = vm->read<false>(base);
+    Value::Tag tag = value.tag();
+    if (tag != Value::ISO && tag != Value::MUT && !(load && tag == Value::IMM))
+      return;
+
+    VMObject* object = value->object;
+    // If the object has no such field, the step reports it.
+    const VMDescriptor* descriptor = object->descriptor();
+    if (
+      selector >= descriptor->field_slots ||
+      descriptor->fields[selector] == VMDescriptor::ABSENT_FIELD)
+      return;
+
+    if (cache->claimed.exchange(true, std::memory_order_relaxed))
+      return;
+
+    size_t index = descriptor->fields[selector];
+    uintptr_t offset = reinterpret_cast<uintptr_t>(&object->fields()[index]) -
+      reinterpret_cast<uintptr_t>(object);
+    cache->offset.store(offset, std::memory_order_relaxed);
+    const rt::Descriptor* key = descriptor;
+    cache->descriptor.store(key, std::memory_order_release);
+  }
+
+  const Jit::Handlers& VM::native_handlers(bool checked, bool profiled)
+  {
+    if (profiled)
+    {
+      if (checked)
+        return native_handlers<true, true>();
+      else
+        return native_handlers<false, true>();
+    }
+    else
+    {
+      if (checked)
+        return native_handlers<true, false>();
+      else
+        return native_handlers<false, false>();
+    }
+  }
+
+  template<bool Checked, bool Profiled>
+  const Jit::Handlers& VM::native_handlers()
+  {
+    static const Jit::Handlers handlers = [] {
+      Jit::Handlers result = {};
+
+#define OP(NAME, FN) \
+  result.steps[static_cast<size_t>(Opcode::NAME)] = \
+    &VM::native_step<Opcode::NAME, &VM::FN, Checked, Profiled>;
+
+      // Jumps are compiled to native jumps, and JumpIf uses the branch
+      // handler. Merge is never executed.
+      OP(BinOp, opcode_binop);
+      OP(Call, opcode_call);
+      OP(CallArgs, opcode_call_args<Checked>);
+      OP(Clear, opcode_clear);
+      OP(ClearList, opcode_clear_list);
+      OP(ClearReturn, opcode_clear_return);
+      OP(Copy, opcode_copy);
+      OP(FulfillSleepingCown, opcode_fulfill_sleeping_cown);
+      OP(Freeze, opcode_freeze);
+      OP(Int64, opcode_int64);
+      OP(Load, opcode_load);
+      OP(LoadDescriptor, opcode_load_descriptor);
+      OP(LoadLoad, opcode_load_load<Checked>);
+      OP(Match, opcode_match);
+      OP(Move, opcode_move);
+      OP(MutView, opcode_mut_view);
+      OP(NewObject, opcode_new_object);
+      OP(NewRegion, opcode_new_region);
+      OP(NewSleepingCown, opcode_new_sleeping_cown);
+      OP(NewCown, opcode_new_cown);
+      OP(Print, opcode_print);
+      OP(Protect, opcode_protect);
+      OP(Return, opcode_return);
+      OP(Store, opcode_store);
+      OP(String, opcode_string);
+      OP(TraceRegion, opcode_trace_region);
+      OP(When, opcode_when);
+      OP(Unprotect, opcode_unprotect);
+      OP(Unreachable, opcode_unreachable);
+
+#undef OP
+
+      result.branch = &VM::native_branch<Checked, Profiled>;
+      result.fill_cache = &VM::native_fill_cache;
+
+      auto kinds = [](std::initializer_list<Value::Tag> tags) {
+        uint32_t set = 0;
+        for (Value::Tag tag : tags)
+          set |= uint32_t(1) << static_cast<uint32_t>(tag);
+        return set;
+      };
+
+      Jit::Layout& layout = result.layout;
+      layout.kind_bits = Value::ENCODING_KIND_BITS;
+      layout.u64_kind = Value::ENCODING_U64_KIND;
+      layout.unowned_kinds = Value::UNOWNED_KINDS;
+      layout.plain_kinds = Value::PLAIN_KINDS;
+      layout.copyable_kinds = Value::PLAIN_KINDS | kinds({Value::MUT});
+      layout.loadable_kinds = kinds({Value::ISO, Value::MUT, Value::IMM});
+      layout.storable_kinds = kinds({Value::ISO, Value::MUT});
+      layout.descriptor_offset =
+        static_cast<int32_t>(offsetof(rt::Object::Header, descriptor)) -
+        static_cast<int32_t>(sizeof(rt::Object::Header));
+      layout.descriptor_mask = ~rt::Object::MARK_MASK;
+
+      // Profiles count every instruction, which inline ones would skip.
+      result.inline_instructions = !Profiled;
+      return result;
+    }();
+
+    return handlers;
+  }
+
+  ExecuteMessage::ExecuteMessage(
+    const Function* start, size_t argc, size_t cown_count)
+  : rt::Behaviour(desc(argc)),
+    start(start),
+    argc(argc),
+    cown_count(cown_count)
+  {
+    for (size_t i = 0; i < argc; i++)
+    {
+      new (&args()[i]) Value();
+    }
+  }
+
+  ExecuteMessage* ExecuteMessage::make(
+    rt::Alloc* alloc, const Function* start, size_t argc, size_t cown_count)
+  {
+    void* memory = alloc->alloc(desc(argc)->size);
+    return new (memory) ExecuteMessage(start, argc, cown_count);
+  }
+
+  const rt::Behaviour::Descriptor* ExecuteMessage::desc(size_t argc)
+  {
+    static constexpr size_t MAX_ARGC = std::numeric_limits<uint8_t>::max();
+    static const auto descriptors = [] {
+      std::array<Descriptor, MAX_ARGC + 1> result;
+      for (size_t i = 0; i <= MAX_ARGC; i++)
+      {
+        result[i] = {
+          sizeof(ExecuteMessage) + i * sizeof(Value),
+          run_fn,
+          trace_fn,
+          destructor_fn};
+      }
+      return result;
+    }();
+
+    assert(argc <= MAX_ARGC);
+    return &descriptors[argc];
+  }
+
+  void ExecuteMessage::run_fn(rt::Behaviour* behaviour)
+  {
+    // Main runtime entry for a closure. Running the closure moves every
+    // argument out of the message, so there is nothing left to destroy.
+    auto* message = static_cast<ExecuteMessage*>(behaviour);
+    VM::local_vm->run(
+      message->args(), message->argc, message->cown_count, message->start);
+  }
+
+  void ExecuteMessage::trace_fn(const rt::Behaviour*, rt::ObjectStack&) {}
+
+  void ExecuteMessage::destructor_fn(rt::Behaviour* behaviour)
+  {
+    // The behaviour was dropped without running.
+    auto* message = static_cast<ExecuteMessage*>(behaviour);
+    rt::Alloc* alloc = rt::ThreadAlloc::get();
+    for (size_t i = 0; i < message->argc; i++)
+    {
+      message->args()[i].clear(alloc);
+    }
   }
 }
@@ -3,9 +3,13 @@
 #pragma once
 
 #include "interpreter/code.h"
+#include "interpreter/jit.h"
+#include "interpreter/profile.h"
 
+#include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/ostream.h>
+#include <new>
 
 namespace verona::interpreter
 {
@@ -20,9 +24,34 @@ namespace verona::interpreter
   class VM
   {
   public:
-    VM(const Code& code, bool verbose)
-    : code_(code), verbose_(verbose), alloc_(rt::ThreadAlloc::get())
-    {}
+    VM(
+      const Code& code,
+      bool verbose,
+      bool checked,
+      Jit* jit,
+      BigramProfile* bigrams,
+      Profile* profile)
+    : code_(code),
+      verbose_(verbose),
+      checked_(checked),
+      jit_(jit),
+      shared_bigrams_(bigrams),
+      shared_profile_(profile),
+      alloc_(rt::ThreadAlloc::get()),
+      stack_(static_cast<Value*>(std::calloc(MAX_STACK_SIZE, sizeof(Value))))
+    {
+      if (stack_ == nullptr)
+        throw std::bad_alloc();
+      if (bigrams != nullptr)
+        bigrams_ = std::make_unique<BigramProfile>();
+      if (profile != nullptr)
+        profile_ = std::make_unique<Profile>();
+    }
+
+    /**
+     * Adds the VM's profiles, if any, to the shared ones.
+     */
+    ~VM();
 
     static inline thread_local VM* local_vm = nullptr;
 
@@ -31,20 +60,48 @@ namespace verona::interpreter
       delete local_vm;
     }
 
-    static void init_vm(const Code* code, bool verbose)
+    /**
+     * Create the VM of the current thread.
+     *
+     * Unless `checked` is set, the program must have been verified, and
+     * register accesses are not bounds checked.
+     *
+     * If `jit` is not null, hot functions are compiled by it and run natively.
+     * It must have been created with the `native_handlers` of the same
+     * `checked` mode, profiled if `profile` is not null.
+     *
+     * If `bigrams` is not null, the VM counts the pairs of instructions it
+     * executes, and adds them to it when the thread exits. Likewise for the
+     * execution `profile`.
+     */
+    static void init_vm(
+      const Code* code,
+      bool verbose,
+      bool checked,
+      Jit* jit,
+      BigramProfile* bigrams,
+      Profile* profile)
     {
       static thread_local snmalloc::OnDestruct<dealloc_vm> foo;
-      local_vm = new VM(*code, verbose);
+      local_vm = new VM(*code, verbose, checked, jit, bigrams, profile);
     }
 
     /**
-     * Run the VM from the given address.
+     * The handlers called by native code to execute instructions, in checked
+     * or unchecked mode. Profiled handlers count the instructions in the VM's
+     * execution profile.
+     */
+    static const Jit::Handlers& native_handlers(bool checked, bool profiled);
+
+    /**
+     * Run the VM from the start of the given function.
      *
      * Puts args on the stack.
      *
      * Keeps fetching and executing instructions until the VM halts.
      */
-    void run(std::vector<Value> args, size_t cown_count, size_t start);
+    void
+    run(Value* args, size_t argc, size_t cown_count, const Function* start);
 
     /**
      * Run finaliser for this VM object.
@@ -60,19 +117,36 @@ namespace verona::interpreter
   private:
     Value
     opcode_binop(bytecode::BinaryOperator op, uint64_t left, uint64_t right);
-    void opcode_call(SelectorIdx selector, uint8_t callspace);
+    void opcode_call(
+      SelectorIdx selector, uint8_t callspace, CallCache* cache);
+    template<bool Checked>
+    void opcode_call_args(
+      SelectorIdx selector,
+      uint8_t callspace,
+      uint8_t argc,
+      const Register* args,
+      CallCache* cache);
     Value opcode_clear();
     void opcode_clear_list(ValueList values);
+    void opcode_clear_return(ValueList values);
     Value opcode_copy(Value src);
     void opcode_fulfill_sleeping_cown(const Value& cown, Value result);
     Value opcode_freeze(Value src);
     Value opcode_int64(uint64_t imm);
-    void opcode_jump(int16_t offset);
-    void opcode_jump_if(uint64_t condition, int16_t offset);
+    void opcode_jump(const Instruction* target);
+    void opcode_jump_if(uint64_t condition, const Instruction* target);
     Value opcode_load(const Value& base, SelectorIdx selector);
     Value opcode_load_descriptor(DescriptorIdx desc_idx);
+    template<bool Checked>
+    void opcode_load_load(
+      Register dst1,
+      Register base1,
+      SelectorIdx selector1,
+      Register dst2,
+      Register base2,
+      SelectorIdx selector2);
     Value opcode_match(const Value& src, const VMDescriptor* descriptor);
-    Value opcode_move(Register src);
+    Value opcode_move(Value& src);
     Value opcode_mut_view(const Value& src);
     Value
     opcode_new_object(const Value& parent, const VMDescriptor* descriptor);
@@ -84,10 +158,10 @@ namespace verona::interpreter
     void opcode_unprotect(ConstValueList values);
     void opcode_return();
     Value opcode_store(const Value& base, SelectorIdx selector, Value src);
-    Value opcode_string(std::string_view imm);
+    Value opcode_string(const VMString* imm);
     void opcode_trace_region(const Value& region);
-    void
-    opcode_when(CodePtr selector, uint8_t cown_count, uint8_t capture_count);
+    void opcode_when(
+      const Function* closure, uint8_t cown_count, uint8_t capture_count);
     void opcode_unreachable();
 
     enum class OnReturn
@@ -96,54 +170,145 @@ namespace verona::interpreter
       Continue,
     };
 
+    /**
+     * Get a function ready to be pushed, decoding and verifying it the first
+     * time, as `Code::prepare`. Aborts the VM if the function is invalid.
+     */
+    const Function* prepare(const Function* function);
+
     /**
      * Setup a new frame for execution.
      *
      * The frame is added to the control flow stack, and the register stack is
      * grown to be big enough to execute this frame.
      */
-    void push_frame(size_t ip, size_t base, OnReturn on_return);
+    void push_frame(const Function* function, size_t base, OnReturn on_return);
+
+    /**
+     * Pop the current frame, once its registers have been cleared. Halts the
+     * VM if the frame was marked as such.
+     */
+    void pop_frame();
 
     /**
      * Switches on the opcode value and invokes the appropriate handler.
      */
-    void dispatch_opcode(Opcode op);
+    template<bool Checked>
+    void dispatch_opcode(const Instruction& instruction);
 
     /**
      * Executes the VMs IP until the it returns from outer most stack frame.
+     *
+     * With GCC and Clang, this jumps directly from one handler to the next
+     * using computed gotos, rather than going through a switch.
+     *
+     * Dispatches to the checked or unchecked instantiation of the loop, with
+     * or without profiling.
      **/
     void dispatch_loop();
 
+    template<bool Checked, bool Profiled>
+    void dispatch_loop();
+
+    /**
+     * Count an instruction about to be executed in the VM's profiles.
+     */
+    void profile_instruction(const Instruction& instruction);
+
+    /**
+     * Count an instruction about to be executed in the execution profile,
+     * which must be enabled. Native code only updates this profile, as pairs
+     * of instructions can't be counted without seeing its jumps.
+     */
+    void profile_opcode(Opcode opcode);
+
     /**
-     * Wrapper around opcode handlers. Takes care of parsing and tracing the
-     * operands.
+     * Wrapper around opcode handlers. Takes care of tracing the instruction
+     * and converting its decoded operands.
      *
      * Fn is the actual handler implementation, which will be called with the
      * operands as arguments. It should be a member function pointer of the VM
      * class.
      */
-    template<Opcode opcode, auto Fn>
-    void execute_opcode(size_t& ip);
+    template<Opcode opcode, auto Fn, bool Checked>
+    void execute_opcode(const Instruction& instruction);
+
+    /**
+     * Run the current frame's function natively, as long as it has native
+     * code, and again for each function native code leaves the VM in. Counts
+     * an entry into each of these functions.
+     *
+     * Returns whether the VM halted.
+     */
+    bool run_native();
+
+    /**
+     * Executes an instruction on behalf of native code. See `Jit::Step`.
+     */
+    template<Opcode opcode, auto Fn, bool Checked, bool Profiled>
+    static void native_step(VM* vm, const Instruction* instruction);
+
+    /**
+     * Executes a JumpIf on behalf of native code. See `Jit::Branch`.
+     */
+    template<bool Checked, bool Profiled>
+    static bool native_branch(VM* vm, const Instruction* instruction);
+
+    /**
+     * Fills the cache of a Load or Store executed inline by native code. See
+     * `Jit::FillCache`.
+     */
+    static void native_fill_cache(
+      VM* vm, const Instruction* instruction, FieldCache* cache);
+
+    template<bool Checked, bool Profiled>
+    static const Jit::Handlers& native_handlers();
+
+    /**
+     * Trace an instruction, using the operands as they appear in the bytecode.
+     */
+    template<Opcode opcode>
+    void trace_instruction(const Instruction& instruction) const;
 
     void grow_stack(size_t size);
 
+    /**
+     * Registers of the current frame.
+     */
+    Value* registers()
+    {
+      return &stack_[frame().base];
+    }
+
     /**
      * Read the value of a register, relative to the current frame.
      *
-     * Aborts the VM if the register is out of bounds.
+     * If Checked, aborts the VM if the register is out of bounds. Otherwise the
+     * register must be known to be in bounds, for instance because the program
+     * has been verified.
      */
+    template<bool Checked = true>
     Value& read(Register reg);
+    template<bool Checked = true>
     const Value& read(Register reg) const;
 
     /**
      * Write a value to a register, relative to the current frame.
      *
-     * Aborts the VM if the register is out of bounds.
+     * If Checked, aborts the VM if the register is out of bounds.
      */
+    template<bool Checked = true>
     void write(Register reg, Value value);
 
     const VMDescriptor* find_dispatch_descriptor(Register receiver) const;
 
+    /**
+     * Index in objects of `descriptor` of the field `selector`. Aborts the VM
+     * if they have no such field.
+     */
+    size_t
+    field_index(const VMDescriptor* descriptor, SelectorIdx selector) const;
+
     template<typename... Args>
     void trace(std::string_view fmt, Args&&... args) const
     {
@@ -174,12 +339,34 @@ namespace verona::interpreter
     const bool verbose_;
 
     /**
-     * Address of the currently executing instruction.
-     *
-     * After an instruction is parsed, frame().ip points to the start of the
-     * next instruction. start_ip_ is used for tracing, and to resolve relative
-     * offsets.
+     * Whether every register access is bounds checked. If not, the program
+     * must have been verified before being run.
+     */
+    const bool checked_;
+
+    /**
+     * Compiler of hot functions, or null if every function is interpreted.
+     */
+    Jit* const jit_;
+
+    /**
+     * Pairs of instructions executed by this VM, and the profile they are
+     * added to when it is destroyed. Both are null unless profiling.
+     */
+    std::unique_ptr<BigramProfile> bigrams_;
+    BigramProfile* const shared_bigrams_;
+
+    /**
+     * Execution profile of this VM, and the profile it is added to when it is
+     * destroyed. Both are null unless profiling.
+     */
+    std::unique_ptr<Profile> profile_;
+    Profile* const shared_profile_;
+
+    /**
+     * Bytecode offset of the currently executing instruction.
      *
+     * It is only used for tracing and error messages.
      */
     size_t start_ip_;
 
@@ -198,23 +385,33 @@ namespace verona::interpreter
      * within this view.
      *
      * Because of finalisers, the VM needs to support re-entrant invocations,
-     * which may cause the stack to grow at unexpected times. We use a deque
-     * rather than a vector to make sure references don't get invalidated when
-     * this happens.
+     * which may cause the stack to grow at unexpected times. The stack is
+     * allocated at its maximum size up front and never moves, so references
+     * don't get invalidated when this happens, and native code can address
+     * the registers of a frame from its base.
+     *
+     * Only the first `stack_size_` Values have been constructed. The memory is
+     * zeroed, and is usually only committed once used.
      */
-    std::deque<Value> stack_;
+    Value* stack_;
+    size_t stack_size_ = 0;
+
+    static constexpr size_t MAX_STACK_SIZE = size_t(1) << 20;
 
     struct Frame
     {
       /**
-       * Bytecode offset at which instruction data is fetched.
+       * Function executing in this frame.
+       */
+      const Function* function;
+
+      /**
+       * Next instruction to execute.
        *
-       * This value changes as operands get parsed from the bytecode. This means
-       * during execution of an opcode, it actually points to the next
-       * instruction. start_ip_ should be used to get the offset of the
-       * currently executing instruction.
+       * This is advanced before an instruction is executed, so during execution
+       * of an opcode it points to the following instruction.
        */
-      size_t ip;
+      const Instruction* ip;
 
       /**
        * Base offset into the value stack.
@@ -273,22 +470,39 @@ namespace verona::interpreter
 
   /**
    * This represent the closure for all when clauses in the runtime
+   *
+   * The arguments of the closure are stored inline, after the message, so a
+   * `when` needs no allocation besides the message itself. The size of the
+   * message therefore depends on the closure's argument count, and there is a
+   * behaviour descriptor for every possible count.
    */
-  class ExecuteMessage : public rt::VBehaviour<ExecuteMessage>
+  class ExecuteMessage : public rt::Behaviour
   {
-    size_t start;
-    std::vector<Value> args;
+    const Function* start;
+    size_t argc;
     size_t cown_count;
 
+    ExecuteMessage(const Function* start, size_t argc, size_t cown_count);
+
+    static const Descriptor* desc(size_t argc);
+    static void run_fn(rt::Behaviour* behaviour);
+    static void trace_fn(const rt::Behaviour* behaviour, rt::ObjectStack& st);
+    static void destructor_fn(rt::Behaviour* behaviour);
+
   public:
-    ExecuteMessage(size_t start, std::vector<Value> args, size_t cown_count)
-    : start(start), args(std::move(args)), cown_count(cown_count)
-    {}
+    /**
+     * Allocate a message running `start` with `argc` arguments, the first
+     * `cown_count` of which (after the receiver) are cowns being acquired.
+     *
+     * The arguments are initially UNINIT, and must be set through `args()`
+     * before the message is scheduled.
+     */
+    static ExecuteMessage* make(
+      rt::Alloc* alloc, const Function* start, size_t argc, size_t cown_count);
 
-    // Main runtime entry for a closure.
-    void f()
+    Value* args()
     {
-      VM::local_vm->run(std::move(args), cown_count, start);
+      return reinterpret_cast<Value*>(this + 1);
     }
   };
 }
@@ -6,6 +6,8 @@
 #include "../sched/cown.h"
 #include "type_traits"
 
+#include <tuple>
+
 namespace verona::rt
 {
   using namespace snmalloc;
@@ -44,9 +46,18 @@ namespace verona::rt
       }
     }
 
+    static void gc_destructor(Behaviour* msg)
+    {
+      static_cast<T*>(msg)->~T();
+    }
+
     static const Behaviour::Descriptor* desc()
     {
-      static constexpr Behaviour::Descriptor desc = {sizeof(T), f, gc_trace};
+      static constexpr Behaviour::Descriptor desc = {
+        sizeof(T),
+        f,
+        gc_trace,
+        std::is_trivially_destructible_v<T> ? nullptr : gc_destructor};
 
       return &desc;
     }
@@ -79,4 +90,67 @@ namespace verona::rt
     void operator delete[](void* p) = delete;
     void operator delete[](void* p, size_t sz) = delete;
   };
+
+  /**
+   * A behaviour that calls a lambda with a fixed set of captures, as
+   * scheduled by `Cown::schedule(cown, f, captures...)`.
+   *
+   * The captures are stored by value next to the lambda. Those that are
+   * pointers to Verona objects are pushed when the behaviour is traced.
+   **/
+  template<class F, class... Captures>
+  class LambdaBehaviour
+  : public VBehaviour<LambdaBehaviour<F, Captures...>>
+  {
+    F fn;
+    std::tuple<Captures...> captures;
+
+    template<class C>
+    static void trace_capture(ObjectStack& st, const C& c)
+    {
+      if constexpr (std::is_convertible_v<C, const Object*>)
+      {
+        if (c != nullptr)
+          st.push(const_cast<Object*>(static_cast<const Object*>(c)));
+      }
+      else
+      {
+        UNUSED(st);
+        UNUSED(c);
+      }
+    }
+
+  public:
+    template<class G, class... Cs>
+    LambdaBehaviour(G&& fn, Cs&&... captures)
+    : fn(std::forward<G>(fn)), captures(std::forward<Cs>(captures)...)
+    {}
+
+    void f()
+    {
+      std::apply(fn, captures);
+    }
+
+    void trace(ObjectStack& st) const
+    {
+      std::apply(
+        [&st](const auto&... c) { (trace_capture(st, c), ...); }, captures);
+    }
+  };
+
+  template<TransferOwnership transfer, typename F, typename... Captures>
+  void Cown::schedule(Cown* cown, F&& f, Captures&&... captures)
+  {
+    schedule<transfer>(
+      1, &cown, std::forward<F>(f), std::forward<Captures>(captures)...);
+  }
+
+  template<TransferOwnership transfer, typename F, typename... Captures>
+  void
+  Cown::schedule(size_t count, Cown** cowns, F&& f, Captures&&... captures)
+  {
+    using Be = LambdaBehaviour<std::decay_t<F>, std::decay_t<Captures>...>;
+    schedule<Be, transfer>(
+      count, cowns, std::forward<F>(f), std::forward<Captures>(captures)...);
+  }
 } // namespace verona::rt
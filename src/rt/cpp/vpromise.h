@@ -0,0 +1,340 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "vbehaviour.h"
+#include "vobject.h"
+
+#include <optional>
+
+namespace verona::rt
+{
+  using namespace snmalloc;
+
+  /**
+   * The untyped part of a promise: the continuations waiting for it.
+   *
+   * A promise is a cown that never receives messages. Instead, behaviours are
+   * registered on it as continuations, together with the cowns they will run
+   * on. Fulfilling the promise sends each continuation directly to its cowns,
+   * so a request-response interaction costs no more than the `when` for the
+   * response.
+   *
+   * A continuation may wait on several promises (see `when_all`). It is sent
+   * once the last of them is fulfilled. If any of them is collected before
+   * being fulfilled, the continuation can never run. It is dropped instead:
+   * its destructor is run and its references to its cowns are released.
+   *
+   * While a continuation is pending, the promises it waits on report its
+   * cowns and behaviour state to the leak detector.
+   */
+  class PromiseBase : public Cown
+  {
+    struct Join;
+
+    /// Entry in the list of continuations waiting on one promise.
+    struct Link
+    {
+      Link* next;
+      Join* join;
+    };
+
+    /**
+     * A continuation waiting on `promise_count` promises. It is allocated
+     * together with one `Link` per promise.
+     */
+    struct Join
+    {
+      std::atomic<size_t> waiting;
+      std::atomic<bool> cancelled;
+      size_t promise_count;
+      size_t count;
+      Cown** cowns;
+      Behaviour* behaviour;
+
+      Link* links()
+      {
+        return (Link*)(this + 1);
+      }
+
+      static size_t size(size_t promise_count)
+      {
+        return sizeof(Join) + (promise_count * sizeof(Link));
+      }
+    };
+
+    enum class State
+    {
+      Pending,
+      Fulfilled,
+      Cancelled
+    };
+
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    State state = State::Pending;
+    Link* waiters = nullptr;
+
+    /**
+     * Record that one of the promises `join` waits on has been fulfilled, or
+     * cancelled. The last arrival sends the continuation, or releases it if any
+     * promise was cancelled.
+     */
+    static void arrive(Alloc* alloc, Join* join, bool cancel)
+    {
+      if (cancel)
+        join->cancelled.store(true, std::memory_order_relaxed);
+
+      if (join->waiting.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+      if (join->cancelled.load(std::memory_order_relaxed))
+      {
+        VERONA_LOG() << "Promise continuation cancelled: " << join->behaviour
+                     << std::endl;
+        release_unsent(alloc, join->count, join->cowns, join->behaviour);
+      }
+      else
+      {
+        // The promise no longer refers to the continuation, and it was not
+        // sent by a behaviour, so it may have been missed by the leak detector.
+        scan_unsent(alloc, join->count, join->cowns, join->behaviour);
+        schedule_sorted(alloc, join->count, join->cowns, join->behaviour);
+      }
+
+      alloc->dealloc(join, Join::size(join->promise_count));
+    }
+
+    void add_waiter(Alloc* alloc, Link* link)
+    {
+      State s;
+      {
+        FlagLock f(lock);
+        s = state;
+        if (s == State::Pending)
+        {
+          link->next = waiters;
+          waiters = link;
+          return;
+        }
+      }
+
+      arrive(alloc, link->join, s == State::Cancelled);
+    }
+
+    void complete(State s)
+    {
+      Link* list;
+      {
+        FlagLock f(lock);
+        if (state != State::Pending)
+        {
+          // Collecting a fulfilled promise has nothing to cancel.
+          assert(s == State::Cancelled);
+          return;
+        }
+        state = s;
+        list = waiters;
+        waiters = nullptr;
+      }
+
+      auto* alloc = ThreadAlloc::get();
+      while (list != nullptr)
+      {
+        // The join may be deallocated by the arrival.
+        auto* next = list->next;
+        arrive(alloc, list->join, s == State::Cancelled);
+        list = next;
+      }
+    }
+
+  protected:
+    PromiseBase() : Cown() {}
+
+    /**
+     * Mark the promise as fulfilled and send every continuation that is not
+     * waiting on any other promise. The value must have been stored first.
+     */
+    void fulfilled()
+    {
+      VERONA_LOG() << "Promise " << this << " fulfilled" << std::endl;
+      complete(State::Fulfilled);
+    }
+
+    /**
+     * Drop the pending continuations. Called when the promise is collected
+     * without having been fulfilled.
+     */
+    void cancel()
+    {
+      complete(State::Cancelled);
+    }
+
+    /**
+     * Trace the pending continuations, or, once fulfilled, the value by calling
+     * `trace_value`.
+     */
+    template<typename F>
+    void trace_promise(ObjectStack& st, F trace_value)
+    {
+      FlagLock f(lock);
+      if (state == State::Fulfilled)
+      {
+        trace_value(st);
+        return;
+      }
+
+      for (auto* l = waiters; l != nullptr; l = l->next)
+      {
+        auto* join = l->join;
+        st.push_many(join->cowns, join->count);
+        join->behaviour->trace(st);
+      }
+    }
+
+  public:
+    bool is_fulfilled()
+    {
+      FlagLock f(lock);
+      return state == State::Fulfilled;
+    }
+
+    /**
+     * Run a behaviour of type `Be` on `cowns` once every promise in `promises`
+     * has been fulfilled. No intermediate cown is involved: the behaviour is
+     * sent by whichever thread fulfils the last promise, or immediately if they
+     * are all fulfilled already.
+     *
+     * The behaviour must hold its own references to any promise whose value it
+     * reads. At least one cown must be given.
+     *
+     * Pass `transfer = YesTransfer` as a template argument if the caller is
+     * transfering ownership of a reference count on each cown to this method.
+     */
+    template<
+      class Be,
+      TransferOwnership transfer = NoTransfer,
+      typename... Args>
+    static void when_all(
+      size_t promise_count,
+      PromiseBase** promises,
+      size_t count,
+      Cown** cowns,
+      Args&&... args)
+    {
+      static_assert(std::is_base_of_v<Behaviour, Be>);
+      assert(count > 0);
+
+      auto* alloc = ThreadAlloc::get();
+      auto* be =
+        new ((Be*)alloc->alloc<sizeof(Be)>()) Be(std::forward<Args>(args)...);
+      auto** sort = sort_cowns<transfer>(alloc, count, cowns);
+
+      // Hold an extra arrival until every link is registered, so that the
+      // join cannot be sent and deallocated while still being registered.
+      auto* join = new (alloc->alloc(Join::size(promise_count)))
+        Join{{promise_count + 1}, {false}, promise_count, count, sort, be};
+
+      for (size_t i = 0; i < promise_count; i++)
+      {
+        auto* link = &join->links()[i];
+        link->join = join;
+        promises[i]->add_waiter(alloc, link);
+      }
+
+      arrive(alloc, join, false);
+    }
+  };
+
+  /**
+   * A promise of a value of type `T`.
+   *
+   * The value is written once, by `fulfill`, and can be read by continuations
+   * with `get`. If `T` is a pointer to an `Object` (a region entry point, an
+   * immutable or a cown), the promise takes ownership of the reference passed
+   * to `fulfill`, reports it to the leak detector, and releases it when the
+   * promise is collected. Any other `T` must not refer to Verona objects.
+   *
+   * Promises are reference counted like any other cown.
+   */
+  template<typename T>
+  class Promise : public VBase<Promise<T>, PromiseBase>
+  {
+    using Base = VBase<Promise<T>, PromiseBase>;
+
+    std::optional<T> value;
+
+  public:
+    Promise() : Base() {}
+
+    void* operator new(size_t)
+    {
+      return Object::register_object(
+        ThreadAlloc::get()->alloc<vsizeof<Promise>>(), Base::desc());
+    }
+
+    void* operator new(size_t, Alloc* alloc)
+    {
+      return Object::register_object(
+        alloc->alloc<vsizeof<Promise>>(), Base::desc());
+    }
+
+    /// Set the value and send the continuations that are now ready.
+    void fulfill(T v)
+    {
+      assert(!value.has_value());
+      value.emplace(std::move(v));
+      PromiseBase::fulfilled();
+    }
+
+    /// Read the value. Only valid once the promise has been fulfilled.
+    T& get()
+    {
+      assert(value.has_value());
+      return *value;
+    }
+
+    /**
+     * Run a behaviour of type `Be` on `cowns` once this promise has been
+     * fulfilled. See `PromiseBase::when_all`.
+     */
+    template<
+      class Be,
+      TransferOwnership transfer = NoTransfer,
+      typename... Args>
+    void then(size_t count, Cown** cowns, Args&&... args)
+    {
+      PromiseBase* self = this;
+      PromiseBase::when_all<Be, transfer>(
+        1, &self, count, cowns, std::forward<Args>(args)...);
+    }
+
+    template<
+      class Be,
+      TransferOwnership transfer = NoTransfer,
+      typename... Args>
+    void then(Cown* cown, Args&&... args)
+    {
+      then<Be, transfer>(1, &cown, std::forward<Args>(args)...);
+    }
+
+    void trace(ObjectStack& st)
+    {
+      PromiseBase::trace_promise(st, [this](ObjectStack& vst) {
+        if constexpr (std::is_convertible_v<T, Object*>)
+        {
+          if (*value != nullptr)
+            vst.push(*value);
+        }
+        else
+        {
+          UNUSED(vst);
+        }
+      });
+    }
+
+    void finaliser(Object*, ObjectStack&)
+    {
+      PromiseBase::cancel();
+    }
+  };
+} // namespace verona::rt
@@ -6,6 +6,33 @@
 
 namespace verona::rt
 {
+  /**
+   * Properties of the entry types supported by the object maps. The `Entry`
+   * type must be either `K*` or `std::pair<K*, Value>`, where `K` is derrived
+   * from `Object`.
+   */
+  template<typename>
+  struct object_map_entry : std::false_type
+  {};
+  template<typename K>
+  struct object_map_entry<K*> : std::true_type
+  {
+    static_assert(std::is_base_of_v<Object, K>);
+    using key_type = K;
+    using value_type = key_type*;
+    using entry_view = value_type;
+    static constexpr bool is_set = true;
+  };
+  template<typename K, typename V>
+  struct object_map_entry<std::pair<K*, V>> : std::true_type
+  {
+    static_assert(std::is_base_of_v<Object, K>);
+    using key_type = K;
+    using value_type = V;
+    using entry_view = std::pair<key_type*, V*>;
+    static constexpr bool is_set = false;
+  };
+
   /**
    * Robin Hood hash map where the key type is `K*`, where `K` is derrived from
    * `Object`. The `Entry` type must be either `K*` or `std::pair<K*, Value>`.
@@ -29,37 +56,15 @@ namespace verona::rt
     static_assert((MARK_MASK & PROBE_MASK) == 0);
     static_assert(((MARK_MASK | PROBE_MASK) & ~Object::MASK) == 0);
 
-    template<typename>
-    struct inspect_entry_type : std::false_type
-    {};
-    template<typename K>
-    struct inspect_entry_type<K*> : std::true_type
-    {
-      static_assert(std::is_base_of_v<Object, K>);
-      using key_type = K;
-      using value_type = key_type*;
-      using entry_view = value_type;
-      static constexpr bool is_set = true;
-    };
-    template<typename K, typename V>
-    struct inspect_entry_type<std::pair<K*, V>> : std::true_type
-    {
-      static_assert(std::is_base_of_v<Object, K>);
-      using key_type = K;
-      using value_type = V;
-      using entry_view = std::pair<key_type*, V*>;
-      static constexpr bool is_set = false;
-    };
-
     static_assert(
-      inspect_entry_type<Entry>(),
+      object_map_entry<Entry>(),
       "Map Entry must be K* or std::pair<K*, V>"
       " where K is derrived from Object");
 
-    using KeyType = typename inspect_entry_type<Entry>::key_type;
-    using ValueType = typename inspect_entry_type<Entry>::value_type;
-    using EntryView = typename inspect_entry_type<Entry>::entry_view;
-    static constexpr bool is_set = inspect_entry_type<Entry>::is_set;
+    using KeyType = typename object_map_entry<Entry>::key_type;
+    using ValueType = typename object_map_entry<Entry>::value_type;
+    using EntryView = typename object_map_entry<Entry>::entry_view;
+    static constexpr bool is_set = object_map_entry<Entry>::is_set;
 
     /**
      * Return a reference to the entry key.
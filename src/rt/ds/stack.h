@@ -4,9 +4,97 @@
 
 #include <cassert>
 #include <snmalloc.h>
+#include <type_traits>
 
 namespace verona::rt
 {
+  /**
+   * A per-thread cache of the fixed size blocks used by stacks. Traversals such
+   * as GC, freeze and scanning create many short-lived stacks, so reusing their
+   * blocks across stacks avoids repeatedly going to the allocator.
+   *
+   * The cache is disabled by default, so that blocks are never left cached on
+   * threads that will not flush them. A thread enables it with `enable` and
+   * must call `flush` before it exits. As the cache is only accessed by its own
+   * thread, no synchronisation is required.
+   */
+  template<size_t Size>
+  class StackBlockCache
+  {
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    static_assert(Size >= sizeof(FreeBlock));
+
+    /// Maximum number of blocks kept by each thread.
+    static constexpr size_t MAX_BLOCKS = 16;
+
+    struct Local
+    {
+      FreeBlock* head = nullptr;
+      size_t count = 0;
+      bool enabled = false;
+    };
+
+    static Local& local()
+    {
+      static thread_local Local l;
+      return l;
+    }
+
+  public:
+    /// Start caching blocks on the current thread.
+    static void enable()
+    {
+      local().enabled = true;
+    }
+
+    /// Deallocate all cached blocks and stop caching on the current thread.
+    template<typename Alloc>
+    static void flush(Alloc* alloc)
+    {
+      auto& l = local();
+      while (l.head != nullptr)
+      {
+        auto* b = l.head;
+        l.head = b->next;
+        alloc->template dealloc<Size>(b);
+      }
+      l.count = 0;
+      l.enabled = false;
+    }
+
+    /// Return a cached block, or nullptr if there are none.
+    static void* take()
+    {
+      auto& l = local();
+      auto* b = l.head;
+      if (b != nullptr)
+      {
+        l.head = b->next;
+        l.count--;
+      }
+      return b;
+    }
+
+    /// Cache a block. Returns false if the block was not cached, in which case
+    /// the caller must deallocate it.
+    static bool put(void* block)
+    {
+      auto& l = local();
+      if (!l.enabled || (l.count == MAX_BLOCKS))
+        return false;
+
+      auto* b = (FreeBlock*)block;
+      b->next = l.head;
+      l.head = b;
+      l.count++;
+      return true;
+    }
+  };
+
   /**
    * This class contains the core functionality for a stack using aligned blocks
    * of memory. The stack is the size of a single pointer when empty.
@@ -145,6 +233,26 @@ namespace verona::rt
       push_slow(item, alloc);
     }
 
+    /// Push `count` elements onto the stack, in order. If they fit in the
+    /// current block, space is only checked once.
+    template<typename U>
+    ALWAYSINLINE void push_many(U* const* items, size_t count, Alloc* alloc)
+    {
+      static_assert(std::is_convertible_v<U*, T*>);
+
+      const size_t used = ((uintptr_t)index & INDEX_MASK) / sizeof(T*);
+      if ((STACK_COUNT - used) >= count)
+      {
+        for (size_t i = 0; i < count; i++)
+          index[i + 1] = items[i];
+        index += count;
+        return;
+      }
+
+      for (size_t i = 0; i < count; i++)
+        push(items[i], alloc);
+    }
+
     /// For all elements of the stack
     void forall(snmalloc::function_ref<void(T*)> apply)
     {
@@ -203,6 +311,8 @@ namespace verona::rt
    * when rapidly crossing two allocation boundaries. A loop that pushes 32
    * elements and pops them on each iteration may trigger allocation the first
    * time but will then not trigger allocation on any subsequent iteration.
+   * Blocks that are not kept as the backup are returned to the thread's
+   * `StackBlockCache`, when it is enabled, so that later stacks can reuse them.
    */
   template<class T, class Alloc>
   class Stack
@@ -234,8 +344,12 @@ namespace verona::rt
 
         if (backup)
           return std::exchange(backup, nullptr);
-        else
-          return underlying_alloc->template alloc<Size>();
+
+        auto* cached = StackBlockCache<Size>::take();
+        if (cached != nullptr)
+          return cached;
+
+        return underlying_alloc->template alloc<Size>();
       }
 
       /// Deallocate a stack Block.
@@ -248,13 +362,14 @@ namespace verona::rt
 
         if (backup == nullptr)
           backup = b;
-        else
+        else if (!StackBlockCache<Size>::put(b))
           underlying_alloc->template dealloc<Size>(b);
       }
 
       ~BackupAlloc()
       {
-        if (backup != nullptr)
+        if (
+          (backup != nullptr) && !StackBlockCache<sizeof(Block)>::put(backup))
           underlying_alloc->template dealloc<sizeof(Block)>(backup);
       }
     };
@@ -266,6 +381,10 @@ namespace verona::rt
     BackupAlloc backup_alloc;
 
   public:
+    /// The per-thread cache that blocks of this stack are returned to.
+    using BlockCache =
+      StackBlockCache<sizeof(typename StackThin<T, BackupAlloc>::Block)>;
+
     Stack(Alloc* alloc) : backup_alloc(alloc) {}
 
     /// Return top element of the stack
@@ -280,6 +399,22 @@ namespace verona::rt
       stack.push(item, &backup_alloc);
     }
 
+    /// Put several elements on the stack, in order. This is intended for
+    /// `trace` functions that push a number of fields at once.
+    template<typename... Ts>
+    ALWAYSINLINE void push(T* item1, T* item2, Ts... items)
+    {
+      T* all[] = {item1, item2, items...};
+      stack.push_many(all, sizeof...(Ts) + 2, &backup_alloc);
+    }
+
+    /// Put the `count` elements of `items` on the stack, in order.
+    template<typename U>
+    ALWAYSINLINE void push_many(U* const* items, size_t count)
+    {
+      stack.push_many(items, count, &backup_alloc);
+    }
+
     /// Remove an element on the stack
     ALWAYSINLINE T* pop()
     {
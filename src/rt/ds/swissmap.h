@@ -0,0 +1,592 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "../object/object.h"
+#include "hashmap.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  define VERONA_SWISSMAP_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace verona::rt
+{
+  namespace swissmap
+  {
+    /**
+     * Each slot of a `SwissObjectMap` has a control byte. A full slot stores
+     * the low 7 bits of its key's hash, so the high bit is clear. Empty and
+     * deleted slots have the high bit set.
+     */
+    using Ctrl = int8_t;
+    static constexpr Ctrl EMPTY = -128; // 0b10000000
+    static constexpr Ctrl DELETED = -2; // 0b11111110
+
+    /**
+     * A group of control bytes that are probed together. Each query returns a
+     * bitmask with bit `i` set if slot `i` of the group matches.
+     */
+    struct Group
+    {
+      static constexpr size_t WIDTH = 16;
+
+#ifdef VERONA_SWISSMAP_SSE2
+      __m128i ctrl;
+
+      explicit Group(const Ctrl* pos)
+      : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(pos)))
+      {}
+
+      uint32_t match(Ctrl h2) const
+      {
+        return (uint32_t)_mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+      }
+
+      uint32_t match_empty_or_deleted() const
+      {
+        return (uint32_t)_mm_movemask_epi8(ctrl);
+      }
+
+      uint32_t match_full() const
+      {
+        return match_empty_or_deleted() ^ 0xffff;
+      }
+#else
+      const Ctrl* ctrl;
+
+      explicit Group(const Ctrl* pos) : ctrl(pos) {}
+
+      uint32_t match(Ctrl h2) const
+      {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < WIDTH; i++)
+          mask |= (uint32_t)(ctrl[i] == h2) << i;
+        return mask;
+      }
+
+      uint32_t match_empty_or_deleted() const
+      {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < WIDTH; i++)
+          mask |= (uint32_t)(ctrl[i] < 0) << i;
+        return mask;
+      }
+
+      uint32_t match_full() const
+      {
+        return match_empty_or_deleted() ^ 0xffff;
+      }
+#endif
+
+      uint32_t match_empty() const
+      {
+        return match(EMPTY);
+      }
+    };
+  }
+
+  /**
+   * Hash map with the same interface as `ObjectMap`, where the key type is
+   * `K*`, where `K` is derrived from `Object`. The `Entry` type must be either
+   * `K*` or `std::pair<K*, Value>`.
+   *
+   * Unlike `ObjectMap`, the probe state is not kept in the key bits. Instead a
+   * separate array of control bytes holds 7 bits of the hash of each entry, and
+   * lookups compare a whole group of 16 control bytes at a time using SSE2,
+   * where available. Groups are probed quadratically.
+   */
+  template<typename Entry>
+  class SwissObjectMap
+  {
+    using Ctrl = swissmap::Ctrl;
+    using Group = swissmap::Group;
+
+    Entry* slots;
+    Ctrl* ctrl;
+    size_t filled_slots = 0;
+    /// Number of entries that may be inserted into empty slots before the
+    /// map must be rehashed.
+    size_t growth_left;
+    uint8_t capacity_shift;
+
+    /**
+     * The key type must be derrived from `Object` because a low bit of the key
+     * is used to encode a mark bit.
+     */
+    static constexpr uintptr_t MARK_MASK = Object::ALIGNMENT >> 1;
+
+    static_assert((MARK_MASK & ~Object::MASK) == 0);
+
+    static_assert(
+      object_map_entry<Entry>(),
+      "Map Entry must be K* or std::pair<K*, V>"
+      " where K is derrived from Object");
+
+    using KeyType = typename object_map_entry<Entry>::key_type;
+    using ValueType = typename object_map_entry<Entry>::value_type;
+    using EntryView = typename object_map_entry<Entry>::entry_view;
+    static constexpr bool is_set = object_map_entry<Entry>::is_set;
+
+    static constexpr size_t init_capacity = Group::WIDTH;
+
+    /**
+     * Return a reference to the entry key.
+     */
+    static uintptr_t& key_of(Entry& entry)
+    {
+      if constexpr (is_set)
+        return (uintptr_t&)entry;
+      else
+        return (uintptr_t&)std::get<0>(entry);
+    }
+
+    /**
+     * Return the original key value, where the low bits have been cleared.
+     */
+    static uintptr_t unmark_key(uintptr_t key)
+    {
+      return key & ~Object::MASK;
+    }
+
+    /**
+     * Return the hash of the key. The low 7 bits are stored in the control
+     * byte and the remaining bits select the first group to probe.
+     */
+    static size_t hash_of(uintptr_t key)
+    {
+      return bits::hash(((const Object*)key)->id());
+    }
+
+    static Ctrl h2(size_t hash)
+    {
+      return (Ctrl)(hash & 0x7f);
+    }
+
+    /**
+     * Return the number of entries that the given capacity may hold before
+     * the map must grow. This keeps at least one eighth of the slots empty so
+     * that every probe sequence terminates.
+     */
+    static size_t max_load(size_t capacity)
+    {
+      return capacity - (capacity / 8);
+    }
+
+    static size_t alloc_size(size_t capacity)
+    {
+      return capacity * (sizeof(Entry) + sizeof(Ctrl));
+    }
+
+    /**
+     * Allocate the slots and control bytes for the given capacity in a single
+     * allocation, with the control bytes following the slots. The capacity is
+     * a multiple of the group width, so the control bytes are suitably aligned
+     * for group loads.
+     */
+    void init_alloc(Alloc* alloc, uint8_t shift)
+    {
+      capacity_shift = shift;
+      auto* mem = (uint8_t*)alloc->alloc(alloc_size(capacity()));
+      slots = (Entry*)mem;
+      ctrl = (Ctrl*)(mem + (capacity() * sizeof(Entry)));
+      assert(((uintptr_t)ctrl % Group::WIDTH) == 0);
+      memset(ctrl, (uint8_t)swissmap::EMPTY, capacity());
+      growth_left = max_load(capacity());
+    }
+
+    void dealloc_slots(Alloc* alloc)
+    {
+      alloc->dealloc(slots, alloc_size(capacity()));
+    }
+
+    /**
+     * Call `f` with the first slot index of each group in the probe sequence
+     * for `hash`, until it returns true. The triangular sequence of group
+     * offsets visits every group because the group count is a power of two.
+     */
+    template<typename F>
+    size_t probe(size_t hash, F f) const
+    {
+      const size_t group_mask = (capacity() / Group::WIDTH) - 1;
+      size_t g = (hash >> 7) & group_mask;
+      for (size_t step = 1;; step++)
+      {
+        size_t found;
+        if (f(g * Group::WIDTH, found))
+          return found;
+
+        g = (g + step) & group_mask;
+      }
+    }
+
+    /**
+     * Return the index of the slot holding `key`, or `capacity()` if there is
+     * no such slot.
+     */
+    size_t find_index(uintptr_t key, size_t hash) const
+    {
+      const auto tag = h2(hash);
+      return probe(hash, [&](size_t base, size_t& found) {
+        const Group group(ctrl + base);
+        for (auto m = group.match(tag); m != 0; m &= m - 1)
+        {
+          const size_t index = base + bits::ctz(m);
+          if (unmark_key(key_of(slots[index])) == key)
+          {
+            found = index;
+            return true;
+          }
+        }
+
+        // An empty slot ends the probe sequence.
+        found = capacity();
+        return group.match_empty() != 0;
+      });
+    }
+
+    /**
+     * Return the index of the first empty or deleted slot in the probe sequence
+     * for `hash`.
+     */
+    size_t find_insert_index(size_t hash) const
+    {
+      return probe(hash, [&](size_t base, size_t& found) {
+        const auto m = Group(ctrl + base).match_empty_or_deleted();
+        if (m == 0)
+          return false;
+
+        found = base + bits::ctz(m);
+        return true;
+      });
+    }
+
+    void set_ctrl(size_t index, Ctrl c)
+    {
+      ctrl[index] = c;
+    }
+
+    /**
+     * Place an entry into the slot at `index`, which must not be full.
+     */
+    template<typename E>
+    void place_entry(E entry, size_t index, size_t hash)
+    {
+      if (ctrl[index] == swissmap::EMPTY)
+        growth_left--;
+
+      set_ctrl(index, h2(hash));
+      slots[index] = std::forward<E>(entry);
+      filled_slots++;
+    }
+
+    /**
+     * Move all entries into a new allocation. The capacity is doubled if more
+     * than half of the usable slots are filled, otherwise the map is rehashed
+     * at the same capacity to reclaim deleted slots.
+     */
+    void rehash(Alloc* alloc)
+    {
+      auto prev = *this;
+
+      const auto grow = filled_slots >= (max_load(capacity()) / 2);
+      init_alloc(alloc, (uint8_t)(capacity_shift + (grow ? 1 : 0)));
+      filled_slots = 0;
+
+      for (auto it = prev.begin(); it != prev.end(); ++it)
+      {
+        const auto hash = hash_of(unmark_key(key_of(it.entry())));
+        place_entry(std::move(it.entry()), find_insert_index(hash), hash);
+        key_of(it.entry()) = 0;
+      }
+      // The previous allocation is released when `prev` is destroyed.
+    }
+
+  public:
+    /**
+     * Iterator over the entries in a `SwissObjectMap`, starting from a slot
+     * index.
+     */
+    class Iterator
+    {
+      template<typename _Entry>
+      friend class SwissObjectMap;
+
+      const SwissObjectMap* map;
+      size_t index;
+
+      Entry& entry()
+      {
+        return map->slots[index];
+      }
+
+      Iterator(const SwissObjectMap* m, size_t i) : map(m), index(i) {}
+
+    public:
+      KeyType* key()
+      {
+        return (KeyType*)unmark_key(key_of(entry()));
+      }
+
+      template<bool v = !is_set, typename = typename std::enable_if_t<v>>
+      ValueType& value()
+      {
+        return entry().second;
+      }
+
+      bool is_marked()
+      {
+        return key_of(entry()) & MARK_MASK;
+      }
+
+      void mark()
+      {
+        key_of(entry()) |= MARK_MASK;
+      }
+
+      void unmark()
+      {
+        key_of(entry()) &= ~MARK_MASK;
+      }
+
+      EntryView operator*()
+      {
+        if constexpr (is_set)
+          return key();
+        else
+          return std::make_pair(key(), &value());
+      }
+
+      Iterator& operator++()
+      {
+        const auto capacity = map->capacity();
+        index++;
+        while (index < capacity)
+        {
+          // Skip to the next full slot within the current group.
+          const auto base = index & ~(Group::WIDTH - 1);
+          const auto offset = index - base;
+          const auto m = Group(map->ctrl + base).match_full() >> offset;
+          if (m != 0)
+          {
+            index += bits::ctz(m);
+            break;
+          }
+          index = base + Group::WIDTH;
+        }
+        return *this;
+      }
+
+      bool operator==(const Iterator& other) const
+      {
+        return (index == other.index) && (map == other.map);
+      }
+
+      bool operator!=(const Iterator& other) const
+      {
+        return !(*this == other);
+      }
+    };
+
+    /**
+     * Create a `SwissObjectMap` with an initial capacity for at least 14
+     * entries.
+     */
+    SwissObjectMap(Alloc* alloc)
+    {
+      init_alloc(alloc, (uint8_t)bits::ctz(init_capacity));
+    }
+
+    ~SwissObjectMap()
+    {
+      dealloc(ThreadAlloc::get());
+    }
+
+    static SwissObjectMap<Entry>* create(Alloc* alloc)
+    {
+      return new (alloc->alloc<sizeof(SwissObjectMap<Entry>)>())
+        SwissObjectMap(alloc);
+    }
+
+    void dealloc(Alloc* alloc)
+    {
+      clear(nullptr);
+      dealloc_slots(alloc);
+    }
+
+    /**
+     * Return the amount of entries in this map.
+     */
+    size_t size() const
+    {
+      return filled_slots;
+    }
+
+    /**
+     * Return the capacity for entries in the map. Note that this should not be
+     * used to approximate when the map will resize.
+     */
+    size_t capacity() const
+    {
+      return ((size_t)1 << capacity_shift);
+    }
+
+    Iterator begin() const
+    {
+      auto it = Iterator(this, 0);
+      if (ctrl[0] < 0)
+        ++it;
+
+      return it;
+    }
+
+    Iterator end() const
+    {
+      return Iterator(this, capacity());
+    }
+
+    /**
+     * Find an entry in the map with the given key and return an iterator to the
+     * corresponding entry. If no entry exitsts, the return value will be equal
+     * to the return value of `end()`.
+     */
+    Iterator find(const KeyType* key) const
+    {
+      if (key == nullptr)
+        return end();
+
+      const auto k = (uintptr_t)key;
+      return Iterator(this, find_index(k, hash_of(k)));
+    }
+
+    /**
+     * Insert an entry into the map. The first element of the returned pair will
+     * be true if a new key is inserted, and false if an existing entry is
+     * updated. The second element of the returned pair is an iterator to the
+     * inserted entry. The key of the inserted entry must not be null.
+     */
+    template<typename E>
+    std::pair<bool, Iterator> insert(Alloc* alloc, E entry)
+    {
+      assert(key_of(entry) != 0);
+      const auto key = unmark_key(key_of(entry));
+      const auto hash = hash_of(key);
+
+      auto index = find_index(key, hash);
+      if (index != capacity())
+      { // Update existing entry.
+        if constexpr (!is_set)
+          slots[index].second = std::forward<E>(entry).second;
+
+        return std::make_pair(false, Iterator(this, index));
+      }
+
+      if (unlikely(growth_left == 0))
+        rehash(alloc);
+
+      index = find_insert_index(hash);
+      place_entry(std::forward<E>(entry), index, hash);
+      assert(!(key_of(slots[index]) & MARK_MASK));
+      return std::make_pair(true, Iterator(this, index));
+    }
+
+    /**
+     * Remove an entry from the map corresponding to the given key. The return
+     * value is false if no entry was found for the key and true otherwise.
+     */
+    bool erase(const KeyType* key)
+    {
+      auto it = find(key);
+      if (it == end())
+        return false;
+
+      erase(it);
+      return true;
+    }
+
+    /**
+     * Remove an entry from the map at the given iterator position. The iterator
+     * must be valid. This operation will not invalidate the iterator.
+     */
+    void erase(Iterator& it)
+    {
+      assert(ctrl[it.index] >= 0);
+
+      // A group that has an empty slot has never been full, so no probe
+      // sequence has continued past it and the slot can be made empty.
+      // Otherwise a tombstone is required.
+      const auto base = it.index & ~(Group::WIDTH - 1);
+      if (Group(ctrl + base).match_empty() != 0)
+      {
+        set_ctrl(it.index, swissmap::EMPTY);
+        growth_left++;
+      }
+      else
+      {
+        set_ctrl(it.index, swissmap::DELETED);
+      }
+
+      it.entry().~Entry();
+      key_of(it.entry()) = 0;
+      filled_slots--;
+    }
+
+    /**
+     * Empty the map, removing all entries. If `alloc` is not null, the capacity
+     * will be reset to the initial allocation size. Resetting the allocation
+     * size may significantly improve iteration performance.
+     */
+    void clear(Alloc* alloc)
+    {
+      for (auto it = begin(); it != end(); ++it)
+      {
+        it.entry().~Entry();
+        key_of(it.entry()) = 0;
+      }
+
+      filled_slots = 0;
+
+      if ((alloc != nullptr) && (capacity() > init_capacity))
+      {
+        dealloc_slots(alloc);
+        init_alloc(alloc, (uint8_t)bits::ctz(init_capacity));
+      }
+      else
+      {
+        memset(ctrl, (uint8_t)swissmap::EMPTY, capacity());
+        growth_left = max_load(capacity());
+      }
+    }
+
+    /**
+     * Return a string representation of the map showing empty slots (`∅`),
+     * deleted slots (`×`), key positions, and control bytes.
+     */
+    template<typename OutStream>
+    OutStream& debug_layout(OutStream& out) const
+    {
+      out << "{";
+      for (size_t i = 0; i < capacity(); i++)
+      {
+        if (ctrl[i] == swissmap::EMPTY)
+        {
+          out << " ∅";
+          continue;
+        }
+        if (ctrl[i] == swissmap::DELETED)
+        {
+          out << " ×";
+          continue;
+        }
+        out << " (" << ((const KeyType*)unmark_key(key_of(slots[i])))->id()
+            << ", ctrl " << (size_t)ctrl[i] << ")";
+      }
+      out << " } cap: " << capacity();
+      return out;
+    }
+  };
+}
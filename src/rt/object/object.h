@@ -627,9 +627,8 @@ namespace verona::rt
 
     inline void set_epoch_mark(EpochMark e)
     {
-      Systematic::cout() << "Object epoch: " << this << " (" << get_class()
-                         << ") " << get_epoch_mark() << " -> " << e
-                         << std::endl;
+      VERONA_LOG() << "Object epoch: " << this << " (" << get_class() << ") "
+                   << get_epoch_mark() << " -> " << e << std::endl;
 
       // We only require relaxed consistency here as we can perfectly see old
       // values as we know that we will only need up-to-date values once we have
@@ -753,8 +752,10 @@ namespace verona::rt
      * Returns true, if this was the last decref on the cown.  If this returns
      * true all future, and parallel, calls to incref_cown_from_weak will return
      * false.
+     *
+     * Releases `count` strong references with a single atomic operation.
      **/
-    inline bool decref_cown()
+    inline bool decref_cown(size_t count = 1)
     {
       // This always performs the atomic subtraction, since the cown should
       // see its own rc as zero this is due to how weak reference to cowns
@@ -765,11 +766,12 @@ namespace verona::rt
       assert(debug_rc() != 0);
       assert(get_header().rc < FINISHED_RC);
       assert(get_class() == RegionMD::COWN);
-      static constexpr size_t DONE_RC = (size_t)RegionMD::COWN + ONE_RC;
+      assert(count > 0);
+      const size_t done_rc = (size_t)RegionMD::COWN + (count * ONE_RC);
 
-      size_t prev_rc = get_header().rc.fetch_sub(ONE_RC);
+      size_t prev_rc = get_header().rc.fetch_sub(count * ONE_RC);
 
-      if (prev_rc != DONE_RC)
+      if (prev_rc != done_rc)
         return false;
 
       yield();
@@ -779,13 +781,14 @@ namespace verona::rt
     }
 
     /**
-     * Returns true, if a strong reference was created.
+     * Returns true, if `count` strong references were created. Either all of
+     * them are created, with a single atomic operation, or none are.
      **/
-    inline bool acquire_strong_from_weak()
+    inline bool acquire_strong_from_weak(size_t count = 1)
     {
-      // Check if top bit is set, if not then we have validily created a new
-      // strong reference
-      if (get_header().rc.fetch_add(ONE_RC) < FINISHED_RC)
+      // Check if top bit is set, if not then we have validily created new
+      // strong references
+      if (get_header().rc.fetch_add(count * ONE_RC) < FINISHED_RC)
         return true;
 
       yield();
@@ -236,8 +236,8 @@ namespace verona::rt
             case Object::RC:
             case Object::COWN:
             {
-              Systematic::cout()
-                << "External reference during freeze: " << r << std::endl;
+              VERONA_LOG() << "External reference during freeze: " << r
+                           << std::endl;
               // External reference
               r->incref();
               break;
@@ -51,8 +51,8 @@ namespace verona::rt
           case Object::RC:
           case Object::SCC_PTR:
           {
-            Systematic::cout()
-              << "Immutable Scan: reaches immutable: " << o << std::endl;
+            VERONA_LOG() << "Immutable Scan: reaches immutable: " << o
+                         << std::endl;
             if (o->in_epoch(epoch))
               continue;
 
@@ -65,8 +65,7 @@ namespace verona::rt
 
           case Object::COWN:
           {
-            Systematic::cout()
-              << "Immutable Scan: reaches cown: " << o << std::endl;
+            VERONA_LOG() << "Immutable Scan: reaches cown: " << o << std::endl;
             cown::mark_for_scan(o, epoch);
             break;
           }
@@ -180,7 +179,7 @@ namespace verona::rt
 
         case Object::COWN:
         {
-          Systematic::cout() << "Immutable releasing cown: " << w << std::endl;
+          VERONA_LOG() << "Immutable releasing cown: " << w << std::endl;
           cown::release(alloc, (Cown*)w);
           break;
         }
@@ -140,8 +140,7 @@ namespace verona::rt
       {
         o = recurse.pop();
         assert(o->debug_is_iso());
-        Systematic::cout() << "Region Scan: scanning region: " << o
-                           << std::endl;
+        VERONA_LOG() << "Region Scan: scanning region: " << o << std::endl;
         switch (Region::get_type(o->get_region()))
         {
           case RegionType::Trace:
@@ -266,24 +265,22 @@ namespace verona::rt
             p = p->immutable();
             [[fallthrough]];
           case Object::RC:
-            Systematic::cout()
-              << "Region Scan: reaches immutable: " << p << std::endl;
+            VERONA_LOG() << "Region Scan: reaches immutable: " << p
+                         << std::endl;
             Immutable::mark_and_scan(alloc, p, epoch);
             break;
 
           case Object::ISO:
             if (o != p)
             {
-              Systematic::cout()
-                << "Region Scan: pushing subregion to worklist: " << p
-                << std::endl;
+              VERONA_LOG() << "Region Scan: pushing subregion to worklist: "
+                           << p << std::endl;
               recurse.push(p);
             }
             break;
 
           case Object::COWN:
-            Systematic::cout()
-              << "Region Scan: reaches cown: " << p << std::endl;
+            VERONA_LOG() << "Region Scan: reaches cown: " << p << std::endl;
             cown::mark_for_scan(p, epoch);
             break;
 
@@ -549,7 +549,7 @@ namespace verona::rt
       // Don't trace or finalise o, we'll do it when looping over the large
       // object ring or the arena list.
 
-      Systematic::cout() << "Region release: arena region: " << o << std::endl;
+      VERONA_LOG() << "Region release: arena region: " << o << std::endl;
 
       // Clean up all the non-trivial objects, by running the finaliser and
       // destructor, and collecting iso regions.
@@ -237,7 +237,7 @@ namespace verona::rt
      **/
     static void gc(Alloc* alloc, Object* o)
     {
-      Systematic::cout() << "Region GC called for: " << o << std::endl;
+      VERONA_LOG() << "Region GC called for: " << o << std::endl;
       assert(o->debug_is_iso());
       assert(is_trace_region(o->get_region()));
 
@@ -247,7 +247,7 @@ namespace verona::rt
 
       // Copy additional roots into f.
       reg->additional_entry_points.forall([&f](Object* o) {
-        Systematic::cout() << "Additional root: " << o << std::endl;
+        VERONA_LOG() << "Additional root: " << o << std::endl;
         f.push(o);
       });
 
@@ -260,8 +260,8 @@ namespace verona::rt
       {
         o = collect.pop();
         assert(o->debug_is_iso());
-        Systematic::cout() << "Region GC: releasing unreachable subregion: "
-                           << o << std::endl;
+        VERONA_LOG() << "Region GC: releasing unreachable subregion: " << o
+                     << std::endl;
 
         // Note that we need to dispatch because `r` is a different region
         // metadata object.
@@ -410,7 +410,7 @@ namespace verona::rt
             break;
 
           case Object::UNMARKED:
-            Systematic::cout() << "Mark" << p << std::endl;
+            VERONA_LOG() << "Mark" << p << std::endl;
             p->mark();
             p->trace(dfs);
             break;
@@ -554,7 +554,7 @@ namespace verona::rt
           case Object::UNMARKED:
           {
             Object* q = p->get_next();
-            Systematic::cout() << "Sweep " << p << std::endl;
+            VERONA_LOG() << "Sweep " << p << std::endl;
             sweep_object<ring>(alloc, p, o, &gc, collect);
 
             if (ring != primary_ring && prev == this)
@@ -606,14 +606,14 @@ namespace verona::rt
       // It is an error if this region has additional roots.
       if (!additional_entry_points.empty())
       {
-        Systematic::cout() << "Region release failed due to additional roots"
-                           << std::endl;
+        VERONA_LOG() << "Region release failed due to additional roots"
+                     << std::endl;
         additional_entry_points.forall(
-          [](Object* o) { Systematic::cout() << " root" << o << std::endl; });
+          [](Object* o) { VERONA_LOG() << " root" << o << std::endl; });
         abort();
       }
 
-      Systematic::cout() << "Region release: trace region: " << o << std::endl;
+      VERONA_LOG() << "Region release: trace region: " << o << std::endl;
 
       // Sweep everything, including the entrypoint.
       sweep<SweepAll::Yes>(alloc, o, collect);
@@ -131,14 +131,14 @@ namespace verona::rt
         case Object::RC:
         {
           assert(o->debug_is_immutable());
-          Systematic::cout() << "RS releasing: immutable: " << o << std::endl;
+          VERONA_LOG() << "RS releasing: immutable: " << o << std::endl;
           Immutable::release(alloc, o);
           break;
         }
 
         case Object::COWN:
         {
-          Systematic::cout() << "RS releasing: cown: " << o << std::endl;
+          VERONA_LOG() << "RS releasing: cown: " << o << std::endl;
           cown::release(alloc, (Cown*)o);
           break;
         }
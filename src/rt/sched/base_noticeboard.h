@@ -93,8 +93,7 @@ namespace verona::rt
       {
         return;
       }
-      Systematic::cout() << "Flushing values on noticeboard: " << this
-                         << std::endl;
+      VERONA_LOG() << "Flushing values on noticeboard: " << this << std::endl;
       flush_n(alloc, update_buffer.size());
     }
 
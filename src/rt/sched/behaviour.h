@@ -10,6 +10,7 @@ namespace verona::rt
 {
   using namespace snmalloc;
   class Cown;
+  class PromiseBase;
 
   /**
    * This class represents the closure run when all the cowns required have
@@ -26,6 +27,7 @@ namespace verona::rt
   {
     friend class Cown;
     friend class MultiMessage;
+    friend class PromiseBase;
 
   public:
     struct alignas(descriptor_alignment) Descriptor
@@ -46,6 +48,12 @@ namespace verona::rt
        * Trace the reachable objects from this behaviour.
        **/
       TraceFunction trace;
+
+      /**
+       * Finalise the state of a behaviour that will never be run. May be
+       * nullptr if there is no state to finalise.
+       **/
+      Function destructor;
     };
 
   protected:
@@ -70,6 +78,13 @@ namespace verona::rt
       get_descriptor()->trace(this, st);
     }
 
+    inline void destructor()
+    {
+      auto d = get_descriptor()->destructor;
+      if (d != nullptr)
+        d(this);
+    }
+
     inline const Descriptor* get_descriptor() const
     {
       return descriptor;
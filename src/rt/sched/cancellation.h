@@ -0,0 +1,104 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <snmalloc.h>
+
+namespace verona::rt
+{
+  using namespace snmalloc;
+
+  /**
+   * A flag shared between the code that schedules behaviours and the
+   * behaviours themselves. Once cancelled, any behaviour that carries the
+   * token and has not started running is dropped by the runtime.
+   *
+   * Tokens are reference counted. `create` returns a token with a reference
+   * count of one, owned by the caller. Each message body carrying the token
+   * holds its own reference.
+   */
+  class CancellationToken
+  {
+    std::atomic<size_t> rc{1};
+    std::atomic<bool> cancelled{false};
+
+    CancellationToken() = default;
+
+  public:
+    static CancellationToken* create(Alloc* alloc = ThreadAlloc::get())
+    {
+      return new (alloc->alloc<sizeof(CancellationToken)>())
+        CancellationToken();
+    }
+
+    void acquire()
+    {
+      rc.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release(Alloc* alloc = ThreadAlloc::get())
+    {
+      if (rc.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        alloc->dealloc<sizeof(CancellationToken)>(this);
+    }
+
+    /// Drop every behaviour carrying this token that has not started yet.
+    void cancel()
+    {
+      cancelled.store(true, std::memory_order_release);
+    }
+
+    bool is_cancelled() const
+    {
+      return cancelled.load(std::memory_order_acquire);
+    }
+  };
+
+  /**
+   * When a behaviour stops being worth running: a deadline, a cancellation
+   * token, or both. A behaviour that has expired by the time it reaches the
+   * front of a cown's queue is dropped instead of run.
+   *
+   * The default value never expires.
+   */
+  struct Expiry
+  {
+    using Clock = std::chrono::steady_clock;
+
+    /// Deadline in nanoseconds of `Clock`, or zero for none.
+    uint64_t deadline = 0;
+    /// Not owned. The runtime acquires its own reference when scheduling.
+    CancellationToken* token = nullptr;
+
+    Expiry() = default;
+
+    Expiry(Clock::time_point d, CancellationToken* t = nullptr)
+    : deadline(to_ns(d)), token(t)
+    {}
+
+    Expiry(CancellationToken* t) : token(t) {}
+
+    /// Expire `d` from now.
+    static Expiry after(Clock::duration d, CancellationToken* t = nullptr)
+    {
+      return Expiry(Clock::now() + d, t);
+    }
+
+    static uint64_t now()
+    {
+      return to_ns(Clock::now());
+    }
+
+  private:
+    static uint64_t to_ns(Clock::time_point t)
+    {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  t.time_since_epoch())
+                  .count();
+      // Zero is reserved for "no deadline".
+      return (ns <= 0) ? 1 : (uint64_t)ns;
+    }
+  };
+} // namespace verona::rt
@@ -116,6 +116,28 @@ namespace verona::rt
     std::atomic<Status> status{};
     std::atomic<uintptr_t> bp_state{(Cown*)nullptr | Priority::Normal};
 
+    /// The scheduler thread this cown always runs on, or nullptr if it may run
+    /// on any thread. See `pin`.
+    CownThread* pinned = nullptr;
+
+    /// Capacity of the message queue in bounded mode, or zero if the queue is
+    /// unbounded. See `set_queue_capacity`.
+    size_t queue_capacity = 0;
+    /// In bounded mode, the number of messages sent to this cown and the number
+    /// of those that have been taken out of its queue. The dequeue count is
+    /// only published once per batch in `run`, so the queue length seen by
+    /// senders may be an overestimate.
+    std::atomic<size_t> enqueue_count{0};
+    std::atomic<size_t> dequeue_count{0};
+
+    /// Time at which this cown was last muted, and the number of times and
+    /// total ticks it has been muted for. These are only written by the thread
+    /// muting or unmuting the cown, which are ordered by `bp_state`, but may be
+    /// read at any time. See `times_muted` and `muted_ticks`.
+    uint64_t mute_tsc = 0;
+    std::atomic<uint32_t> mute_count{0};
+    std::atomic<uint64_t> muted_total{0};
+
     static Cown* create_token_cown()
     {
       static constexpr Descriptor desc = {
@@ -207,6 +229,9 @@ namespace verona::rt
       Scheduler::yield_my_turn();
 #endif
 
+      if (queue_capacity != 0)
+        enqueue_count.fetch_add(1, std::memory_order_relaxed);
+
       bool needs_scheduling = queue.enqueue(m);
 
       yield();
@@ -258,21 +283,94 @@ namespace verona::rt
       queue.wake();
     }
 
+    /**
+     * Whether this cown can be pinned: it has no pending messages, and is
+     * neither scheduled nor running.
+     */
+    bool can_pin()
+    {
+      return queue.is_sleeping();
+    }
+
+    /**
+     * Pin this cown to a scheduler thread. The cown will only ever run on that
+     * thread and is never stolen by other threads. A behaviour on several cowns
+     * that include a pinned cown runs on the pinned cown's thread. If several
+     * of its cowns are pinned to different threads, it runs on one of them.
+     *
+     * When called on a scheduler thread, the cown is pinned to that thread.
+     * Otherwise, the scheduler must have been initialised, and a thread is
+     * picked round robin. The pinning lasts until the scheduler is torn down.
+     *
+     * This must only be called while `can_pin()` holds, e.g. before any
+     * messages are sent to the cown.
+     */
+    void pin()
+    {
+      assert(can_pin());
+
+      auto* t = Scheduler::local();
+      if (t == nullptr)
+        t = Scheduler::round_robin();
+
+      VERONA_LOG() << "Pin cown " << this << " to " << t->systematic_id
+                   << std::endl;
+      pinned = t;
+    }
+
+    CownThread* pinned_thread()
+    {
+      return pinned;
+    }
+
+    /**
+     * Put this cown's message queue into bounded mode. Once at least
+     * `capacity` messages are pending, the cown is treated as overloaded by the
+     * backpressure system and muting is triggered for its senders, regardless
+     * of its measured load. A capacity of zero makes the queue unbounded.
+     *
+     * This must be called while the cown has no pending messages, e.g. before
+     * any messages are sent to it.
+     */
+    void set_queue_capacity(size_t capacity)
+    {
+      assert(queue.is_sleeping());
+      queue_capacity = capacity;
+    }
+
+    /// Return true if this cown has a bounded queue that is at capacity.
+    bool queue_full()
+    {
+      if (queue_capacity == 0)
+        return false;
+
+      // Every dequeued message was enqueued first, so reading the dequeue
+      // count first means the enqueue count read after it is no smaller.
+      // Clamp anyway, as the dequeue count may run ahead of a stale read.
+      const auto dequeued = dequeue_count.load(std::memory_order_acquire);
+      const auto enqueued = enqueue_count.load(std::memory_order_relaxed);
+      return (enqueued > dequeued) && ((enqueued - dequeued) >= queue_capacity);
+    }
+
     static void acquire(Object* o)
     {
-      Systematic::cout() << "Cown " << o << " acquire" << std::endl;
+      VERONA_LOG() << "Cown " << o << " acquire" << std::endl;
       assert(o->debug_is_cown());
       o->incref();
     }
 
-    static void release(Alloc* alloc, Cown* o)
+    /**
+     * Release `count` strong references to `o`, with a single atomic
+     * operation on the reference count.
+     **/
+    static void release(Alloc* alloc, Cown* o, size_t count = 1)
     {
-      Systematic::cout() << "Cown " << o << " release" << std::endl;
+      VERONA_LOG() << "Cown " << o << " release" << std::endl;
       assert(o->debug_is_cown());
       Cown* a = ((Cown*)o);
 
       // Perform decref
-      bool last = o->decref_cown();
+      bool last = o->decref_cown(count);
       yield();
 
       if (!last)
@@ -281,7 +379,7 @@ namespace verona::rt
       // All paths from this point must release the weak count owned by the
       // strong count.
 
-      Systematic::cout() << "Cown " << o << " dealloc" << std::endl;
+      VERONA_LOG() << "Cown " << o << " dealloc" << std::endl;
 
       // During teardown don't recursively delete.
       if (Scheduler::is_teardown_in_progress())
@@ -300,8 +398,8 @@ namespace verona::rt
       {
         if (!o->is_live(Scheduler::epoch()))
         {
-          Systematic::cout()
-            << "Not performing recursive deallocation on: " << o << std::endl;
+          VERONA_LOG() << "Not performing recursive deallocation on: " << o
+                       << std::endl;
           // The cown may have already been swept, just remove weak count, let
           // sweeping/cown stub collection deal with the rest.
           a->weak_count.fetch_sub(1);
@@ -318,21 +416,41 @@ namespace verona::rt
     }
 
     /**
-     * Release a weak reference to this cown.
+     * Release strong references to a batch of cowns, for instance those
+     * returned by a bulk `acquire_strong_from_weak`. Null entries are skipped.
+     * Adjacent entries for the same cown are released with a single atomic
+     * operation.
+     **/
+    static void release(Alloc* alloc, size_t count, Cown* const* cowns)
+    {
+      size_t i = 0;
+      while (i < count)
+      {
+        Cown* c = cowns[i];
+        size_t run = run_length(count, cowns, i);
+        i += run;
+
+        if (c != nullptr)
+          release(alloc, c, run);
+      }
+    }
+
+    /**
+     * Release `count` weak references to this cown.
      **/
-    void weak_release(Alloc* alloc)
+    void weak_release(Alloc* alloc, size_t count = 1)
     {
-      Systematic::cout() << "Cown " << this << " weak release" << std::endl;
-      if (weak_count.fetch_sub(1) == 1)
+      VERONA_LOG() << "Cown " << this << " weak release" << std::endl;
+      assert(count > 0);
+      if (weak_count.fetch_sub(count) == count)
       {
         auto* t = owning_thread();
         yield();
         if (!t)
         {
           // Deallocate an unowned cown
-          Systematic::cout()
-            << "Not allocated on a Verona thread, so deallocating: " << this
-            << std::endl;
+          VERONA_LOG() << "Not allocated on a Verona thread, so deallocating: "
+                       << this << std::endl;
           assert(epoch_when_popped == NO_EPOCH_SET);
           dealloc(alloc);
           return;
@@ -348,11 +466,15 @@ namespace verona::rt
       }
     }
 
-    void weak_acquire()
+    /**
+     * Acquire `count` weak references to this cown. The caller must already
+     * hold a strong or weak reference.
+     **/
+    void weak_acquire(size_t count = 1)
     {
-      Systematic::cout() << "Cown " << this << " weak acquire" << std::endl;
+      VERONA_LOG() << "Cown " << this << " weak acquire" << std::endl;
       assert(weak_count > 0);
-      weak_count++;
+      weak_count.fetch_add(count);
     }
 
     /**
@@ -362,9 +484,44 @@ namespace verona::rt
      *
      * Returns true is strong reference created.
      **/
-    bool acquire_strong_from_weak()
+    bool acquire_strong_from_weak(size_t count = 1)
+    {
+      return Object::acquire_strong_from_weak(count);
+    }
+
+    /**
+     * Gets strong references from a batch of weak references.
+     *
+     * For each `i`, `strong[i]` is set to `weak[i]` if a strong reference was
+     * created, and to null otherwise. `strong` may be the same array as
+     * `weak`. Adjacent entries for the same cown are upgraded with a single
+     * atomic operation, so callers upgrading many references to few cowns
+     * should group them. The weak references are preserved.
+     *
+     * Returns the number of strong references created. They are released
+     * with `release(alloc, count, strong)`.
+     **/
+    static size_t
+    acquire_strong_from_weak(size_t count, Cown* const* weak, Cown** strong)
     {
-      return Object::acquire_strong_from_weak();
+      size_t acquired = 0;
+      size_t i = 0;
+      while (i < count)
+      {
+        Cown* c = weak[i];
+        size_t run = run_length(count, weak, i);
+
+        if ((c != nullptr) && c->acquire_strong_from_weak(run))
+          acquired += run;
+        else
+          c = nullptr;
+
+        for (size_t j = i; j < (i + run); j++)
+          strong[j] = c;
+        i += run;
+      }
+
+      return acquired;
     }
 
     static void mark_for_scan(Object* o, EpochMark epoch)
@@ -373,8 +530,8 @@ namespace verona::rt
 
       if (cown->cown_marked_for_scan(epoch))
       {
-        Systematic::cout() << "Already marked " << cown << " ("
-                           << cown->get_epoch_mark() << ")" << std::endl;
+        VERONA_LOG() << "Already marked " << cown << " ("
+                     << cown->get_epoch_mark() << ")" << std::endl;
         return;
       }
 
@@ -405,6 +562,12 @@ namespace verona::rt
       // This should only be called if the cown is known to have been
       // unscheduled, for example when detecting a previously empty message
       // queue on send, or when rescheduling after a multi-message.
+      if (pinned != nullptr)
+      {
+        pinned->schedule_pinned(this);
+        return;
+      }
+
       CownThread* t = Scheduler::local();
 
       if (t != nullptr)
@@ -422,6 +585,15 @@ namespace verona::rt
     }
 
   private:
+    /// Number of entries from `i` onwards that are the same as `cowns[i]`.
+    static size_t run_length(size_t count, Cown* const* cowns, size_t i)
+    {
+      size_t j = i + 1;
+      while ((j < count) && (cowns[j] == cowns[i]))
+        j++;
+      return j - i;
+    }
+
     bool in_epoch(EpochMark epoch)
     {
       bool result = Object::in_epoch(epoch);
@@ -461,21 +633,19 @@ namespace verona::rt
         switch (o->get_class())
         {
           case RegionMD::ISO:
-            Systematic::cout()
-              << "Object Scan: reaches region: " << o << std::endl;
+            VERONA_LOG() << "Object Scan: reaches region: " << o << std::endl;
             Region::cown_scan(alloc, o, epoch);
             break;
 
           case RegionMD::RC:
           case RegionMD::SCC_PTR:
-            Systematic::cout()
-              << "Object Scan: reaches immutable: " << o << std::endl;
+            VERONA_LOG() << "Object Scan: reaches immutable: " << o
+                         << std::endl;
             Immutable::mark_and_scan(alloc, o, epoch);
             break;
 
           case RegionMD::COWN:
-            Systematic::cout()
-              << "Object Scan: reaches cown " << o << std::endl;
+            VERONA_LOG() << "Object Scan: reaches cown " << o << std::endl;
             Cown::mark_for_scan(o, epoch);
             break;
 
@@ -541,8 +711,8 @@ namespace verona::rt
       {
         auto m = MultiMessage::make_message(alloc, body, epoch);
         auto* next = body->cowns[body->index];
-        Systematic::cout() << "MultiMessage " << m << ": fast requesting "
-                           << next << ", index " << body->index << std::endl;
+        VERONA_LOG() << "MultiMessage " << m << ": fast requesting " << next
+                     << ", index " << body->index << std::endl;
 
         if (body->index > 0)
         {
@@ -565,8 +735,10 @@ namespace verona::rt
         auto try_fast_send = [next, m]() -> bool {
           bool needs_scheduling = next->send<YesTransfer, YesTryFast>(m);
           if (!needs_scheduling)
-            Systematic::cout()
-              << "MultiMessage " << m << ": fast send interrupted" << std::endl;
+          {
+            VERONA_LOG() << "MultiMessage " << m << ": fast send interrupted"
+                         << std::endl;
+          }
 
           return needs_scheduling;
         };
@@ -588,14 +760,14 @@ namespace verona::rt
           }
         }
 
-        Systematic::cout() << "MultiMessage " << m << ": fast acquire cown "
-                           << next << std::endl;
+        VERONA_LOG() << "MultiMessage " << m << ": fast acquire cown " << next
+                     << std::endl;
         if (body->index == last)
         {
           // Case 2: acquired the last cown.
-          Systematic::cout()
-            << "MultiMessage " << m
-            << ": fast send complete, reschedule last cown" << std::endl;
+          VERONA_LOG() << "MultiMessage " << m
+                       << ": fast send complete, reschedule last cown"
+                       << std::endl;
           next->schedule();
           return;
         }
@@ -609,6 +781,7 @@ namespace verona::rt
         const auto* m2 = next->queue.dequeue(alloc);
         assert(m == m2);
         UNUSED(m2);
+        next->record_dequeues(1);
       }
     }
 
@@ -630,28 +803,16 @@ namespace verona::rt
 
       EpochMark e = m->get_epoch();
 
-      Systematic::cout() << "MultiMessage " << m << " index " << body.index
-                         << " acquired " << cown << " epoch " << e << std::endl;
+      VERONA_LOG() << "MultiMessage " << m << " index " << body.index
+                   << " acquired " << cown << " epoch " << e << std::endl;
 
-      // If we are in should_scan, and we observe a message in this epoch,
-      // then all future messages must have been sent while in pre-scan or
-      // later. Thus any messages that weren't implicitly scanned on send,
-      // will be counted as inflight
-      if (Scheduler::should_scan() && e == Scheduler::local()->send_epoch)
-      {
-        // TODO: Investigate systematic testing coverage here.
-        if (cown->get_epoch_mark() != Scheduler::local()->send_epoch)
-        {
-          cown->scan(alloc, Scheduler::local()->send_epoch);
-          cown->set_epoch_mark(Scheduler::local()->send_epoch);
-        }
-      }
+      scan_receiver(alloc, cown, e);
 
       if (body.index < last)
       {
         if (e != Scheduler::local()->send_epoch)
         {
-          Systematic::cout() << "Message not in current epoch" << std::endl;
+          VERONA_LOG() << "Message not in current epoch" << std::endl;
           // We can only see messages from other epochs during the prescan and
           // scan phases.  The message epochs must be up-to-date in all other
           // phases.  We can also see messages sent by threads that have made
@@ -662,7 +823,7 @@ namespace verona::rt
 
           if (e != EpochMark::EPOCH_NONE)
           {
-            Systematic::cout() << "Message old" << std::endl;
+            VERONA_LOG() << "Message old" << std::endl;
 
             // Count message as this must be an old message being resent for a
             // further acquisition.
@@ -676,7 +837,7 @@ namespace verona::rt
         {
           if (cown->get_epoch_mark() != Scheduler::local()->send_epoch)
           {
-            Systematic::cout() << "Contains unscanned cown." << std::endl;
+            VERONA_LOG() << "Contains unscanned cown." << std::endl;
 
             // Count message as this contains a cown, that has a message queue
             // that could potentially have old messages in.
@@ -700,49 +861,131 @@ namespace verona::rt
         Scheduler::recv_inflight_message();
       }
 
-      if (Scheduler::should_scan())
+      scan_message(alloc, m, e);
+
+      auto* local = Scheduler::local();
+      local->message_body = &body;
+
+      for (size_t i = 0; i < body.count; i++)
+        body.cowns[i]->set_blocker(nullptr);
+
+      // Run the behaviour. Its scratch memory is freed as soon as it returns.
+      Trace::record(Trace::BehaviourStart, cown);
+      local->scratch.enter();
+      body.behaviour->f();
+      local->scratch.reset(alloc);
+      Trace::record(Trace::BehaviourEnd);
+
+      VERONA_LOG() << "MultiMessage " << m << " completed and running on "
+                   << cown << std::endl;
+
+      // Free the body and the behaviour.
+      alloc->dealloc(body.behaviour, body.behaviour->size());
+      MultiMessage::dealloc_body(alloc, &body);
+
+      return true;
+    }
+
+    /**
+     * If we are in should_scan, and we observe a message in this epoch, then
+     * all future messages must have been sent while in pre-scan or later.
+     * Thus any messages that weren't implicitly scanned on send, will be
+     * counted as inflight.
+     **/
+    static void scan_receiver(Alloc* alloc, Cown* cown, EpochMark e)
+    {
+      if (Scheduler::should_scan() && e == Scheduler::local()->send_epoch)
       {
-        if (e != Scheduler::local()->send_epoch)
+        // TODO: Investigate systematic testing coverage here.
+        if (cown->get_epoch_mark() != Scheduler::local()->send_epoch)
         {
-          Systematic::cout() << "Trace message: " << m << std::endl;
+          cown->scan(alloc, Scheduler::local()->send_epoch);
+          cown->set_epoch_mark(Scheduler::local()->send_epoch);
+        }
+      }
+    }
 
-          // Scan cowns for this message, as they may not have been scanned
-          // yet.
-          for (size_t i = 0; i < body.count; i++)
-          {
-            Systematic::cout()
-              << "Scanning cown " << body.cowns[i] << std::endl;
-            body.cowns[i]->scan(alloc, Scheduler::local()->send_epoch);
-          }
+    /**
+     * Scan the cowns and closure of a message that is about to be consumed,
+     * if it was not scanned when it was sent.
+     **/
+    static void scan_message(Alloc* alloc, MultiMessage* m, EpochMark e)
+    {
+      if (!Scheduler::should_scan())
+        return;
 
-          // Scan closure
-          ObjectStack f(alloc);
-          body.behaviour->trace(f);
-          scan_stack(alloc, Scheduler::local()->send_epoch, f);
-        }
-        else
+      MultiMessage::MultiMessageBody& body = *(m->get_body());
+      if (e != Scheduler::local()->send_epoch)
+      {
+        VERONA_LOG() << "Trace message: " << m << std::endl;
+
+        // Scan cowns for this message, as they may not have been scanned
+        // yet.
+        for (size_t i = 0; i < body.count; i++)
         {
-          Systematic::cout() << "Trace message not required: " << m << " (" << e
-                             << ")" << std::endl;
+          VERONA_LOG() << "Scanning cown " << body.cowns[i] << std::endl;
+          body.cowns[i]->scan(alloc, Scheduler::local()->send_epoch);
         }
+
+        // Scan closure
+        ObjectStack f(alloc);
+        body.behaviour->trace(f);
+        scan_stack(alloc, Scheduler::local()->send_epoch, f);
+      }
+      else
+      {
+        VERONA_LOG() << "Trace message not required: " << m << " (" << e
+                     << ")" << std::endl;
       }
+    }
 
-      Scheduler::local()->message_body = &body;
+    /**
+     * Drop a multi-message whose behaviour has expired, without running it.
+     *
+     * Cowns [0, index) have been acquired for the message, so they are
+     * rescheduled as if the behaviour had completed. The cown at `index` is
+     * the one running. The message was never sent to the remaining cowns, so
+     * the references it holds on them are released.
+     **/
+    static void drop_step(MultiMessage* m)
+    {
+      MultiMessage::MultiMessageBody& body = *(m->get_body());
+      Alloc* alloc = ThreadAlloc::get();
+      auto cown = body.cowns[body.index];
 
-      for (size_t i = 0; i < body.count; i++)
-        body.cowns[i]->set_blocker(nullptr);
+      EpochMark e = m->get_epoch();
 
-      // Run the behaviour.
-      body.behaviour->f();
+      VERONA_LOG() << "MultiMessage " << m << " index " << body.index
+                   << " expired on " << cown << " epoch " << e << std::endl;
 
-      Systematic::cout() << "MultiMessage " << m << " completed and running on "
-                         << cown << std::endl;
+      scan_receiver(alloc, cown, e);
 
-      // Free the body and the behaviour.
+      if (e == EpochMark::EPOCH_NONE)
+      {
+        // decrement counter as it must have been incremented earlier for the
+        // message send
+        Scheduler::recv_inflight_message();
+      }
+
+      // The cowns released below may only be reachable from this message.
+      scan_message(alloc, m, e);
+
+      for (size_t i = 0; i < body.index; i++)
+      {
+        body.cowns[i]->set_blocker(nullptr);
+        body.cowns[i]->schedule();
+      }
+      cown->set_blocker(nullptr);
+
+      for (size_t i = body.index + 1; i < body.count; i++)
+        Cown::release(alloc, body.cowns[i]);
+
+      body.behaviour->destructor();
       alloc->dealloc(body.behaviour, body.behaviour->size());
-      alloc->dealloc<sizeof(MultiMessage::MultiMessageBody)>(m->get_body());
+      alloc->dealloc(body.cowns, body.count * sizeof(Cown*));
+      MultiMessage::dealloc_body(alloc, &body);
 
-      return true;
+      Scheduler::local()->stats.drop();
     }
 
   public:
@@ -756,6 +999,35 @@ namespace verona::rt
         1, &cown, std::forward<Args>(args)...);
     }
 
+    /**
+     * Schedule a lambda to run on `cown`.
+     *
+     * The lambda and `captures` are stored in the behaviour, so no allocation
+     * is needed beyond that of a `VBehaviour`. When the behaviour runs, the
+     * lambda is called with the stored captures. Any capture that is a
+     * pointer to a Verona object is traced automatically. State captured by
+     * the lambda itself is not traced, so the lambda must only refer to Verona
+     * objects through the cowns it runs on or through `captures`.
+     *
+     * Defined in cpp/vbehaviour.h.
+     **/
+    template<
+      TransferOwnership transfer = NoTransfer,
+      typename F,
+      typename... Captures>
+    static void schedule(Cown* cown, F&& f, Captures&&... captures);
+
+    /**
+     * Schedule a lambda to run once all `count` cowns have been acquired. See
+     * above.
+     **/
+    template<
+      TransferOwnership transfer = NoTransfer,
+      typename F,
+      typename... Captures>
+    static void
+    schedule(size_t count, Cown** cowns, F&& f, Captures&&... captures);
+
     /**
      * Sends a multi-message to the first cown we want to acquire.
      *
@@ -770,22 +1042,95 @@ namespace verona::rt
     static void schedule(size_t count, Cown** cowns, Args&&... args)
     {
       static_assert(std::is_base_of_v<Behaviour, Be>);
-      Systematic::cout() << "Schedule behaviour of type: " << typeid(Be).name()
-                         << std::endl;
+      VERONA_LOG() << "Schedule behaviour of type: " << typeid(Be).name()
+                   << std::endl;
+
+      auto* alloc = ThreadAlloc::get();
+      auto* be =
+        new ((Be*)alloc->alloc<sizeof(Be)>()) Be(std::forward<Args>(args)...);
+      auto** sort = sort_cowns<transfer>(alloc, count, cowns);
+
+      schedule_sorted(alloc, count, sort, be);
+    }
+
+    /**
+     * As `schedule`, but the behaviour is dropped instead of run if it
+     * expires before it starts: either its deadline passes, or its
+     * cancellation token is cancelled. This sheds stale work under overload
+     * without every behaviour having to check for it.
+     *
+     * A dropped behaviour has its destructor run, if any, and its references
+     * to the cowns released.
+     **/
+    template<
+      class Be,
+      TransferOwnership transfer = NoTransfer,
+      typename... Args>
+    static void
+    schedule_until(Expiry expiry, size_t count, Cown** cowns, Args&&... args)
+    {
+      static_assert(std::is_base_of_v<Behaviour, Be>);
+      VERONA_LOG() << "Schedule expiring behaviour of type: "
+                   << typeid(Be).name() << std::endl;
 
       auto* alloc = ThreadAlloc::get();
       auto* be =
         new ((Be*)alloc->alloc<sizeof(Be)>()) Be(std::forward<Args>(args)...);
+      auto** sort = sort_cowns<transfer>(alloc, count, cowns);
+
+      schedule_sorted(alloc, count, sort, be, expiry);
+    }
+
+    template<
+      class Be,
+      TransferOwnership transfer = NoTransfer,
+      typename... Args>
+    static void schedule_until(Expiry expiry, Cown* cown, Args&&... args)
+    {
+      schedule_until<Be, transfer>(
+        expiry, 1, &cown, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Sends a behaviour that the caller has already constructed, for
+     * behaviours whose size is only known at runtime. `be` must have been
+     * allocated from `ThreadAlloc::get()` with the size of its descriptor,
+     * and ownership of it is transferred to the runtime.
+     **/
+    template<TransferOwnership transfer = NoTransfer>
+    static void schedule_behaviour(size_t count, Cown** cowns, Behaviour* be)
+    {
+      VERONA_LOG() << "Schedule preallocated behaviour" << std::endl;
+
+      auto* alloc = ThreadAlloc::get();
+      auto** sort = sort_cowns<transfer>(alloc, count, cowns);
+
+      schedule_sorted(alloc, count, sort, be);
+    }
+
+  protected:
+    /**
+     * Allocate a copy of `cowns` in the order in which they must be acquired.
+     * Unless `transfer = YesTransfer`, a reference count is acquired on each
+     * cown for the copy.
+     **/
+    template<TransferOwnership transfer = NoTransfer>
+    static Cown** sort_cowns(Alloc* alloc, size_t count, Cown** cowns)
+    {
       auto** sort = (Cown**)alloc->alloc(count * sizeof(Cown*));
       memcpy(sort, cowns, count * sizeof(Cown*));
 
-#ifdef USE_SYSTEMATIC_TESTING
+      // Pinned cowns are acquired last, so that the behaviour runs on the
+      // thread of a pinned cown.
       std::sort(&sort[0], &sort[count], [](Cown*& a, Cown*& b) {
+        if ((a->pinned == nullptr) != (b->pinned == nullptr))
+          return b->pinned != nullptr;
+#ifdef USE_SYSTEMATIC_TESTING
         return a->id() < b->id();
-      });
 #else
-      std::sort(&sort[0], &sort[count]);
+        return a < b;
 #endif
+      });
 
       if constexpr (transfer == NoTransfer)
       {
@@ -793,13 +1138,36 @@ namespace verona::rt
           Cown::acquire(sort[i]);
       }
 
-      auto body = MultiMessage::make_body(alloc, count, sort, be);
+      return sort;
+    }
 
-      // TODO what if this thread is external.
-      //  EPOCH_A okay as currently only sending externally, before we start
-      //  and thus its okay.
-      //  Need to use another value when we add pinned cowns.
+    /**
+     * Send a behaviour to the cowns in `sort`, which must come from
+     * `sort_cowns`. Takes ownership of `sort`, `be`, and the reference count
+     * held by `sort` on each cown.
+     **/
+    static void schedule_sorted(
+      Alloc* alloc,
+      size_t count,
+      Cown** sort,
+      Behaviour* be,
+      Expiry expiry = {})
+    {
       auto sched = Scheduler::local();
+
+      // A thread outside the runtime cannot take part in the leak detector,
+      // so it hands the behaviour to a scheduler thread to send.
+      if ((sched == nullptr) && Scheduler::can_inject())
+      {
+        Scheduler::inbox()->inject(alloc, count, sort, be, expiry);
+        return;
+      }
+
+      auto body = MultiMessage::make_body(alloc, count, sort, be, expiry);
+
+      // Outside the runtime, this is only reached before the scheduler threads
+      // start or after they have been torn down, when no leak detection is
+      // running, so EPOCH_A is as good as any.
       auto epoch = sched == nullptr ? EpochMark::EPOCH_A : Scheduler::epoch();
 
       if (epoch == EpochMark::EPOCH_NONE)
@@ -815,6 +1183,58 @@ namespace verona::rt
       fast_send(body, epoch);
     }
 
+    /**
+     * Scan the cowns and closure of a behaviour that is about to be sent by
+     * something other than a running behaviour, if the leak detector is
+     * scanning. Nothing in the runtime refers to such a behaviour, so it must
+     * be scanned here, as it would have been if a behaviour had sent it.
+     **/
+    static void scan_unsent(
+      Alloc* alloc, size_t count, Cown** cowns, Behaviour* be)
+    {
+      if (!Scheduler::should_scan())
+        return;
+
+      VERONA_LOG() << "Scan unsent behaviour " << be << std::endl;
+
+      ObjectStack f(alloc);
+      f.push_many(cowns, count);
+      be->trace(f);
+      scan_stack(alloc, Scheduler::local()->send_epoch, f);
+
+      // The scan may have found cowns not yet scanned in this epoch.
+      Scheduler::local()->scheduled_unscanned_cown = true;
+    }
+
+    /**
+     * Send a behaviour that was injected from outside the runtime, on the
+     * scheduler thread that received it.
+     **/
+    static void schedule_injected(
+      Alloc* alloc, size_t count, Cown** sort, Behaviour* be, Expiry expiry)
+    {
+      scan_unsent(alloc, count, sort, be);
+      schedule_sorted(alloc, count, sort, be, expiry);
+    }
+
+    /**
+     * Drop a behaviour that was prepared with `sort_cowns` but will never be
+     * sent. The behaviour is not run, but its destructor is, so that it can
+     * release any state it owns. The reference counts held by `sort` are
+     * released.
+     **/
+    static void
+    release_unsent(Alloc* alloc, size_t count, Cown** sort, Behaviour* be)
+    {
+      be->destructor();
+      alloc->dealloc(be, be->size());
+
+      for (size_t i = 0; i < count; i++)
+        Cown::release(alloc, sort[i]);
+      alloc->dealloc(sort, count * sizeof(Cown*));
+    }
+
+  public:
     /// Transition a cown between backpressure states. Return the previous
     /// state. An attempt to set the state to Normal may be preempted by
     /// another thread setting the cown to any state that isn't Muted. Normal
@@ -846,12 +1266,24 @@ namespace verona::rt
         !bp_state.compare_exchange_weak(
           bp, blocker | state, std::memory_order_acq_rel));
 
-      Systematic::cout() << "Cown " << this << ": backpressure state " << prev
-                         << " -> " << state << std::endl;
+      VERONA_LOG() << "Cown " << this << ": backpressure state " << prev
+                   << " -> " << state << std::endl;
       yield();
 
+      if ((state == Priority::Normal) && (prev != Priority::Normal))
+        Scheduler::mutor_released(this);
+
       if (prev == Priority::Low)
       {
+        VERONA_LOG() << "Cown " << this << ": unmuted" << std::endl;
+        Trace::record(Trace::Unmute, this);
+        const auto muted = Aal::tick() - mute_tsc;
+        muted_total.store(
+          muted_total.load(std::memory_order_relaxed) + muted,
+          std::memory_order_relaxed);
+        auto* local = Scheduler::local();
+        if (local != nullptr)
+          local->stats.unmute(muted);
         auto sleeping = queue.wake();
         UNUSED(sleeping);
         assert(!sleeping);
@@ -868,11 +1300,24 @@ namespace verona::rt
       UNUSED(epoch);
       for (; cown != nullptr; cown = cown->blocker())
       {
-        Systematic::cout() << "Unblock cown " << cown << std::endl;
+        VERONA_LOG() << "Unblock cown " << cown << std::endl;
         cown->backpressure_transition(Priority::High);
       }
     }
 
+    /// Return the number of times this cown has been muted.
+    uint32_t times_muted() const
+    {
+      return mute_count.load(std::memory_order_relaxed);
+    }
+
+    /// Return the total number of ticks this cown has spent muted, not
+    /// counting the time since it was last muted if it still is.
+    uint64_t muted_ticks() const
+    {
+      return muted_total.load(std::memory_order_relaxed);
+    }
+
     inline Priority priority(Cown** blocker = nullptr) const
     {
       const auto bp = bp_state.load(std::memory_order_acquire);
@@ -912,7 +1357,22 @@ namespace verona::rt
       auto p = priority();
       auto sleeping = queue.is_sleeping();
       yield();
-      return (p != Priority::Normal) && !sleeping;
+      return ((p != Priority::Normal) && !sleeping) || queue_full();
+    }
+
+    /// Publish a number of messages taken out of this cown's queue by the
+    /// thread running it. Only bounded queues are counted.
+    inline void record_dequeues(size_t count)
+    {
+      if ((queue_capacity == 0) || (count == 0))
+        return;
+
+      const auto was_full = queue_full();
+      dequeue_count.fetch_add(count, std::memory_order_release);
+
+      // Senders muted by this cown may have been waiting on the queue length.
+      if (was_full && !queue_full())
+        Scheduler::mutor_released(this);
     }
 
     /// Set the `mutor` field of the current scheduler thread if the senders
@@ -961,15 +1421,17 @@ namespace verona::rt
       yield();
       if (curr == nullptr)
       {
-        Systematic::cout() << "Reached message token on cown " << this
-                           << std::endl;
+        VERONA_LOG() << "Reached message token on cown " << this << std::endl;
         assert(stat.has_token());
         stat.set_has_token(false);
         status.store(stat, std::memory_order_release);
 
         auto p = priority();
-        if (stat.overloaded())
+        if (stat.overloaded() || queue_full())
+        {
+          Scheduler::local()->stats.overloaded(id(), stat.total_load());
           backpressure_unblock(this);
+        }
         else if (p == Priority::High)
           backpressure_transition(Priority::MaybeHigh);
         else if (p == Priority::MaybeHigh)
@@ -986,8 +1448,8 @@ namespace verona::rt
       }
       if (!stat.has_token())
       {
-        Systematic::cout() << "Cown " << this << ": enqueue message token"
-                           << std::endl;
+        VERONA_LOG() << "Cown " << this << ": enqueue message token"
+                     << std::endl;
         queue.enqueue(stub_msg(alloc));
       }
       stat.inc_load();
@@ -1045,8 +1507,8 @@ namespace verona::rt
       // The batch limit is between 100 and 251, depending on the load.
       const auto batch_limit = (size_t)100 | ((size_t)stat.total_load() >> 3);
 
-      Systematic::cout() << "Cown " << this << " load: " << stat.total_load()
-                         << std::endl;
+      VERONA_LOG() << "Cown " << this << " load: " << stat.total_load()
+                   << std::endl;
 
       auto notified_called = false;
       auto notify = false;
@@ -1096,7 +1558,10 @@ namespace verona::rt
           //
           // TODO: Investigate systematic testing coverage here.
           if (batch_size != 0)
+          {
+            record_dequeues(batch_size);
             return true;
+          }
 
           backpressure_transition(Priority::Normal, true);
 
@@ -1113,8 +1578,13 @@ namespace verona::rt
             return true;
           }
 
-          Systematic::cout()
-            << "Cown " << this << " has no work this time" << std::endl;
+          // A sleeping cown no longer triggers muting. If it has been raised
+          // above Normal since the transition above, signal this separately.
+          if (priority() != Priority::Normal)
+            Scheduler::mutor_released(this);
+
+          VERONA_LOG() << "Cown " << this << " has no work this time"
+                       << std::endl;
 
           // Deschedule the cown.
           Cown::release(alloc, this);
@@ -1124,12 +1594,21 @@ namespace verona::rt
         assert(!queue.is_sleeping());
 
         if (check_message_token(alloc, curr->get_body()))
+        {
+          record_dequeues(batch_size);
           return true;
+        }
 
         batch_size++;
 
-        Systematic::cout() << "Running Message " << curr << " on cown " << this
-                           << std::endl;
+        if (curr->get_body()->expired())
+        {
+          drop_step(curr);
+          continue;
+        }
+
+        VERONA_LOG() << "Running Message " << curr << " on cown " << this
+                     << std::endl;
 
         auto* senders = curr->get_body()->cowns;
         const size_t senders_count = curr->get_body()->count;
@@ -1138,10 +1617,16 @@ namespace verona::rt
         // be rescheduled, even if it has pending work. This also means the
         // cown's queue should not be marked as empty, even if it is.
         if (!run_step(curr))
+        {
+          record_dequeues(batch_size);
           return false;
+        }
 
         if (apply_backpressure(senders, senders_count))
+        {
+          record_dequeues(batch_size);
           return false;
+        }
 
         // Reschedule the other cowns.
         for (size_t s = 0; s < (senders_count - 1); s++)
@@ -1151,18 +1636,19 @@ namespace verona::rt
 
       } while ((curr != until) && (batch_size < batch_limit));
 
+      record_dequeues(batch_size);
       return true;
     }
 
     bool try_collect(Alloc* alloc, EpochMark epoch)
     {
-      Systematic::cout() << "try_collect: " << this << " (" << get_epoch_mark()
-                         << ")" << std::endl;
+      VERONA_LOG() << "try_collect: " << this << " (" << get_epoch_mark() << ")"
+                   << std::endl;
 
       if (in_epoch(EpochMark::SCHEDULED_FOR_SCAN))
       {
-        Systematic::cout() << "Clearing SCHEDULED_FOR_SCAN state: " << this
-                           << std::endl;
+        VERONA_LOG() << "Clearing SCHEDULED_FOR_SCAN state: " << this
+                     << std::endl;
         // There is a race, when multiple threads may attempt to
         // schedule a Cown for tracing.  In this case, we can
         // get a stale descriptor mark. Update it here, for the
@@ -1179,7 +1665,7 @@ namespace verona::rt
       {
         yield();
         assert(priority() != Priority::Low);
-        Systematic::cout() << "Collecting (sweep) cown " << this << std::endl;
+        VERONA_LOG() << "Collecting (sweep) cown " << this << std::endl;
         collect(alloc);
       }
 
@@ -1235,11 +1721,12 @@ namespace verona::rt
         return;
 
       mark_collected();
+      Scheduler::mutor_released(this);
 
 #ifdef USE_SYSTEMATIC_TESTING_WEAK_NOTICEBOARDS
       flush_all(alloc);
 #endif
-      Systematic::cout() << "Collecting cown " << this << std::endl;
+      VERONA_LOG() << "Collecting cown " << this << std::endl;
 
       ObjectStack dummy(alloc);
       // Run finaliser before releasing our data.
@@ -1266,8 +1753,7 @@ namespace verona::rt
             break;
 
           case RegionMD::COWN:
-            Systematic::cout()
-              << "DecRef from " << this << " to " << o << std::endl;
+            VERONA_LOG() << "DecRef from " << this << " to " << o << std::endl;
             Cown::release(alloc, (Cown*)o);
             break;
 
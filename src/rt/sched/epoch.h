@@ -6,6 +6,7 @@
 #include "../ds/queue.h"
 #include "../test/systematic.h"
 #include "region/immutable.h"
+#include "trace.h"
 
 #include <snmalloc.h>
 
@@ -60,6 +61,7 @@ namespace verona::rt
       auto global_e = get();
       global_e = inc_epoch_by(global_e, 3);
       set(global_e);
+      Trace::record(Trace::EpochAdvance, global_e);
     }
   };
 
@@ -179,7 +181,7 @@ namespace verona::rt
           auto dn = (DecNode*)dec_list.dequeue();
           auto o = dn->o;
           alloc->dealloc<sizeof(DecNode)>(dn);
-          Systematic::cout() << "Delayed decref on " << o << std::endl;
+          VERONA_LOG() << "Delayed decref on " << o << std::endl;
           Immutable::release(alloc, o);
         }
 
@@ -283,7 +285,7 @@ namespace verona::rt
       {
         if (!not_in_epoch(o, e))
         {
-          Systematic::cout() << "Ejecting other thread" << std::endl;
+          VERONA_LOG() << "Ejecting other thread" << std::endl;
           o->eject();
         }
 
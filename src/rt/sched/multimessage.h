@@ -5,6 +5,7 @@
 #include "../ds/mpscq.h"
 #include "../object/object.h"
 #include "behaviour.h"
+#include "cancellation.h"
 
 #include <snmalloc.h>
 
@@ -20,7 +21,24 @@ namespace verona::rt
       size_t count;
       Cown** cowns;
       Behaviour* behaviour;
-    };
+      /// Deadline in nanoseconds of `Expiry::Clock`, or zero for none.
+      uint64_t deadline;
+      /// Owned reference, or nullptr.
+      CancellationToken* token;
+
+      /**
+       * Returns true if the behaviour should be dropped rather than run. This
+       * is checked each time the message reaches the front of a queue, so the
+       * common case of no expiry must stay a pair of loads.
+       */
+      inline bool expired()
+      {
+        if (likely((deadline == 0) && (token == nullptr)))
+          return false;
+
+        return ((token != nullptr) && token->is_cancelled()) ||
+          ((deadline != 0) && (Expiry::now() > deadline));
+      }
 
   private:
     MultiMessageBody* body;
@@ -59,27 +77,43 @@ namespace verona::rt
         (e == EpochMark::EPOCH_NONE) || (e == EpochMark::EPOCH_A) ||
         (e == EpochMark::EPOCH_B));
 
-      Systematic::cout() << "MultiMessage epoch: " << this << " " << get_epoch()
-                         << " -> " << e << std::endl;
+      VERONA_LOG() << "MultiMessage epoch: " << this << " " << get_epoch()
+                   << " -> " << e << std::endl;
 
       body = (MultiMessageBody*)((uintptr_t)get_body() | (size_t)e);
 
       assert(get_epoch() == e);
     }
 
-    static MultiMessageBody*
-    make_body(Alloc* alloc, size_t count, Cown** cowns, Behaviour* behaviour)
+    static MultiMessageBody* make_body(
+      Alloc* alloc,
+      size_t count,
+      Cown** cowns,
+      Behaviour* behaviour,
+      Expiry expiry = {})
     {
-      return new (alloc->alloc<sizeof(MultiMessageBody)>())
-        MultiMessageBody{0, count, cowns, behaviour};
+      if (expiry.token != nullptr)
+        expiry.token->acquire();
+
+      return new (alloc->alloc<sizeof(MultiMessageBody)>()) MultiMessageBody{
+        0, count, cowns, behaviour, expiry.deadline, expiry.token};
+    }
+
+    /// Free a body once its behaviour has been run or dropped.
+    static void dealloc_body(Alloc* alloc, MultiMessageBody* body)
+    {
+      if (body->token != nullptr)
+        body->token->release(alloc);
+
+      alloc->dealloc<sizeof(MultiMessageBody)>(body);
     }
 
     static MultiMessage*
     make_message(Alloc* alloc, MultiMessageBody* body, EpochMark epoch)
     {
       MultiMessage* m = make(alloc, epoch, body);
-      Systematic::cout() << "MultiMessage " << m << " payload " << body << " ("
-                         << epoch << ")" << std::endl;
+      VERONA_LOG() << "MultiMessage " << m << " payload " << body << " ("
+                   << epoch << ")" << std::endl;
       return m;
     }
 
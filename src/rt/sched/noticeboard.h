@@ -58,9 +58,8 @@ namespace verona::rt
       {
         Epoch e(alloc);
         auto local_content = get<T>();
-        Systematic::cout() << "Updating noticeboard " << this << " old value "
-                           << local_content << " new value " << new_o
-                           << std::endl;
+        VERONA_LOG() << "Updating noticeboard " << this << " old value "
+                     << local_content << " new value " << new_o << std::endl;
         e.dec_in_epoch(local_content);
         put(new_o);
       }
@@ -86,8 +85,8 @@ namespace verona::rt
           // only protect incref with epoch
           Epoch e(alloc);
           local_content = get<T>();
-          Systematic::cout()
-            << "Inc ref from noticeboard peek" << local_content << std::endl;
+          VERONA_LOG() << "Inc ref from noticeboard peek" << local_content
+                       << std::endl;
           local_content->incref();
         }
         // It's possible that the following three things happen:
@@ -99,8 +98,8 @@ namespace verona::rt
         // to be scanned.
         if (Scheduler::should_scan())
         {
-          Systematic::cout()
-            << "Scan from noticeboard peek" << local_content << std::endl;
+          VERONA_LOG() << "Scan from noticeboard peek" << local_content
+                       << std::endl;
           ObjectStack f(alloc);
           local_content->trace(f);
           Cown::scan_stack(alloc, Scheduler::epoch(), f);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <snmalloc.h>
 
@@ -16,6 +17,24 @@ namespace verona::rt
     size_t pause_count = 0;
     std::atomic<size_t> unpause_count = 0;
     std::atomic<size_t> lifo_count = 0;
+    size_t mute_count = 0;
+    size_t unmute_count = 0;
+    size_t drop_count = 0;
+
+    /// Histogram of the time cowns spend muted, bucketed by the log2 of the
+    /// duration in ticks.
+    static constexpr size_t MUTED_BUCKETS = 48;
+    size_t muted_ticks[MUTED_BUCKETS] = {};
+
+    /// The most heavily loaded cowns observed while overloaded, ordered by
+    /// decreasing load.
+    static constexpr size_t TOP_OVERLOADED = 8;
+    struct Overload
+    {
+      uintptr_t cown = 0;
+      uint32_t load = 0;
+    };
+    Overload top_overloaded[TOP_OVERLOADED] = {};
 #endif
 
   public:
@@ -67,6 +86,60 @@ namespace verona::rt
 #endif
     }
 
+    void mute()
+    {
+#ifdef USE_SCHED_STATS
+      mute_count++;
+#endif
+    }
+
+    /// Record a behaviour dropped because it expired before running.
+    void drop()
+    {
+#ifdef USE_SCHED_STATS
+      drop_count++;
+#endif
+    }
+
+    /// Record a cown leaving the muted state after `ticks` ticks.
+    void unmute(uint64_t ticks)
+    {
+      UNUSED(ticks);
+
+#ifdef USE_SCHED_STATS
+      unmute_count++;
+      size_t bucket = (ticks == 0) ? 0 : (64 - bits::clz(ticks));
+      muted_ticks[(std::min)(bucket, MUTED_BUCKETS - 1)]++;
+#endif
+    }
+
+    /// Record that the cown identified by `cown` is overloaded with the given
+    /// load.
+    void overloaded(uintptr_t cown, uint32_t load)
+    {
+      UNUSED(cown);
+      UNUSED(load);
+
+#ifdef USE_SCHED_STATS
+      size_t i = 0;
+      for (; i < TOP_OVERLOADED - 1; i++)
+      {
+        if (top_overloaded[i].cown == cown)
+          break;
+      }
+
+      if (top_overloaded[i].load >= load)
+        return;
+
+      // Shift lighter entries down, overwriting the previous entry for this
+      // cown, or the lightest entry if the cown was not present.
+      for (; (i > 0) && (top_overloaded[i - 1].load < load); i--)
+        top_overloaded[i] = top_overloaded[i - 1];
+
+      top_overloaded[i] = {cown, load};
+#endif
+    }
+
     void add(SchedulerStats& that)
     {
       UNUSED(that);
@@ -76,6 +149,18 @@ namespace verona::rt
       pause_count += that.pause_count;
       unpause_count += that.unpause_count;
       lifo_count += that.lifo_count;
+      mute_count += that.mute_count;
+      unmute_count += that.unmute_count;
+      drop_count += that.drop_count;
+
+      for (size_t i = 0; i < MUTED_BUCKETS; i++)
+        muted_ticks[i] += that.muted_ticks[i];
+
+      for (auto& o : that.top_overloaded)
+      {
+        if (o.cown != 0)
+          overloaded(o.cown, o.load);
+      }
 #endif
     }
 
@@ -96,11 +181,28 @@ namespace verona::rt
             << "Steal"
             << "LIFO"
             << "Pause"
-            << "Unpause" << csv.endl;
+            << "Unpause"
+            << "Mute"
+            << "Unmute"
+            << "Drop" << csv.endl;
       }
 
       csv << "SchedulerStats" << dumpid << steal_count << lifo_count
-          << pause_count << unpause_count << csv.endl;
+          << pause_count << unpause_count << mute_count << unmute_count
+          << drop_count << csv.endl;
+
+      // Muted durations, one column per power of two ticks.
+      csv << "MutedTicksLog2" << dumpid;
+      for (auto count : muted_ticks)
+        csv << count;
+      csv << csv.endl;
+
+      for (auto& o : top_overloaded)
+      {
+        if (o.cown == 0)
+          break;
+        csv << "Overloaded" << dumpid << o.cown << o.load << csv.endl;
+      }
 #endif
     }
   };
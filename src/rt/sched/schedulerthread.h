@@ -2,15 +2,20 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 
+#include "behaviour.h"
+#include "cancellation.h"
 #include "cpu.h"
 #include "ds/hashmap.h"
 #include "ds/mpscq.h"
 #include "object/object.h"
 #include "schedulerstats.h"
+#include "scratch.h"
 #include "spmcq.h"
 #include "status.h"
 #include "threadpool.h"
+#include "trace.h"
 
+#include <memory>
 #include <snmalloc.h>
 #include <thread>
 
@@ -36,6 +41,9 @@ namespace verona::rt
     /// Friendly thread identifier for logging information.
     size_t systematic_id = 0;
     size_t systematic_speed_mask = 1;
+    /// Position in the ring of scheduler threads, starting from zero. Threads
+    /// at or beyond `Scheduler::get_thread_count()` are retired.
+    size_t index = 0;
 
   private:
     using Scheduler = ThreadPool<SchedulerThread<T>>;
@@ -53,6 +61,8 @@ namespace verona::rt
     friend class Noticeboard;
 
     static constexpr uint64_t TSC_QUIESCENCE_TIMEOUT = 1'000'000;
+    /// Maximum number of injected behaviours sent between running cowns.
+    static constexpr size_t INBOX_BATCH = 64;
 
     T* token_cown = nullptr;
 
@@ -64,6 +74,37 @@ namespace verona::rt
 #endif
 
     SPMCQ<T> q;
+    /// Cowns pinned to this thread. Only this thread dequeues from it, so the
+    /// cowns in it are never stolen. Like `q`, it always holds a token, which
+    /// is moved to the back whenever it reaches the front.
+    T* pinned_token = nullptr;
+    SPMCQ<T> pinned_q;
+    /// Alternates between taking work from `q` and `pinned_q` first.
+    bool prefer_pinned = false;
+
+    /**
+     * A behaviour scheduled from a thread outside the runtime, waiting for
+     * this thread to send it to its cowns. Like a message, the entry returned
+     * by the inbox becomes its stub, and is deallocated by the next dequeue.
+     */
+    struct Injected
+    {
+      std::atomic<Injected*> next{nullptr};
+      size_t count;
+      T** cowns;
+      Behaviour* behaviour;
+      Expiry expiry;
+
+      size_t size()
+      {
+        return sizeof(Injected);
+      }
+    };
+
+    /// Behaviours injected from outside the runtime. Any thread may enqueue,
+    /// only this thread dequeues. The queue is marked sleeping before this
+    /// thread pauses, so that the next injection knows to wake it.
+    MPSCQ<Injected> inbox;
     Alloc* alloc = nullptr;
     SchedulerThread<T>* next = nullptr;
     SchedulerThread<T>* victim = nullptr;
@@ -74,6 +115,8 @@ namespace verona::rt
     // `n_ld_tokens` indicates the times of token cown a scheduler has to
     // process before reaching its LD checkpoint (`n_ld_tokens == 0`).
     uint8_t n_ld_tokens = 0;
+    // The same for the token of `pinned_q`.
+    uint8_t n_pinned_ld_tokens = 0;
 
     // The cown queue is initialized with only the token (a cown) in.
     // Whenever the token is popped out, `token_consumed` is set to `true`,
@@ -94,12 +137,41 @@ namespace verona::rt
     std::thread t;
     ThreadState::State state = ThreadState::State::NotInLD;
     SchedulerStats stats;
+    /// Temporary memory for the behaviour currently running on this thread.
+    Scratch scratch;
 
     T* list = nullptr;
     size_t total_cowns = 0;
     std::atomic<size_t> free_cowns = 0;
 
-    ObjectMap<std::pair<T*, ObjectMap<T*>*>> mute_map;
+    using MuteMap = ObjectMap<std::pair<T*, ObjectMap<T*>*>>;
+    MuteMap mute_map;
+    /// Mutors whose mute sets have been added since the last mute map scan.
+    /// They may have been released before their sets were added, so the next
+    /// `mute_map_scan` checks them even if no mutor has been released since.
+    StackThin<T, Alloc> fresh_mutors;
+    /// Value of `Scheduler::mutor_release_count()` at the last mute map scan.
+    size_t mutor_releases_seen = 0;
+    /// Value of `Scheduler::unlogged_mutor_release_count()` at the last mute
+    /// map scan.
+    size_t unlogged_mutor_releases_seen = 0;
+    /// Set when a mutor is released on this thread, until the release is
+    /// published by `Scheduler::flush_mutor_releases`.
+    bool mutor_release_pending = false;
+
+    static constexpr size_t RELEASED_MUTOR_SLOTS = 64;
+    /// Ring of the mutors most recently released on this thread, read by the
+    /// mute map scans of all threads so that they only visit the mute sets of
+    /// released mutors. Only this thread writes to it. `released_mutor_head`
+    /// counts the mutors logged so far, and `released_mutor_reserved` is
+    /// advanced before a slot is overwritten, so that readers that fell behind
+    /// can detect it. See `log_mutor_release` and `collect_released_mutors`.
+    std::atomic<T*> released_mutors[RELEASED_MUTOR_SLOTS] = {};
+    std::atomic<size_t> released_mutor_head{0};
+    std::atomic<size_t> released_mutor_reserved{0};
+    /// Number of entries of each thread's ring of released mutors, by thread
+    /// index, that have been seen by this thread's mute map scans.
+    std::unique_ptr<size_t[]> released_mutors_seen;
     typename T::MessageBody* message_body = nullptr;
     T* mutor = nullptr;
 
@@ -112,9 +184,12 @@ namespace verona::rt
     SchedulerThread()
     : token_cown{T::create_token_cown()},
       q{token_cown},
+      pinned_token{T::create_token_cown()},
+      pinned_q{pinned_token},
       mute_map{ThreadAlloc::get()}
     {
       token_cown->set_owning_thread(this);
+      inbox.init(new (ThreadAlloc::get()->alloc<sizeof(Injected)>()) Injected);
     }
 
     ~SchedulerThread()
@@ -123,6 +198,7 @@ namespace verona::rt
         t.join();
 
       assert(mute_map.size() == 0);
+      assert(fresh_mutors.empty());
     }
 
     template<typename... Args>
@@ -137,19 +213,69 @@ namespace verona::rt
       running = false;
     }
 
+    bool is_retired()
+    {
+      return index >=
+        Scheduler::get().enabled_thread_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Hand the work of a retired thread to the enabled threads: the unpinned
+     * cown it was about to run, if any, and the contents of its queue. Only
+     * the token is left in the queue. Cowns pinned to this thread stay here.
+     */
+    void retire_work(T*& cown)
+    {
+      should_steal_for_fairness = false;
+
+      if ((cown != nullptr) && (cown->pinned_thread() == nullptr))
+      {
+        Scheduler::round_robin()->schedule_lifo(cown);
+        cown = nullptr;
+      }
+
+      bool handed_off = false;
+      T* c;
+      while ((c = q.dequeue(alloc)) != nullptr)
+      {
+        // Reaching the token marks it consumed, so that it is put back.
+        if (has_thread_bit(c))
+        {
+          prerun(c);
+          continue;
+        }
+
+        VERONA_LOG() << "Retired thread hands off cown " << c << std::endl;
+        Scheduler::round_robin()->schedule_lifo(c);
+        handed_off = true;
+      }
+
+      // The enabled threads may all be asleep.
+      if (handed_off && Scheduler::get().unpause(true))
+        stats.unpause();
+    }
+
     inline void schedule_fifo(T* a)
     {
-      Systematic::cout() << "Enqueue cown " << a << " (" << a->get_epoch_mark()
-                         << ")" << std::endl;
+      // A pinned cown must not be left where other threads can steal it.
+      if (a->pinned_thread() != nullptr)
+      {
+        a->pinned_thread()->schedule_pinned(a);
+        return;
+      }
+
+      VERONA_LOG() << "Enqueue cown " << a << " (" << a->get_epoch_mark() << ")"
+                   << std::endl;
 
       // Scheduling on this thread, from this thread.
       if (!a->scanned(send_epoch))
       {
-        Systematic::cout() << "Enqueue unscanned cown " << a << std::endl;
+        VERONA_LOG() << "Enqueue unscanned cown " << a << std::endl;
         scheduled_unscanned_cown = true;
       }
       assert(!a->queue.is_sleeping());
       q.enqueue(alloc, a);
+      Trace::record(Trace::CownScheduled, a);
 
       // Put the token back if it has been stolen.  This will help
       // free up more work for other threads to steal.
@@ -159,13 +285,120 @@ namespace verona::rt
         stats.unpause();
     }
 
+    /**
+     * Schedule a cown that is pinned to this thread. This may be called from
+     * any thread.
+     */
+    inline void schedule_pinned(T* a)
+    {
+      assert(a->pinned_thread() == this);
+      VERONA_LOG() << "Enqueue pinned cown " << a << " on " << systematic_id
+                   << std::endl;
+
+      // This thread's `send_epoch` may be changing concurrently, so the cown
+      // is checked against the epoch of the scheduling thread. This thread
+      // checks it again when it dequeues the cown.
+      auto* local = Scheduler::local();
+      if ((local != nullptr) && !a->scanned(local->send_epoch))
+        local->scheduled_unscanned_cown = true;
+
+      if (local == this)
+      {
+        pinned_q.enqueue(alloc, a);
+      }
+      else
+      {
+        pinned_q.enqueue_front(ThreadAlloc::get(), a);
+        stats.lifo();
+      }
+      Trace::record(Trace::CownScheduled, a);
+
+      // Only this thread can run the cown, so it must be woken even if other
+      // threads have been woken recently, or if it is retired.
+      if (Scheduler::get().unpause(local != this, is_retired()))
+        stats.unpause();
+    }
+
+    /**
+     * Queue a behaviour, prepared by `T::sort_cowns`, to be sent by this
+     * thread. Called from threads outside the runtime, which cannot send it
+     * themselves as they take no part in the leak detector.
+     */
+    void inject(
+      Alloc* a, size_t count, T** cowns, Behaviour* behaviour, Expiry expiry)
+    {
+      // The caller may release its reference to the token as soon as this
+      // returns.
+      if (expiry.token != nullptr)
+        expiry.token->acquire();
+
+      auto* i = new (a->alloc<sizeof(Injected)>()) Injected;
+      i->count = count;
+      i->cowns = cowns;
+      i->behaviour = behaviour;
+      i->expiry = expiry;
+
+      VERONA_LOG() << "Inject behaviour " << behaviour << " into "
+                   << systematic_id << std::endl;
+
+      // Only wake the threads if this one may be about to pause.
+      if (inbox.enqueue(i))
+        Scheduler::get().unpause(true, is_retired());
+    }
+
+    /// Send behaviours injected into this thread's inbox.
+    void drain_inbox()
+    {
+      for (size_t n = 0; n < INBOX_BATCH; n++)
+      {
+        auto* i = inbox.dequeue(alloc);
+        if (i == nullptr)
+          return;
+
+        VERONA_LOG() << "Send injected behaviour " << i->behaviour
+                     << std::endl;
+        T::schedule_injected(
+          alloc, i->count, i->cowns, i->behaviour, i->expiry);
+
+        if (i->expiry.token != nullptr)
+          i->expiry.token->release(alloc);
+      }
+    }
+
+    /**
+     * Mark the inbox as sleeping, before this thread pauses. Returns false if
+     * something has been injected since it was last drained.
+     */
+    bool inbox_sleep()
+    {
+      if (inbox.is_sleeping())
+        return true;
+
+      bool notify = false;
+      return inbox.mark_sleeping(notify);
+    }
+
+    /// May be called from any thread.
+    bool has_injected()
+    {
+      return !inbox.is_sleeping();
+    }
+
+    /// Returns true if this thread has any work waiting for it. May be called
+    /// from any thread, so only reliable while this thread is paused.
+    bool has_work()
+    {
+      return !q.is_empty() || !pinned_q.is_empty() || has_injected();
+    }
+
     inline void schedule_lifo(T* a)
     {
       // A lifo scheduled cown is coming from an external source, such as
       // asynchronous I/O.
-      Systematic::cout() << "LIFO schedule cown " << a << std::endl;
+      VERONA_LOG() << "LIFO schedule cown " << a << std::endl;
 
       q.enqueue_front(ThreadAlloc::get(), a);
+      Trace::record(Trace::CownScheduled, a);
       stats.lifo();
 
       if (Scheduler::get().unpause())
@@ -176,8 +409,8 @@ namespace verona::rt
     {
       if (is_token_consumed())
       {
-        Systematic::cout() << "Put token " << get_token_cown()
-                           << " in scheduler queue." << std::endl;
+        VERONA_LOG() << "Put token " << get_token_cown()
+                     << " in scheduler queue." << std::endl;
         if (n_ld_tokens > 0)
         {
           dec_n_ld_tokens();
@@ -187,7 +420,7 @@ namespace verona::rt
 
         if (Scheduler::get().fair)
         {
-          Systematic::cout() << "Should steal for fairness!" << std::endl;
+          VERONA_LOG() << "Should steal for fairness!" << std::endl;
           should_steal_for_fairness = true;
         }
       }
@@ -206,6 +439,7 @@ namespace verona::rt
       {
         auto* set = ObjectMap<T*>::create(alloc);
         it = mute_map.insert(alloc, std::make_pair(mutor, set)).second;
+        fresh_mutors.push(mutor, alloc);
       }
       else
       {
@@ -239,6 +473,10 @@ namespace verona::rt
         if (ins.first)
           T::acquire(cown);
 
+        // Written before the transition to Low, which publishes it to the
+        // thread that eventually unmutes this cown.
+        cown->mute_tsc = Aal::tick();
+
         if (
 #ifdef USE_SYSTEMATIC_TESTING
           Systematic::coin(9) ||
@@ -255,9 +493,14 @@ namespace verona::rt
 
           continue;
         }
-        Systematic::cout() << "Cown " << cown << ": backpressure state " << bp
-                           << " -> Low" << std::endl;
+        VERONA_LOG() << "Cown " << cown << ": backpressure state " << bp
+                     << " -> Low, muted by " << mutor << std::endl;
         assert(!(p & PriorityMask::High));
+        cown->mute_count.store(
+          cown->mute_count.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+        stats.mute();
+        Trace::record(Trace::Mute, cown);
       }
 
       alloc->dealloc(cowns, count * sizeof(T*));
@@ -267,55 +510,177 @@ namespace verona::rt
      * Unmute all mute sets where the mutor is in a state that triggers
      * unmuting. If `force` is true, then all mute sets in the map will be
      * unmuted.
+     *
+     * Unless forced, only the entries of mutors released since the last scan,
+     * as signalled through `Scheduler::mutor_released`, and of mutors whose
+     * mute sets have been added since then are visited. The whole map is only
+     * scanned if some releases were not logged or may have been missed.
      */
     void mute_map_scan(bool force = false)
     {
-      // Scan the mute map, removing entries where the key no longer triggers
-      // muting. Rescan while unmuted cowns are also keys in the map since their
-      // entries become invalid as well.
-      bool scan_again = true;
-      while (scan_again)
+      Scheduler::flush_mutor_releases();
+
+      if (mute_map.size() == 0)
+        return;
+
+      const auto released = Scheduler::mutor_release_count();
+      if (!force && fresh_mutors.empty() && (released == mutor_releases_seen))
+        return;
+
+      mutor_releases_seen = released;
+
+      // Mutors whose entries should be checked are collected in `chained`,
+      // along with unmuted cowns that are also keys in the map, so that only
+      // their entries are visited.
+      Stack<T, Alloc> chained(alloc);
+      while (!fresh_mutors.empty())
+        chained.push(fresh_mutors.pop(alloc));
+
+      if (!collect_released_mutors(chained) || force)
       {
-        scan_again = false;
+        // Scan the whole map, removing entries where the key no longer
+        // triggers muting.
         for (auto entry = mute_map.begin(); entry != mute_map.end(); ++entry)
         {
           auto* m = entry.key();
-          auto& mute_set = *entry.value();
           if (force || !m->triggers_muting() || m->is_collected())
           {
             yield();
-            for (auto it = mute_set.begin(); it != mute_set.end(); ++it)
-            {
-              assert(m != it.key());
-              Systematic::cout()
-                << "Mute map remove cown " << it.key() << std::endl;
-              it.key()->backpressure_transition(Priority::Normal);
-              T::release(alloc, it.key());
-
-              if (!force && !scan_again)
-                scan_again = (mute_map.find(it.key()) != mute_map.end());
-
-              mute_set.erase(it);
-            }
-            m->weak_release(alloc);
-            mute_map.erase(entry);
-            mute_set.dealloc(alloc);
-            alloc->dealloc<sizeof(ObjectMap<T*>)>(&mute_set);
+            unmute_set(entry, force ? nullptr : &chained);
           }
-          else if (mute_set.size() == 0)
+          else if (entry.value()->size() == 0)
           {
-            m->weak_release(alloc);
-            mute_map.erase(entry);
-            mute_set.dealloc(alloc);
-            alloc->dealloc<sizeof(ObjectMap<T*>)>(&mute_set);
+            erase_mute_set(entry);
           }
         }
       }
 
+      while (!chained.empty())
+      {
+        auto* m = chained.pop();
+        auto entry = mute_map.find(m);
+        // The entry may have already been removed, and the cown may still
+        // trigger muting despite being released or unmuted, for instance if it
+        // has been raised to High. The mutor is only dereferenced once found,
+        // as the entry holds a reference to it.
+        if (entry == mute_map.end())
+          continue;
+
+        if (!m->triggers_muting() || m->is_collected())
+        {
+          yield();
+          unmute_set(entry, &chained);
+        }
+        else if (entry.value()->size() == 0)
+        {
+          erase_mute_set(entry);
+        }
+      }
+
       if (mute_map.size() == 0)
         mute_map.clear(alloc);
     }
 
+    /**
+     * Log a mutor released on this thread, for the mute map scans of all
+     * threads, and note that the release must be published by
+     * `Scheduler::flush_mutor_releases`.
+     */
+    void log_mutor_release(T* m)
+    {
+      const auto i = released_mutor_head.load(std::memory_order_relaxed);
+      released_mutor_reserved.store(i + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      released_mutors[i % RELEASED_MUTOR_SLOTS].store(
+        m, std::memory_order_relaxed);
+      released_mutor_head.store(i + 1, std::memory_order_release);
+      mutor_release_pending = true;
+    }
+
+    /**
+     * Push the mutors logged by every thread since the last mute map scan onto
+     * `released`. Returns false if some releases may have been missed, because
+     * they were not logged or this thread fell too far behind a ring, in which
+     * case the whole mute map must be scanned.
+     */
+    bool collect_released_mutors(Stack<T, Alloc>& released)
+    {
+      bool complete = true;
+
+      const auto unlogged = Scheduler::unlogged_mutor_release_count();
+      if (unlogged != unlogged_mutor_releases_seen)
+      {
+        unlogged_mutor_releases_seen = unlogged;
+        complete = false;
+      }
+
+      auto* t = this;
+      do
+      {
+        auto& seen = released_mutors_seen[t->index];
+        const auto head =
+          t->released_mutor_head.load(std::memory_order_acquire);
+        if ((head - seen) > RELEASED_MUTOR_SLOTS)
+        {
+          complete = false;
+        }
+        else
+        {
+          for (auto i = seen; i != head; i++)
+            released.push(t->released_mutors[i % RELEASED_MUTOR_SLOTS].load(
+              std::memory_order_relaxed));
+
+          // The oldest slot read is overwritten once the writer reserves the
+          // entry a whole ring later.
+          std::atomic_thread_fence(std::memory_order_acquire);
+          const auto reserved =
+            t->released_mutor_reserved.load(std::memory_order_relaxed);
+          if (reserved > (seen + RELEASED_MUTOR_SLOTS))
+            complete = false;
+        }
+        seen = head;
+        t = t->next;
+      } while (t != this);
+
+      return complete;
+    }
+
+    /**
+     * Unmute all cowns in the mute set of the given mute map entry and remove
+     * the entry. Unmuted cowns that are themselves mutors in this map are
+     * pushed onto `chained`, if it is not null.
+     */
+    void unmute_set(typename MuteMap::Iterator& entry, Stack<T, Alloc>* chained)
+    {
+      auto& mute_set = *entry.value();
+      for (auto it = mute_set.begin(); it != mute_set.end(); ++it)
+      {
+        assert(entry.key() != it.key());
+        VERONA_LOG() << "Mute map remove cown " << it.key() << std::endl;
+        it.key()->backpressure_transition(Priority::Normal);
+
+        if ((chained != nullptr) && (mute_map.find(it.key()) != mute_map.end()))
+          chained->push(it.key());
+
+        T::release(alloc, it.key());
+        mute_set.erase(it);
+      }
+      erase_mute_set(entry);
+    }
+
+    /**
+     * Remove an entry from the mute map, releasing its mutor and deallocating
+     * its mute set.
+     */
+    void erase_mute_set(typename MuteMap::Iterator& entry)
+    {
+      auto& mute_set = *entry.value();
+      entry.key()->weak_release(alloc);
+      mute_map.erase(entry);
+      mute_set.dealloc(alloc);
+      alloc->dealloc<sizeof(ObjectMap<T*>)>(&mute_set);
+    }
+
     /**
      * Startup is supplied to initialise thread local state before the runtime
      * starts.
@@ -334,7 +699,11 @@ namespace verona::rt
 #endif
 
       Scheduler::local() = this;
+      Scratch::local() = &scratch;
       alloc = ThreadAlloc::get();
+      released_mutors_seen =
+        std::make_unique<size_t[]>(Scheduler::get().thread_count);
+      ObjectStack::BlockCache::enable();
       victim = next;
       T* cown = nullptr;
 
@@ -363,13 +732,20 @@ namespace verona::rt
 
         check_token_cown();
 
+        drain_inbox();
+
+        if (is_retired())
+          retire_work(cown);
+
         mute_map_scan();
 
         if (cown == nullptr)
         {
-          cown = q.dequeue(alloc);
+          cown = dequeue();
           if (cown != nullptr)
-            Systematic::cout() << "Pop cown " << cown << std::endl;
+          {
+            VERONA_LOG() << "Pop cown " << cown << std::endl;
+          }
         }
 
         if (cown == nullptr)
@@ -388,8 +764,8 @@ namespace verona::rt
           continue;
         }
 
-        Systematic::cout() << "Schedule cown " << cown << " ("
-                           << cown->get_epoch_mark() << ")" << std::endl;
+        VERONA_LOG() << "Schedule cown " << cown << " ("
+                     << cown->get_epoch_mark() << ")" << std::endl;
 
         // This prevents the LD protocol advancing if this cown has not been
         // scanned. This catches various cases where we have stolen, or
@@ -400,13 +776,13 @@ namespace verona::rt
         // stealing, and running on same cown as previous loop.
         if (Scheduler::should_scan() && (cown->get_epoch_mark() != send_epoch))
         {
-          Systematic::cout() << "Unscanned cown next" << std::endl;
+          VERONA_LOG() << "Unscanned cown next" << std::endl;
           scheduled_unscanned_cown = true;
         }
 
         ld_protocol();
 
-        Systematic::cout() << "Running cown " << cown << std::endl;
+        VERONA_LOG() << "Running cown " << cown << std::endl;
 
         bool reschedule = cown->run(alloc, state, send_epoch);
 
@@ -424,7 +800,7 @@ namespace verona::rt
             // otherwise run this cown again. Don't push to the queue
             // immediately to avoid another thread stealing our only cown.
 
-            T* n = q.dequeue(alloc);
+            T* n = dequeue();
 
             if (n != nullptr)
             {
@@ -435,7 +811,7 @@ namespace verona::rt
             {
               if (q.is_empty())
               {
-                Systematic::cout() << "Queue empty" << std::endl;
+                VERONA_LOG() << "Queue empty" << std::endl;
                 // We have effectively reached token cown.
                 n_ld_tokens = 0;
 
@@ -449,16 +825,15 @@ namespace verona::rt
 
               if (!has_thread_bit(cown))
               {
-                Systematic::cout()
-                  << "Reschedule cown " << cown << " ("
-                  << cown->get_epoch_mark() << ")" << std::endl;
+                VERONA_LOG() << "Reschedule cown " << cown << " ("
+                             << cown->get_epoch_mark() << ")" << std::endl;
               }
             }
           }
         }
         else
         {
-          Systematic::cout() << "Unschedule cown " << cown << std::endl;
+          VERONA_LOG() << "Unschedule cown " << cown << std::endl;
           // Don't reschedule.
           cown = nullptr;
         }
@@ -470,7 +845,7 @@ namespace verona::rt
 
       assert(mute_map.size() == 0);
 
-      Systematic::cout() << "Begin teardown (phase 1)" << std::endl;
+      VERONA_LOG() << "Begin teardown (phase 1)" << std::endl;
 
       cown = list;
       while (cown != nullptr)
@@ -480,20 +855,65 @@ namespace verona::rt
         cown = cown->next;
       }
 
-      Systematic::cout() << "End teardown (phase 1)" << std::endl;
+      VERONA_LOG() << "End teardown (phase 1)" << std::endl;
 
       Epoch(ThreadAlloc::get()).flush_local();
       Scheduler::get().enter_barrier();
 
-      Systematic::cout() << "Begin teardown (phase 2)" << std::endl;
+      VERONA_LOG() << "Begin teardown (phase 2)" << std::endl;
 
       GlobalEpoch::advance();
 
       collect_cown_stubs<true>();
 
-      Systematic::cout() << "End teardown (phase 2)" << std::endl;
+      VERONA_LOG() << "End teardown (phase 2)" << std::endl;
+
+      ObjectStack::BlockCache::flush(alloc);
 
       q.destroy(alloc);
+      pinned_q.destroy(alloc);
+
+      assert(inbox.peek() == nullptr);
+      alloc->dealloc<sizeof(Injected)>(inbox.destroy());
+
+      scratch.destroy(alloc);
+      Scratch::local() = nullptr;
+    }
+
+    /**
+     * Take the next cown from `pinned_q`, skipping over its token. Returns
+     * nullptr if there are no pinned cowns waiting.
+     */
+    T* dequeue_pinned()
+    {
+      T* cown = pinned_q.dequeue(alloc);
+      if ((cown == nullptr) || !has_thread_bit(cown))
+        return cown;
+
+      // The token was at the front, so there is at least one cown behind it.
+      if (n_pinned_ld_tokens > 0)
+        n_pinned_ld_tokens--;
+      pinned_q.enqueue(alloc, cown);
+
+      cown = pinned_q.dequeue(alloc);
+      assert((cown != nullptr) && !has_thread_bit(cown));
+      return cown;
+    }
+
+    /**
+     * Take the next cown to run from this thread's own queues. Alternates
+     * which queue is tried first, so that neither pinned nor unpinned cowns
+     * can starve the other.
+     */
+    T* dequeue()
+    {
+      prefer_pinned = !prefer_pinned;
+
+      T* cown = prefer_pinned ? dequeue_pinned() : q.dequeue(alloc);
+      if (cown != nullptr)
+        return cown;
+
+      return prefer_pinned ? q.dequeue(alloc) : dequeue_pinned();
     }
 
     bool fast_steal(T*& result)
@@ -509,8 +929,9 @@ namespace verona::rt
         if (cown != nullptr)
         {
           // stats.steal();
-          Systematic::cout() << "Fast-steal cown " << cown << " from "
-                             << victim->systematic_id << std::endl;
+          Trace::record(Trace::Steal, cown);
+          VERONA_LOG() << "Fast-steal cown " << cown << " from "
+                       << victim->systematic_id << std::endl;
           result = cown;
           return true;
         }
@@ -525,7 +946,7 @@ namespace verona::rt
     void dec_n_ld_tokens()
     {
       assert(n_ld_tokens == 1 || n_ld_tokens == 2);
-      Systematic::cout() << "Reached LD token" << std::endl;
+      VERONA_LOG() << "Reached LD token" << std::endl;
       n_ld_tokens--;
     }
 
@@ -557,6 +978,15 @@ namespace verona::rt
       {
         check_token_cown();
 
+        drain_inbox();
+
+        const bool retired = is_retired();
+        if (retired)
+        {
+          T* none = nullptr;
+          retire_work(none);
+        }
+
         yield();
 
         if (q.is_empty())
@@ -567,22 +997,24 @@ namespace verona::rt
         // Participate in the cown LD protocol.
         ld_protocol();
 
-        // Check if some other thread has pushed work on our queue.
-        cown = q.dequeue(alloc);
+        // Check if some other thread has pushed work on our queues.
+        cown = dequeue();
 
         if (cown != nullptr)
           return cown;
 
-        // Try to steal from the victim thread.
-        if (victim != this)
+        // Try to steal from the victim thread. Retired threads only run the
+        // cowns pinned to them.
+        if ((victim != this) && !retired)
         {
           cown = victim->q.dequeue(alloc);
 
           if (cown != nullptr)
           {
             stats.steal();
-            Systematic::cout() << "Stole cown " << cown << " from "
-                               << victim->systematic_id << std::endl;
+            Trace::record(Trace::Steal, cown);
+            VERONA_LOG() << "Stole cown " << cown << " from "
+                         << victim->systematic_id << std::endl;
             return cown;
           }
         }
@@ -594,7 +1026,7 @@ namespace verona::rt
         uint64_t tsc2 = Aal::tick();
 
 #ifndef USE_SYSTEMATIC_TESTING
-        if ((tsc2 - tsc) < TSC_QUIESCENCE_TIMEOUT)
+        if (((tsc2 - tsc) < TSC_QUIESCENCE_TIMEOUT) && !retired)
         {
           Aal::pause();
         }
@@ -615,12 +1047,15 @@ namespace verona::rt
 #endif
           continue;
         }
-        // Enter sleep only when the queue doesn't contain any real cowns.
-        else if (state == ThreadState::NotInLD && q.is_empty())
+        // Enter sleep only when the queues don't contain any real cowns.
+        else if (
+          state == ThreadState::NotInLD && q.is_empty() &&
+          pinned_q.is_empty() && inbox_sleep())
         {
-          // We've been spinning looking for work for some time. While paused,
-          // our running flag may be set to false, in which case we terminate.
-          if (Scheduler::get().pause(tsc2))
+          // We've been spinning looking for work for some time, or we are
+          // retired and not expecting any. While paused, our running flag may
+          // be set to false, in which case we terminate.
+          if (Scheduler::get().pause(tsc2, retired))
             stats.pause();
         }
 #ifdef USE_SYSTEMATIC_TESTING
@@ -665,23 +1100,26 @@ namespace verona::rt
 
         if (sched != this)
         {
-          Systematic::cout() << "Reached token: stolen from "
-                             << sched->systematic_id << std::endl;
+          VERONA_LOG() << "Reached token: stolen from " << sched->systematic_id
+                       << std::endl;
         }
         else
         {
-          Systematic::cout() << "Reached token" << std::endl;
+          VERONA_LOG() << "Reached token" << std::endl;
         }
 
         return false;
       }
 
+      // Pinned cowns are never in another thread's queue.
+      assert(
+        (cown->pinned_thread() == nullptr) || (cown->pinned_thread() == this));
+
       // Register this cown with the scheduler thread if it is not currently
       // registered with a scheduler thread.
       if (cown->owning_thread() == nullptr)
       {
-        Systematic::cout() << "Bind cown to scheduler thread: " << this
-                           << std::endl;
+        VERONA_LOG() << "Bind cown to scheduler thread: " << this << std::endl;
         cown->set_owning_thread(this);
         cown->next = list;
         list = cown;
@@ -695,14 +1133,14 @@ namespace verona::rt
     {
       if (state == ThreadState::NotInLD)
       {
-        Systematic::cout() << "==============================================="
-                           << std::endl;
-        Systematic::cout() << "==============================================="
-                           << std::endl;
-        Systematic::cout() << "==============================================="
-                           << std::endl;
-        Systematic::cout() << "==============================================="
-                           << std::endl;
+        VERONA_LOG() << "==============================================="
+                     << std::endl;
+        VERONA_LOG() << "==============================================="
+                     << std::endl;
+        VERONA_LOG() << "==============================================="
+                     << std::endl;
+        VERONA_LOG() << "==============================================="
+                     << std::endl;
 
         ld_state_change(ThreadState::WantLD);
       }
@@ -710,7 +1148,10 @@ namespace verona::rt
 
     bool ld_checkpoint_reached()
     {
-      return n_ld_tokens == 0;
+      // Pinned cowns that were waiting when the scan started must also have
+      // been run, unless there are none left.
+      return (n_ld_tokens == 0) &&
+        ((n_pinned_ld_tokens == 0) || pinned_q.is_empty());
     }
 
     /**
@@ -723,10 +1164,13 @@ namespace verona::rt
       // Set state to BelieveDone_Vote when we think we've finished scanning.
       if ((state == ThreadState::AllInScan) && ld_checkpoint_reached())
       {
-        Systematic::cout() << "Scheduler unscanned flag: "
-                           << scheduled_unscanned_cown << std::endl;
+        VERONA_LOG() << "Scheduler unscanned flag: " << scheduled_unscanned_cown
+                     << std::endl;
 
-        if (!scheduled_unscanned_cown && Scheduler::no_inflight_messages())
+        // Behaviours waiting in the inbox have not been scanned.
+        if (
+          !scheduled_unscanned_cown && Scheduler::no_inflight_messages() &&
+          (inbox.peek() == nullptr))
         {
           ld_state_change(ThreadState::BelieveDone_Vote);
         }
@@ -750,7 +1194,7 @@ namespace verona::rt
         // trying to perform a LD.
         if (
           sprev == ThreadState::PreScan && snext == ThreadState::PreScan &&
-          Scheduler::get().unpause())
+          Scheduler::get().unpause(false, true))
         {
           stats.unpause();
         }
@@ -762,7 +1206,7 @@ namespace verona::rt
         if (first)
         {
           first = false;
-          Systematic::cout() << "LD protocol loop" << std::endl;
+          VERONA_LOG() << "LD protocol loop" << std::endl;
         }
 
         ld_state_change(snext);
@@ -772,7 +1216,9 @@ namespace verona::rt
         {
           case ThreadState::PreScan:
           {
-            if (Scheduler::get().unpause())
+            // Every thread votes in the leak detector, including retired
+            // ones.
+            if (Scheduler::get().unpause(false, true))
               stats.unpause();
 
             enter_prescan();
@@ -829,9 +1275,10 @@ namespace verona::rt
 
     void ld_state_change(ThreadState::State snext)
     {
-      Systematic::cout() << "Scheduler state change: " << state << " -> "
-                         << snext << std::endl;
+      VERONA_LOG() << "Scheduler state change: " << state << " -> " << snext
+                   << std::endl;
       state = snext;
+      Trace::record(Trace::LDPhase, (uint64_t)snext);
     }
 
     void enter_prescan()
@@ -844,7 +1291,7 @@ namespace verona::rt
       // scanning.
       send_epoch = EpochMark::EPOCH_NONE;
 
-      Systematic::cout() << "send_epoch (1): " << send_epoch << std::endl;
+      VERONA_LOG() << "send_epoch (1): " << send_epoch << std::endl;
     }
 
     void enqueue_token()
@@ -858,7 +1305,7 @@ namespace verona::rt
     {
       send_epoch = (prev_epoch == EpochMark::EPOCH_B) ? EpochMark::EPOCH_A :
                                                         EpochMark::EPOCH_B;
-      Systematic::cout() << "send_epoch (2): " << send_epoch << std::endl;
+      VERONA_LOG() << "send_epoch (2): " << send_epoch << std::endl;
 
       // Send empty messages to all cowns that can be LIFO scheduled.
 
@@ -874,8 +1321,9 @@ namespace verona::rt
       }
 
       n_ld_tokens = 2;
+      n_pinned_ld_tokens = 2;
       scheduled_unscanned_cown = false;
-      Systematic::cout() << "Enqueued LD check point" << std::endl;
+      VERONA_LOG() << "Enqueued LD check point" << std::endl;
     }
 
     void collect_cowns()
@@ -917,14 +1365,14 @@ namespace verona::rt
         {
           if (c->weak_count != 0)
           {
-            Systematic::cout() << "Leaking cown " << c << std::endl;
+            VERONA_LOG() << "Leaking cown " << c << std::endl;
             if (Scheduler::get_detect_leaks())
             {
               *p = c->next;
               continue;
             }
           }
-          Systematic::cout() << "Stub collect cown " << c << std::endl;
+          VERONA_LOG() << "Stub collect cown " << c << std::endl;
           // TODO: Investigate systematic testing coverage here.
           auto epoch = c->epoch_when_popped;
           auto outdated =
@@ -933,15 +1381,16 @@ namespace verona::rt
           {
             count++;
             *p = c->next;
-            Systematic::cout() << "Stub collected cown " << c << std::endl;
+            VERONA_LOG() << "Stub collected cown " << c << std::endl;
             c->dealloc(alloc);
             continue;
           }
           else
           {
             if (!outdated)
-              Systematic::cout()
-                << "Cown " << c << " not outdated." << std::endl;
+            {
+              VERONA_LOG() << "Cown " << c << " not outdated." << std::endl;
+            }
           }
         }
         p = &(c->next);
@@ -0,0 +1,250 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "../object/object.h"
+
+#include <snmalloc.h>
+#include <type_traits>
+
+namespace verona::rt
+{
+  using namespace snmalloc;
+
+  template<typename T>
+  class ScratchArray;
+
+  /**
+   * A bump allocator for temporary memory used by a single behaviour.
+   *
+   * Each scheduler thread owns one. It is reset after every behaviour run by
+   * the thread, so anything allocated from it is freed when the behaviour
+   * returns, without any per-allocation work. Memory is handed out from a list
+   * of chunks that is kept across resets, so after warming up a behaviour
+   * allocates without calling into snmalloc at all.
+   *
+   * Requests too large for a chunk are allocated individually and freed on
+   * reset. Resetting is otherwise a constant number of stores.
+   *
+   * Behaviours allocate through `Scratch::make`, which only hands out plain
+   * data wrapped in a `ScratchArray`; see there for how escape is prevented.
+   */
+  class Scratch
+  {
+    struct Chunk
+    {
+      Chunk* next;
+      size_t size;
+
+      char* begin()
+      {
+        return (char*)(this + 1);
+      }
+
+      char* end()
+      {
+        return (char*)this + size;
+      }
+    };
+
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    /// Requests larger than this get a chunk of their own.
+    static constexpr size_t LARGE_SIZE = CHUNK_SIZE / 4;
+
+    Chunk* first = nullptr;
+    Chunk* current = nullptr;
+    Chunk* large = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    bool active = false;
+
+    static Chunk* make_chunk(Alloc* alloc, size_t size, Chunk* next)
+    {
+      auto* c = (Chunk*)alloc->alloc(size);
+      c->next = next;
+      c->size = size;
+      return c;
+    }
+
+    static char* align_up(char* p, size_t align)
+    {
+      return (char*)bits::align_up((uintptr_t)p, align);
+    }
+
+    void* alloc_slow(size_t size, size_t align)
+    {
+      auto* a = ThreadAlloc::get();
+
+      if ((size + align) > LARGE_SIZE)
+      {
+        large = make_chunk(a, sizeof(Chunk) + size + align, large);
+        return align_up(large->begin(), align);
+      }
+
+      // Move to the next chunk, which may have been kept from an earlier
+      // behaviour.
+      if (current == nullptr)
+      {
+        if (first == nullptr)
+          first = make_chunk(a, CHUNK_SIZE, nullptr);
+        current = first;
+      }
+      else
+      {
+        if (current->next == nullptr)
+          current->next = make_chunk(a, CHUNK_SIZE, nullptr);
+        current = current->next;
+      }
+
+      cursor = current->begin();
+      limit = current->end();
+      return alloc(size, align);
+    }
+
+    void free_large(Alloc* alloc)
+    {
+      while (large != nullptr)
+      {
+        auto* next = large->next;
+        alloc->dealloc(large, large->size);
+        large = next;
+      }
+    }
+
+  public:
+    /// The scratch allocator of the current scheduler thread, if any.
+    static Scratch*& local()
+    {
+      static thread_local Scratch* local = nullptr;
+      return local;
+    }
+
+    void* alloc(size_t size, size_t align)
+    {
+      char* p = align_up(cursor, align);
+      if (likely(
+            (cursor != nullptr) && (p <= limit) &&
+            ((size_t)(limit - p) >= size)))
+      {
+        cursor = p + size;
+        return p;
+      }
+
+      return alloc_slow(size, align);
+    }
+
+    /// Allow allocation, until the next `reset`.
+    void enter()
+    {
+      active = true;
+    }
+
+    /// Free everything allocated since the last reset.
+    void reset(Alloc* alloc)
+    {
+      active = false;
+      if (large != nullptr)
+        free_large(alloc);
+
+      current = nullptr;
+      cursor = nullptr;
+      limit = nullptr;
+    }
+
+    /// Return all memory to snmalloc. Called when the thread terminates.
+    void destroy(Alloc* alloc)
+    {
+      reset(alloc);
+      while (first != nullptr)
+      {
+        auto* next = first->next;
+        alloc->dealloc(first, first->size);
+        first = next;
+      }
+    }
+
+    /**
+     * Allocate `count` default-initialised values of type `T` that live until
+     * the current behaviour returns. Must only be called from a behaviour.
+     */
+    template<typename T>
+    static ScratchArray<T> make(size_t count = 1);
+  };
+
+  /**
+   * An array of plain data allocated from the current behaviour's scratch
+   * memory.
+   *
+   * The element type cannot be a Verona object, so scratch memory can never
+   * be reached from a region, an immutable or a cown. The array itself cannot
+   * be copied, moved or heap allocated, so it can only be held in the frame of
+   * the behaviour, and goes out of scope before the memory is reset. Raw
+   * pointers obtained from it must not be kept beyond the behaviour.
+   */
+  template<typename T>
+  class ScratchArray
+  {
+    static_assert(
+      !std::is_base_of_v<Object, T>,
+      "Verona objects cannot be allocated in scratch memory.");
+    static_assert(
+      std::is_trivially_destructible_v<T>,
+      "Scratch memory is released without running destructors.");
+
+    T* elements;
+    size_t count;
+
+    ScratchArray(T* elements, size_t count) : elements(elements), count(count)
+    {}
+
+    friend class Scratch;
+
+  public:
+    ScratchArray(const ScratchArray&) = delete;
+    ScratchArray& operator=(const ScratchArray&) = delete;
+    ScratchArray(ScratchArray&&) = delete;
+    ScratchArray& operator=(ScratchArray&&) = delete;
+
+    static void* operator new(size_t) = delete;
+    static void* operator new[](size_t) = delete;
+
+    T& operator[](size_t i)
+    {
+      assert(i < count);
+      return elements[i];
+    }
+
+    T* data()
+    {
+      return elements;
+    }
+
+    size_t size() const
+    {
+      return count;
+    }
+
+    T* begin()
+    {
+      return elements;
+    }
+
+    T* end()
+    {
+      return elements + count;
+    }
+  };
+
+  template<typename T>
+  ScratchArray<T> Scratch::make(size_t count)
+  {
+    auto* s = local();
+    assert((s != nullptr) && s->active);
+
+    auto* p = (T*)s->alloc(count * sizeof(T), alignof(T));
+    for (size_t i = 0; i < count; i++)
+      new (&p[i]) T;
+
+    return ScratchArray<T>(p, count);
+  }
+} // namespace verona::rt
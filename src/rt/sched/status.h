@@ -4,10 +4,14 @@
 
 #include "../ds/morebits.h"
 
+#include <algorithm>
+#include <atomic>
 #include <ostream>
 
 namespace verona::rt
 {
+  class Cown;
+
   /// Backpressure priority level
   enum struct Priority : uint8_t
   {
@@ -65,8 +69,18 @@ namespace verona::rt
   /// TODO: possibly I/O thread when cown is uncheduled
   class alignas(4) Status
   {
-    // Load at which cown is overloaded.
-    static constexpr uint32_t overload_threshold = 800;
+  public:
+    /// Default load at which a cown is overloaded.
+    static constexpr uint32_t default_overload_threshold = 800;
+    /// Largest value that `total_load()` can reach: four full history nibbles
+    /// and a full current load.
+    static constexpr uint32_t max_total_load = (4 * (0xf << 4)) + 0xff;
+
+  private:
+    /// Load at which cown is overloaded. This is shared by all cowns and may be
+    /// tuned at runtime through `set_overload_threshold`.
+    inline static std::atomic<uint32_t> overload_threshold{
+      default_overload_threshold};
 
     /// Ring buffer with a capacity for 4 4-bit entries.
     uint16_t _load_hist = 0;
@@ -113,7 +127,24 @@ namespace verona::rt
     /// Return true if this cown is overloaded.
     inline bool overloaded() const
     {
-      return bits::extract<1, 1>(_misc) || (total_load() > overload_threshold);
+      return bits::extract<1, 1>(_misc) ||
+        (total_load() > overload_threshold.load(std::memory_order_relaxed));
+    }
+
+    /// Set the load at which cowns become overloaded. Cowns running messages
+    /// for a receiver above this load will be muted, so lowering the threshold
+    /// mutes senders more eagerly. A value of `max_total_load` or greater
+    /// prevents cowns from becoming overloaded through their load alone.
+    static void set_overload_threshold(uint32_t threshold)
+    {
+      overload_threshold.store(
+        (std::min)(threshold, max_total_load), std::memory_order_relaxed);
+    }
+
+    /// Return the load at which cowns become overloaded.
+    static uint32_t get_overload_threshold()
+    {
+      return overload_threshold.load(std::memory_order_relaxed);
     }
 
     /// Increment the current load. This increment will become saturated at 255.
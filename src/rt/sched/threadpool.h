@@ -3,9 +3,11 @@
 #pragma once
 
 #include "cpu.h"
+#include "status.h"
 #include "test/systematic.h"
 #include "threadstate.h"
 
+#include <algorithm>
 #include <condition_variable>
 #include <mutex>
 #include <snmalloc.h>
@@ -29,6 +31,12 @@ namespace verona::rt
     size_t incarnation = 1;
     size_t thread_count = 0;
     size_t active_thread_count = 0;
+    /// Number of paused threads that were retired when they paused. They wait
+    /// on `retired_cv`, and are only woken by unpauses that need them.
+    size_t paused_retired_count = 0;
+    /// Number of scheduler threads, from the start of the ring, that run
+    /// unpinned cowns. The rest are retired. See `set_thread_count`.
+    std::atomic<size_t> enabled_thread_count = 0;
 
     /**
      * Number of messages that have been sent that may not be visible to a
@@ -36,9 +44,17 @@ namespace verona::rt
      **/
     std::atomic<size_t> inflight_count = 0;
 
+    /// Count of times a cown has stopped triggering muting. Scheduler threads
+    /// only look for released mutors when this changes.
+    std::atomic<size_t> mutor_releases = 0;
+    /// Count of mutor releases outside of scheduler threads, which are not
+    /// logged by any thread, so that mute maps must be scanned in full.
+    std::atomic<size_t> unlogged_mutor_releases = 0;
+
     uint64_t last_unpause_tsc = Aal::tick();
     std::mutex m;
     std::condition_variable cv;
+    std::condition_variable retired_cv;
     std::atomic_uint64_t barrier_count = 0;
     T* first_thread = nullptr;
 #ifdef USE_SYSTEMATIC_TESTING
@@ -53,6 +69,11 @@ namespace verona::rt
     // We are assuming that no partial write will be observed.
     uint32_t runtime_pausing = 0;
     bool teardown_in_progress = false;
+    /// Set from when the scheduler threads start until teardown begins, while
+    /// threads outside the runtime may inject behaviours into their inboxes.
+    std::atomic<bool> inboxes_open = false;
+    /// Spreads threads outside the runtime over the inboxes. See `inbox`.
+    std::atomic<size_t> next_inbox = 0;
 
     bool fair = false;
 
@@ -78,26 +99,69 @@ namespace verona::rt
 
     static void record_inflight_message()
     {
-      Systematic::cout() << "Increase inflight count: "
-                         << get().inflight_count + 1 << std::endl;
+      VERONA_LOG() << "Increase inflight count: " << get().inflight_count + 1
+                   << std::endl;
       local()->scheduled_unscanned_cown = true;
       get().inflight_count++;
     }
 
     static void recv_inflight_message()
     {
-      Systematic::cout() << "Decrease inflight count: "
-                         << get().inflight_count - 1 << std::endl;
+      VERONA_LOG() << "Decrease inflight count: " << get().inflight_count - 1
+                   << std::endl;
       get().inflight_count--;
     }
 
     static bool no_inflight_messages()
     {
-      Systematic::cout() << "Check inflight count: " << get().inflight_count
-                         << std::endl;
+      VERONA_LOG() << "Check inflight count: " << get().inflight_count
+                   << std::endl;
       return get().inflight_count == 0;
     }
 
+    /// Signal that a cown which may be a mutor has stopped triggering muting,
+    /// so that its mute sets may be unmuted.
+    ///
+    /// On a scheduler thread the mutor is logged by that thread, and the
+    /// release is published by `flush_mutor_releases` at most once per
+    /// scheduler loop, so that threads releasing mutors don't all contend on
+    /// the shared count.
+    template<typename Mutor>
+    static void mutor_released(Mutor* mutor)
+    {
+      auto* me = local();
+      if (me != nullptr)
+      {
+        me->log_mutor_release(mutor);
+      }
+      else
+      {
+        get().unlogged_mutor_releases.fetch_add(1, std::memory_order_acq_rel);
+        get().mutor_releases.fetch_add(1, std::memory_order_acq_rel);
+      }
+    }
+
+    /// Publish the mutor releases noted by the current scheduler thread.
+    static void flush_mutor_releases()
+    {
+      auto* me = local();
+      if (me->mutor_release_pending)
+      {
+        me->mutor_release_pending = false;
+        get().mutor_releases.fetch_add(1, std::memory_order_acq_rel);
+      }
+    }
+
+    static size_t mutor_release_count()
+    {
+      return get().mutor_releases.load(std::memory_order_acquire);
+    }
+
+    static size_t unlogged_mutor_release_count()
+    {
+      return get().unlogged_mutor_releases.load(std::memory_order_acquire);
+    }
+
     /// Increment the external event source count. A non-zero count will prevent
     /// runtime teardown.
     static void add_external_event_source()
@@ -105,8 +169,8 @@ namespace verona::rt
       auto& s = get();
       auto prev_count =
         s.external_event_sources.fetch_add(1, std::memory_order_seq_cst);
-      Systematic::cout() << "Add external event source (now "
-                         << (prev_count + 1) << ")" << std::endl;
+      VERONA_LOG() << "Add external event source (now " << (prev_count + 1)
+                   << ")" << std::endl;
     }
 
     /// Decrement the external event source count. This will allow runtime
@@ -117,19 +181,74 @@ namespace verona::rt
       auto prev_count =
         s.external_event_sources.fetch_sub(1, std::memory_order_seq_cst);
       assert(prev_count != 0);
-      Systematic::cout() << "Remove external event source (now "
-                         << (prev_count - 1) << ")" << std::endl;
+      VERONA_LOG() << "Remove external event source (now " << (prev_count - 1)
+                   << ")" << std::endl;
       if (prev_count == 1)
         s.unpause();
     }
 
     static void set_fair(bool fair)
     {
-      Systematic::cout() << "Set fair: " << fair << std::endl;
+      VERONA_LOG() << "Set fair: " << fair << std::endl;
       auto& s = get();
       s.fair = fair;
     }
 
+    /// Set the load at which cowns are considered overloaded by the
+    /// backpressure system. See `Status::set_overload_threshold`.
+    static void set_overload_threshold(uint32_t threshold)
+    {
+      VERONA_LOG() << "Set overload threshold: " << threshold << std::endl;
+      Status::set_overload_threshold(threshold);
+    }
+
+    /**
+     * Change the number of scheduler threads that run cowns to `count`, which
+     * is clamped between one and the number given to `init`. This may be
+     * called at any time after `init`, from any thread.
+     *
+     * Threads are retired from the end of the ring. A retired thread hands the
+     * cowns in its queue to the enabled threads, stops stealing and taking
+     * work from outside the runtime, and sleeps whenever it has nothing else
+     * to do. It remains part of the pool: it still runs the cowns pinned to
+     * it, and it still takes part in the leak detector, as paused threads do.
+     * The leak detector votes are therefore always counted over the whole
+     * pool, so a change of count cannot race with a collection.
+     */
+    static void set_thread_count(size_t count)
+    {
+      auto& s = get();
+      assert(s.thread_count != 0);
+      count = (std::min)((std::max)(count, (size_t)1), s.thread_count);
+
+      auto prev =
+        s.enabled_thread_count.exchange(count, std::memory_order_acq_rel);
+      VERONA_LOG() << "Set thread count: " << prev << " -> " << count
+                   << std::endl;
+
+      // Retired threads notice at their next scheduling step, but enabled
+      // threads may be asleep, including those that were retired when they
+      // paused.
+      if (count > prev)
+        s.unpause(true, true);
+    }
+
+    static size_t get_thread_count()
+    {
+      return get().enabled_thread_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns true if behaviours scheduled from outside the runtime must be
+     * injected through a scheduler thread's inbox. Threads outside the
+     * runtime that schedule behaviours while it is running should hold an
+     * external event source, so that it is not torn down under them.
+     */
+    static bool can_inject()
+    {
+      return get().inboxes_open.load(std::memory_order_acquire);
+    }
+
     static bool is_teardown_in_progress()
     {
       return get().teardown_in_progress;
@@ -240,6 +359,36 @@ namespace verona::rt
     }
 #endif
 
+    /**
+     * The scheduler thread whose inbox the calling thread, which must be
+     * outside the runtime, injects behaviours into. A producer keeps the same
+     * inbox for as long as the runtime runs, so the behaviours it injects are
+     * sent in the order it scheduled them. Producers are spread over the
+     * threads that are enabled when they first inject. A thread that is
+     * retired later still drains its inbox.
+     */
+    static T* inbox()
+    {
+      static thread_local size_t incarnation;
+      static thread_local T* target;
+
+      auto& pool = get();
+      if (incarnation != pool.incarnation)
+      {
+        incarnation = pool.incarnation;
+
+        // Threads are listed in index order, and those with an index below
+        // the enabled count are not retired.
+        auto n = pool.next_inbox.fetch_add(1, std::memory_order_relaxed) %
+          pool.enabled_thread_count.load(std::memory_order_relaxed);
+        target = pool.first_thread;
+        while (n-- > 0)
+          target = target->next;
+      }
+
+      return target;
+    }
+
     static T* round_robin()
     {
       static thread_local size_t incarnation;
@@ -255,6 +404,11 @@ namespace verona::rt
         nonlocal = nonlocal->next;
       }
 
+      // Retired threads take no work from outside. The first thread is never
+      // retired.
+      while (nonlocal->is_retired())
+        nonlocal = nonlocal->next;
+
       return nonlocal;
     }
 
@@ -279,7 +433,7 @@ namespace verona::rt
       if (in_prescan())
       {
         // During pre-scan alloc in previous epoch.
-        Systematic::cout() << "Alloc cown during pre-scan" << std::endl;
+        VERONA_LOG() << "Alloc cown during pre-scan" << std::endl;
         return t->prev_epoch;
       }
 
@@ -350,8 +504,10 @@ namespace verona::rt
 
       // Build a circular linked list of scheduler threads.
       thread_count = count;
+      enabled_thread_count = count;
       first_thread = new T;
       T* t = first_thread;
+      size_t index = 0;
       teardown_in_progress = false;
 
 #ifdef USE_SYSTEMATIC_TESTING
@@ -363,6 +519,7 @@ namespace verona::rt
         t->next = new T;
         t->systematic_id = count;
         t = t->next;
+        t->index = ++index;
         count--;
       }
       t->systematic_id = count;
@@ -391,7 +548,11 @@ namespace verona::rt
       size_t i = 0;
       T* t = first_thread;
 
-      Systematic::cout() << "Starting all threads" << std::endl;
+      VERONA_LOG() << "Starting all threads" << std::endl;
+
+      // Until now, threads outside the runtime have sent behaviours directly,
+      // as the main thread does while setting up.
+      inboxes_open.store(true, std::memory_order_release);
 
       do
       {
@@ -407,7 +568,7 @@ namespace verona::rt
         delete t;
         t = next;
       } while (t != first_thread);
-      Systematic::cout() << "All threads stopped" << std::endl;
+      VERONA_LOG() << "All threads stopped" << std::endl;
 
       first_thread = nullptr;
       incarnation++;
@@ -416,6 +577,7 @@ namespace verona::rt
 #endif
       thread_count = 0;
       active_thread_count = 0;
+      enabled_thread_count = 0;
       state.reset<ThreadState::NotInLD>();
       topology.release();
 
@@ -433,30 +595,52 @@ namespace verona::rt
       return state.next(s, thread_count);
     }
 
-    bool pause(uint64_t tsc)
+    /**
+     * Put the calling thread to sleep until there is more work, or tear the
+     * runtime down if it is the last thread awake and there is none left.
+     * Unless `immediate` is set, this is rate limited against unpausing.
+     */
+    bool pause(uint64_t tsc, bool immediate = false)
     {
 #ifndef USE_SYSTEMATIC_TESTING
-      if ((tsc - last_unpause_tsc) < TSC_PAUSE_SLOP)
+      if (((tsc - last_unpause_tsc) < TSC_PAUSE_SLOP) && !immediate)
         return false;
 #else
       UNUSED(tsc);
+      UNUSED(immediate);
 #endif
 
       {
         std::unique_lock<std::mutex> lock(m);
-        Systematic::cout() << "Pausing" << std::endl;
+        VERONA_LOG() << "Pausing" << std::endl;
         if (active_thread_count > 1)
         {
+          // Pinned cowns and injected behaviours can only be picked up by
+          // this thread. Holding the lock means an unpause for any that
+          // arrive after this check will see this thread as paused.
+          if (!local()->pinned_q.is_empty() || local()->has_injected())
+            return false;
+
+          // A retired thread waits apart, so that waking threads to take new
+          // work does not wake it.
+          const bool retired = local()->is_retired();
           active_thread_count--;
+          if (retired)
+            paused_retired_count++;
 #ifdef USE_SYSTEMATIC_TESTING
           lock.unlock();
           cv_wait();
           lock.lock();
 #else
-          cv.wait(lock);
+          if (retired)
+            retired_cv.wait(lock);
+          else
+            cv.wait(lock);
 #endif
+          if (retired)
+            paused_retired_count--;
           active_thread_count++;
-          Systematic::cout() << "Unpausing" << std::endl;
+          VERONA_LOG() << "Unpausing" << std::endl;
           return true;
         }
 
@@ -464,7 +648,7 @@ namespace verona::rt
         T* t = first_thread;
         do
         {
-          if (!t->q.is_empty())
+          if (t->has_work())
           {
 // Something has been scheduled LIFO, and the unpause was missed,
 // restart everybody.
@@ -473,6 +657,7 @@ namespace verona::rt
             cv_notify_all();
 #else
             cv.notify_all();
+            retired_cv.notify_all();
 #endif
             return true;
           }
@@ -488,9 +673,9 @@ namespace verona::rt
           t = first_thread;
           do
           {
-            if (!t->q.is_empty())
+            if (t->has_work())
             {
-              Systematic::cout() << "Still work left" << std::endl;
+              VERONA_LOG() << "Still work left" << std::endl;
               runtime_pausing++;
 #ifdef USE_SYSTEMATIC_TESTING
               cv_notify_all();
@@ -502,10 +687,10 @@ namespace verona::rt
             t = t->next;
           } while (t != first_thread);
 
-          Systematic::cout() << "Runtime pausing" << std::endl;
+          VERONA_LOG() << "Runtime pausing" << std::endl;
           cv.wait(lock);
 
-          Systematic::cout() << "Runtime unpausing" << std::endl;
+          VERONA_LOG() << "Runtime unpausing" << std::endl;
           runtime_pausing++;
           cv.notify_all();
 
@@ -513,8 +698,9 @@ namespace verona::rt
         }
 
         // Used to handle deallocating all the state of the threads.
-        Systematic::cout() << "Teardown beginning" << std::endl;
+        VERONA_LOG() << "Teardown beginning" << std::endl;
         teardown_in_progress = true;
+        inboxes_open.store(false, std::memory_order_release);
 
         t = first_thread;
 #ifdef USE_SYSTEMATIC_TESTING
@@ -525,9 +711,9 @@ namespace verona::rt
           t->stop();
           t = t->next;
         } while (t != first_thread);
-        Systematic::cout() << "Teardown: all threads stopped" << std::endl;
+        VERONA_LOG() << "Teardown: all threads stopped" << std::endl;
       }
-      Systematic::cout() << "cv_notify_all() for teardown" << std::endl;
+      VERONA_LOG() << "cv_notify_all() for teardown" << std::endl;
 #ifdef USE_SYSTEMATIC_TESTING
       T* t = first_thread;
       do
@@ -537,13 +723,21 @@ namespace verona::rt
       } while (t != first_thread);
 #else
       cv.notify_all();
+      retired_cv.notify_all();
 #endif
-      Systematic::cout() << "Teardown: all threads beginning teardown"
-                         << std::endl;
+      VERONA_LOG() << "Teardown: all threads beginning teardown" << std::endl;
       return true;
     }
 
-    bool unpause()
+    /**
+     * Wake any paused threads. Unless `force` is set, this is rate limited, as
+     * any awake thread can pick up work that can be stolen.
+     *
+     * Threads that were retired when they paused are only woken if `retired`
+     * is set, for work only they can do, such as running their pinned cowns
+     * or voting in the leak detector.
+     */
+    bool unpause(bool force = false, bool retired = false)
     {
       Barrier::compiler();
 
@@ -554,13 +748,14 @@ namespace verona::rt
         // even if it has paused again.
         do
         {
+          // The pausing thread waits on the condition variable itself, even
+          // under systematic testing.
 #ifdef USE_SYSTEMATIC_TESTING
           cv_notify_all();
-#else
-          cv.notify_all();
 #endif
+          cv.notify_all();
         } while (runtime_pausing == pausing);
-        Systematic::cout() << "Unpausing other threads." << std::endl;
+        VERONA_LOG() << "Unpausing other threads." << std::endl;
 
         return true;
       }
@@ -570,23 +765,33 @@ namespace verona::rt
       uint64_t elapsed = now - last_unpause_tsc;
       last_unpause_tsc = now;
 
-      if (elapsed < TSC_UNPAUSE_SLOP)
+      if ((elapsed < TSC_UNPAUSE_SLOP) && !force)
         return false;
+#else
+      UNUSED(force);
 #endif
 
+      bool wake_enabled;
+      bool wake_retired;
       {
         std::unique_lock<std::mutex> lock(m);
 
-        if (active_thread_count == thread_count)
+        wake_enabled =
+          (active_thread_count + paused_retired_count) != thread_count;
+        wake_retired = retired && (paused_retired_count != 0);
+        if (!wake_enabled && !wake_retired)
           return false;
       }
 
 #ifdef USE_SYSTEMATIC_TESTING
       cv_notify_all();
 #else
-      cv.notify_all();
+      if (wake_enabled)
+        cv.notify_all();
+      if (wake_retired)
+        retired_cv.notify_all();
 #endif
-      Systematic::cout() << "Unpausing other threads." << std::endl;
+      VERONA_LOG() << "Unpausing other threads." << std::endl;
 
       return true;
     }
@@ -0,0 +1,242 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <snmalloc.h>
+
+namespace verona::rt
+{
+  /**
+   * Binary event tracing for the scheduler.
+   *
+   * Like the flight recorder, each thread writes into its own ring buffer, so
+   * recording an event is a handful of stores with no synchronisation. Unlike
+   * the flight recorder, events are typed and fixed size rather than streams
+   * of pretty-printed values, and tracing is compiled into all builds. It is
+   * disabled by default; while disabled, recording an event costs a single
+   * relaxed load and branch.
+   *
+   * The rings may be dumped at any time as a Chrome trace event file, which can
+   * be loaded into `chrome://tracing` or Perfetto. Dumping while the runtime is
+   * running is best-effort: events being overwritten during the dump may be
+   * reported with inconsistent fields.
+   */
+  class Trace
+  {
+  public:
+    enum Kind : uint32_t
+    {
+      /// A cown was placed in a scheduler queue. The argument is the cown.
+      CownScheduled,
+      /// A behaviour started running. The argument is the cown it runs on.
+      BehaviourStart,
+      /// The behaviour started by the last `BehaviourStart` completed.
+      BehaviourEnd,
+      /// A cown was stolen from another scheduler thread. The argument is the
+      /// cown.
+      Steal,
+      /// A cown was muted. The argument is the cown.
+      Mute,
+      /// A cown was unmuted. The argument is the cown.
+      Unmute,
+      /// The leak detector state of this thread changed. The argument is the
+      /// new `ThreadState::State`.
+      LDPhase,
+      /// The global epoch was advanced. The argument is the new epoch.
+      EpochAdvance,
+    };
+
+  private:
+    struct Event
+    {
+      uint64_t tsc;
+      uint64_t arg;
+      uint64_t kind;
+    };
+
+    class Ring : public snmalloc::Pooled<Ring>
+    {
+    public:
+      static constexpr size_t size = 1 << 14;
+
+      /// Identifies the thread that owns this ring in the dump.
+      size_t id;
+      /// Total number of events recorded. Only the last `size` are kept.
+      std::atomic<size_t> count{0};
+      Event events[size];
+
+      Ring()
+      {
+        static std::atomic<size_t> next_id{1};
+        id = next_id.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void add(uint64_t tsc, Kind kind, uint64_t arg)
+      {
+        const auto c = count.load(std::memory_order_relaxed);
+        events[c & (size - 1)] = {tsc, arg, kind};
+        count.store(c + 1, std::memory_order_release);
+      }
+    };
+
+    static snmalloc::Pool<Ring>& global_rings()
+    {
+      return *snmalloc::Singleton<
+        snmalloc::Pool<Ring>*,
+        snmalloc::Pool<Ring>::make>::get();
+    }
+
+    /// Owns the ring of the current thread and returns it to the pool when the
+    /// thread exits.
+    class ThreadLocalRing
+    {
+    public:
+      Ring* ring = nullptr;
+
+      ~ThreadLocalRing()
+      {
+        if (ring != nullptr)
+          global_rings().release(ring);
+      }
+    };
+
+    static Ring& local_ring()
+    {
+      static thread_local ThreadLocalRing mine;
+      if (unlikely(mine.ring == nullptr))
+        mine.ring = global_rings().acquire();
+      return *mine.ring;
+    }
+
+    inline static std::atomic<bool> enabled{false};
+
+    /// Clock readings taken when tracing was enabled, used to convert ticks to
+    /// microseconds in the dump.
+    inline static uint64_t start_tsc = 0;
+    inline static std::chrono::steady_clock::time_point start_time{};
+
+    static const char* name(uint64_t kind)
+    {
+      switch (kind)
+      {
+        case CownScheduled:
+          return "cown scheduled";
+        case BehaviourStart:
+        case BehaviourEnd:
+          return "behaviour";
+        case Steal:
+          return "steal";
+        case Mute:
+          return "mute";
+        case Unmute:
+          return "unmute";
+        case LDPhase:
+          return "LD phase";
+        case EpochAdvance:
+          return "epoch advance";
+        default:
+          return "unknown";
+      }
+    }
+
+  public:
+    /// Start recording events.
+    static void enable()
+    {
+      start_tsc = snmalloc::Aal::tick();
+      start_time = std::chrono::steady_clock::now();
+      enabled.store(true, std::memory_order_release);
+    }
+
+    /// Stop recording events. Events already recorded are kept.
+    static void disable()
+    {
+      enabled.store(false, std::memory_order_release);
+    }
+
+    static bool is_enabled()
+    {
+      return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Record an event on the current thread, if tracing is enabled.
+    static inline void record(Kind kind, uint64_t arg = 0)
+    {
+      if (likely(!is_enabled()))
+        return;
+
+      local_ring().add(snmalloc::Aal::tick(), kind, arg);
+    }
+
+    template<typename T>
+    static inline void record(Kind kind, T* arg)
+    {
+      record(kind, (uint64_t)(uintptr_t)arg);
+    }
+
+    /**
+     * Write the events held in all rings as a Chrome trace event file.
+     * Behaviours are reported as duration events, everything else as instant
+     * events, with one track per thread.
+     */
+    static void dump(std::ostream& o)
+    {
+      const auto elapsed_tsc = snmalloc::Aal::tick() - start_tsc;
+      const auto elapsed_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start_time)
+          .count();
+      const double us_per_tick =
+        (elapsed_tsc == 0) ? 1.0 : ((double)elapsed_us / (double)elapsed_tsc);
+
+      o << "{\"traceEvents\":[";
+      bool first = true;
+
+      for (auto* ring = global_rings().iterate(); ring != nullptr;
+           ring = global_rings().iterate(ring))
+      {
+        const auto count = ring->count.load(std::memory_order_acquire);
+        const auto n = (count < Ring::size) ? count : Ring::size;
+        for (size_t i = count - n; i < count; i++)
+        {
+          const auto e = ring->events[i & (Ring::size - 1)];
+          const char* ph = (e.kind == BehaviourStart) ? "B" :
+            (e.kind == BehaviourEnd)                  ? "E" :
+                                                        "i";
+          const auto ts = (double)(int64_t)(e.tsc - start_tsc) * us_per_tick;
+
+          o << (first ? "\n" : ",\n");
+          first = false;
+          o << "{\"name\":\"" << name(e.kind) << "\",\"ph\":\"" << ph
+            << "\",\"ts\":" << std::fixed << std::setprecision(3) << ts
+            << ",\"pid\":1,\"tid\":" << ring->id;
+          if (ph[0] == 'i')
+            o << ",\"s\":\"t\"";
+          if (e.kind != BehaviourEnd)
+            o << ",\"args\":{\"arg\":\"0x" << std::hex << e.arg << std::dec
+              << "\"}";
+          o << "}";
+        }
+      }
+
+      o << "\n]}" << std::endl;
+    }
+
+    /// Write a Chrome trace event file to the given path. Returns false if the
+    /// file could not be written.
+    static bool dump(const char* path)
+    {
+      std::ofstream f(path);
+      if (!f)
+        return false;
+
+      dump(f);
+      return f.good();
+    }
+  };
+}
@@ -0,0 +1,140 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "../ds/hashmap.h"
+#include "cown.h"
+
+namespace verona::rt
+{
+  using namespace snmalloc;
+
+  /**
+   * A table of weak references to cowns, owned by a single cown or thread.
+   *
+   * The table holds one weak reference on each distinct cown it contains,
+   * however many times the cown has been added, and counts the additions
+   * itself without atomic operations. Only the first `add` and the last
+   * `remove` of a cown touch the cown's weak count.
+   *
+   * A cown in the table can be upgraded to a strong reference at any time,
+   * which fails once the cown has been collected. Batches are upgraded with
+   * `upgrade`, which amortises the atomic operations for repeated cowns.
+   */
+  template<typename T = Cown>
+  class WeakRefTable
+  {
+    static_assert(std::is_base_of_v<Cown, T>);
+
+    using Map = ObjectMap<std::pair<T*, size_t>>;
+
+    Map* map;
+
+  public:
+    WeakRefTable(Alloc* alloc = ThreadAlloc::get()) : map(Map::create(alloc))
+    {}
+
+    WeakRefTable(const WeakRefTable&) = delete;
+    WeakRefTable& operator=(const WeakRefTable&) = delete;
+
+    ~WeakRefTable()
+    {
+      dealloc(ThreadAlloc::get());
+    }
+
+    /**
+     * Release every weak reference held by the table and free it. The table
+     * must not be used afterwards.
+     */
+    void dealloc(Alloc* alloc)
+    {
+      if (map == nullptr)
+        return;
+
+      clear(alloc);
+      map->dealloc(alloc);
+      alloc->dealloc<sizeof(Map)>(map);
+      map = nullptr;
+    }
+
+    /**
+     * Add a weak reference to `c`. The caller must hold a strong or weak
+     * reference to `c`, which it keeps.
+     */
+    void add(Alloc* alloc, T* c)
+    {
+      auto it = map->find(c);
+      if (it != map->end())
+      {
+        it.value()++;
+        return;
+      }
+
+      c->weak_acquire();
+      map->insert(alloc, std::make_pair(c, (size_t)1));
+    }
+
+    /**
+     * Remove one of the weak references to `c` added to the table.
+     */
+    void remove(Alloc* alloc, T* c)
+    {
+      auto it = map->find(c);
+      assert(it != map->end());
+
+      if (--it.value() > 0)
+        return;
+
+      map->erase(it);
+      c->weak_release(alloc);
+    }
+
+    /**
+     * Remove every reference, releasing the weak references on the cowns.
+     */
+    void clear(Alloc* alloc)
+    {
+      for (auto it = map->begin(); it != map->end(); ++it)
+        it.key()->weak_release(alloc);
+
+      map->clear(alloc);
+    }
+
+    bool contains(const T* c) const
+    {
+      return map->find(c) != map->end();
+    }
+
+    /// The number of references to `c` in the table.
+    size_t count(const T* c) const
+    {
+      auto it = map->find(c);
+      return (it == map->end()) ? 0 : it.value();
+    }
+
+    /// The number of distinct cowns in the table.
+    size_t size() const
+    {
+      return map->size();
+    }
+
+    /**
+     * Upgrade a batch of cowns in the table to strong references, as
+     * `Cown::acquire_strong_from_weak`. Every non-null entry of `weak` must
+     * be in the table. Entries for the same cown should be adjacent, so they
+     * are upgraded together.
+     *
+     * Returns the number of strong references created. The caller releases
+     * them with `Cown::release(alloc, count, strong)`.
+     */
+    size_t upgrade(size_t count, T* const* weak, T** strong)
+    {
+#ifndef NDEBUG
+      for (size_t i = 0; i < count; i++)
+        assert((weak[i] == nullptr) || contains(weak[i]));
+#endif
+      return Cown::acquire_strong_from_weak(
+        count, (Cown* const*)weak, (Cown**)strong);
+    }
+  };
+} // namespace verona::rt
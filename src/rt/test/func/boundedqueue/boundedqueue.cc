@@ -0,0 +1,109 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests bounded message queues.
+ *
+ * A receiver is given a small queue capacity and slow behaviours. A single
+ * sender floods it with more messages than the capacity in each of a number of
+ * rounds, so that the receiver's queue fills up and the sender is muted.
+ *
+ * The sender must have been muted at least once, and it must be unmuted again
+ * so that every round runs and every message is processed by the receiver.
+ * Whether a particular unmute happened because the receiver drained or because
+ * an idle scheduler thread forced it is not observable here, so the test does
+ * not check the receiver's queue length when the sender resumes.
+ **/
+
+static constexpr size_t queue_capacity = 4;
+static constexpr size_t messages_per_round = 16;
+static constexpr size_t rounds = 20;
+
+struct Receiver : public VCown<Receiver>
+{
+  size_t count = 0;
+
+  ~Receiver()
+  {
+    check(count == (messages_per_round * rounds));
+  }
+};
+
+struct Sender : public VCown<Sender>
+{
+  Receiver* receiver;
+  size_t rounds_run = 0;
+
+  Sender(Receiver* receiver) : receiver(receiver) {}
+
+  ~Sender()
+  {
+    check(rounds_run == rounds);
+    check(times_muted() > 0);
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    st.push(receiver);
+  }
+};
+
+struct Slow : public VBehaviour<Slow>
+{
+  Receiver* r;
+
+  Slow(Receiver* r) : r(r) {}
+
+  void f()
+  {
+    for (volatile size_t i = 0; i < 1000; i = i + 1)
+    {}
+
+    r->count++;
+  }
+};
+
+struct Flood : public VBehaviour<Flood>
+{
+  Sender* s;
+  size_t remaining;
+
+  Flood(Sender* s, size_t remaining) : s(s), remaining(remaining) {}
+
+  void f()
+  {
+    s->rounds_run++;
+
+    for (size_t i = 0; i < messages_per_round; i++)
+      Cown::schedule<Slow>(s->receiver, s->receiver);
+
+    if (remaining > 0)
+      Cown::schedule<Flood>(s, s, remaining - 1);
+  }
+};
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+
+  auto* r = new Receiver;
+  r->set_queue_capacity(queue_capacity);
+
+  auto* s = new Sender(r);
+  Cown::acquire(r);
+
+  Cown::schedule<Flood>(s, s, rounds - 1);
+
+  Cown::release(alloc, s);
+  Cown::release(alloc, r);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * A variant of the cown_weak_ref test using weak reference tables and bulk
+ * upgrades.
+ *
+ * Each node of a binary tree holds weak references to all of its ancestors in
+ * a table, with its parent added twice. The root is sent two Down messages.
+ *
+ * When a node receives a Down message it upgrades the weak references to its
+ * ancestors in one batch, and sends an Up message to each ancestor that is
+ * still alive, transferring the strong references. The strong reference to
+ * the second copy of the parent is released in a batch instead. It then sends
+ * a Down message to each of its children.
+ *
+ * This races the bulk upgrades against the ancestors being collected, so any
+ * number of the Up messages may be received.
+ **/
+
+static constexpr size_t max_depth = 8;
+
+struct MyCown : VCown<MyCown>
+{
+  WeakRefTable<MyCown> ancestors;
+  // Weak, nearest first, with the parent repeated. All are in `ancestors`.
+  MyCown* path[max_depth + 1];
+  size_t path_length = 0;
+
+  MyCown* left = nullptr; // Strong
+  MyCown* right = nullptr; // Strong
+
+  size_t up_count = 0;
+
+  void trace(ObjectStack& os) const
+  {
+    if (left != nullptr)
+      os.push(left);
+    if (right != nullptr)
+      os.push(right);
+
+    // Do not push the ancestors, as they are weak references.
+  }
+
+  ~MyCown()
+  {
+    ancestors.dealloc(ThreadAlloc::get_noncachable());
+
+    Systematic::cout() << "Destroying " << this << " up_count " << up_count
+                       << std::endl;
+  }
+};
+
+MyCown* make_tree(size_t n, MyCown* p)
+{
+  if (n == 0)
+    return nullptr;
+
+  auto* alloc = ThreadAlloc::get();
+  auto c = new MyCown;
+
+  if (p != nullptr)
+  {
+    c->path[c->path_length++] = p;
+    c->path[c->path_length++] = p;
+    for (size_t i = 1; i < p->path_length; i++)
+      c->path[c->path_length++] = p->path[i];
+
+    for (size_t i = 0; i < c->path_length; i++)
+      c->ancestors.add(alloc, c->path[i]);
+
+    check(c->ancestors.count(p) == 2);
+    check(c->ancestors.size() == (c->path_length - 1));
+  }
+
+  c->left = make_tree(n - 1, c);
+  c->right = make_tree(n - 1, c);
+  return c;
+}
+
+struct Up : VBehaviour<Up>
+{
+  MyCown* m;
+  Up(MyCown* m) : m(m) {}
+
+  void f()
+  {
+    Systematic::cout() << "Up on " << m << std::endl;
+
+    m->up_count++;
+  }
+};
+
+struct Down : VBehaviour<Down>
+{
+  MyCown* m;
+  Down(MyCown* m) : m(m) {}
+
+  void f()
+  {
+    Systematic::cout() << "Down on " << m << std::endl;
+
+    auto* alloc = ThreadAlloc::get();
+    MyCown* strong[max_depth + 1];
+    size_t count = m->path_length;
+    size_t acquired = m->ancestors.upgrade(count, m->path, strong);
+
+    size_t live = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+      check((strong[i] == nullptr) || (strong[i] == m->path[i]));
+      if (strong[i] != nullptr)
+        live++;
+    }
+    check(live == acquired);
+
+    if (count > 0)
+    {
+      // Both copies of the parent are upgraded together.
+      check(strong[0] == strong[1]);
+
+      Cown::release(alloc, 1, (Cown**)&strong[1]);
+      strong[1] = nullptr;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+      if (strong[i] != nullptr)
+        Cown::schedule<Up, YesTransfer>(strong[i], strong[i]);
+    }
+
+    if (m->left != nullptr)
+    {
+      Cown::schedule<Down>(m->left, m->left);
+    }
+
+    if (m->right != nullptr)
+    {
+      Cown::schedule<Down>(m->right, m->right);
+    }
+  }
+};
+
+void run_test()
+{
+  auto t = make_tree(max_depth, nullptr);
+
+  Cown::schedule<Down>(t, t);
+  Cown::schedule<Down, YesTransfer>(t, t);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+}
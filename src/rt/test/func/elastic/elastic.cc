@@ -0,0 +1,110 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests changing the number of scheduler threads while running.
+ *
+ * A controller behaviour repeatedly retires and re-enables scheduler threads,
+ * occasionally requesting a leak detector run, while other behaviours keep
+ * unpinned cowns busy. Cowns pinned to threads that get retired must keep
+ * running on those threads. Two of the cowns form a cycle that only the leak
+ * detector can collect.
+ **/
+
+struct Worker : public VCown<Worker>
+{
+  Worker* other = nullptr;
+  size_t count = 0;
+
+  void trace(ObjectStack& st) const
+  {
+    if (other != nullptr)
+      st.push(other);
+  }
+};
+
+struct Spin : public VBehaviour<Spin>
+{
+  Worker* w;
+  size_t remaining;
+
+  Spin(Worker* w, size_t remaining) : w(w), remaining(remaining) {}
+
+  void f()
+  {
+    if (w->pinned_thread() != nullptr)
+      check(Scheduler::local() == w->pinned_thread());
+
+    w->count++;
+
+    if (remaining > 0)
+      Cown::schedule<Spin>(w, w, remaining - 1);
+  }
+};
+
+struct Resize : public VBehaviour<Resize>
+{
+  Worker* controller;
+  size_t remaining;
+
+  Resize(Worker* controller, size_t remaining)
+  : controller(controller), remaining(remaining)
+  {}
+
+  void f()
+  {
+    // Requests beyond the number of threads in the pool are clamped.
+    auto count = ((remaining * 5) % 8) + 1;
+    Scheduler::set_thread_count(count);
+    check(Scheduler::get_thread_count() >= 1);
+    check(Scheduler::get_thread_count() <= count);
+
+    if ((remaining % 4) == 0)
+      Scheduler::want_ld();
+
+    if (remaining > 0)
+      Cown::schedule<Resize>(controller, controller, remaining - 1);
+  }
+};
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+  constexpr size_t worker_count = 8;
+
+  Worker* workers[worker_count];
+  for (size_t i = 0; i < worker_count; i++)
+  {
+    workers[i] = new Worker;
+    // Pin every other worker, so that some are pinned to threads that will
+    // be retired.
+    if ((i % 2) == 0)
+      workers[i]->pin();
+  }
+
+  // Make a cycle between the first two workers.
+  workers[0]->other = workers[1];
+  workers[1]->other = workers[0];
+  Cown::acquire(workers[0]);
+  Cown::acquire(workers[1]);
+
+  auto* controller = new Worker;
+  Cown::schedule<Resize>(controller, controller, (size_t)40);
+
+  for (size_t i = 0; i < worker_count; i++)
+    Cown::schedule<Spin>(workers[i], workers[i], (size_t)100);
+
+  for (size_t i = 0; i < worker_count; i++)
+    Cown::release(alloc, workers[i]);
+  Cown::release(alloc, controller);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests behaviours with a deadline or a cancellation token.
+ *
+ * A first behaviour on cown `a` cancels a token. Behaviours sent afterwards
+ * carrying that token, or a deadline that has already passed, must be dropped
+ * rather than run, whether they run on `a` alone or on `a` and `b` together.
+ * Behaviours with a distant deadline, or a token that is never cancelled, must
+ * run. Every behaviour's destructor must run exactly once either way, and the
+ * cowns held by dropped behaviours must still be released.
+ **/
+
+struct Account : public VCown<Account>
+{};
+
+static std::atomic<size_t> ran;
+static std::atomic<size_t> destroyed;
+
+struct Work : public VBehaviour<Work>
+{
+  bool expect_run;
+
+  Work(bool expect_run) : expect_run(expect_run) {}
+
+  ~Work()
+  {
+    destroyed++;
+  }
+
+  void f()
+  {
+    check(expect_run);
+    ran++;
+  }
+};
+
+struct Cancel : public VBehaviour<Cancel>
+{
+  CancellationToken* token;
+
+  Cancel(CancellationToken* token) : token(token) {}
+
+  void f()
+  {
+    token->cancel();
+    token->release();
+  }
+};
+
+struct Check : public VBehaviour<Check>
+{
+  size_t expect_ran;
+  size_t expect_destroyed;
+
+  Check(size_t expect_ran, size_t expect_destroyed)
+  : expect_ran(expect_ran), expect_destroyed(expect_destroyed)
+  {}
+
+  void f()
+  {
+    check(ran == expect_ran);
+    check(destroyed == expect_destroyed);
+  }
+};
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+  constexpr size_t rounds = 16;
+
+  ran = 0;
+  destroyed = 0;
+
+  auto* a = new Account;
+  auto* b = new Account;
+  Cown* both[2] = {a, b};
+
+  auto* cancelled = CancellationToken::create(alloc);
+  auto* kept = CancellationToken::create(alloc);
+
+  cancelled->acquire();
+  Cown::schedule<Cancel>(a, cancelled);
+
+  const auto past = Expiry::Clock::now() - std::chrono::seconds(1);
+  const auto future = Expiry::Clock::now() + std::chrono::hours(1);
+
+  for (size_t i = 0; i < rounds; i++)
+  {
+    Cown::schedule_until<Work>(cancelled, a, false);
+    Cown::schedule_until<Work>(cancelled, 2, both, false);
+    Cown::schedule_until<Work>(past, a, false);
+    Cown::schedule_until<Work>(Expiry(past, kept), 2, both, false);
+
+    Cown::schedule_until<Work>(future, a, true);
+    Cown::schedule_until<Work>(kept, 2, both, true);
+    Cown::schedule<Work>(2, both, true);
+  }
+
+  Cown::schedule<Check>(2, both, 3 * rounds, 7 * rounds);
+
+  cancelled->release(alloc);
+  kept->release(alloc);
+
+  Cown::release(alloc, a);
+  Cown::release(alloc, b);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
@@ -1,6 +1,7 @@
 // Copyright Microsoft and Project Verona Contributors.
 // SPDX-License-Identifier: MIT
 #include "ds/hashmap.h"
+#include "ds/swissmap.h"
 
 #include "test/opt.h"
 #include "test/xoroshiro.h"
@@ -11,9 +12,8 @@
 using namespace snmalloc;
 using namespace verona::rt;
 
-template<typename Entry, typename Model>
-bool model_check(
-  const ObjectMap<Entry>& map, const Model& model, std::stringstream& err)
+template<typename Map, typename Model>
+bool model_check(const Map& map, const Model& model, std::stringstream& err)
 {
   map.debug_layout(err) << "\n";
 
@@ -58,10 +58,11 @@ bool model_check(
 struct Key : public VCown<Key>
 {};
 
+template<template<typename> class MapType>
 bool test(size_t seed)
 {
   auto* alloc = ThreadAlloc::get();
-  ObjectMap<std::pair<Key*, int32_t>> map(alloc);
+  MapType<std::pair<Key*, int32_t>> map(alloc);
   std::unordered_map<Key*, int32_t> model;
 
   xoroshiro::p128r64 rng{seed};
@@ -163,7 +164,7 @@ int main(int argc, char** argv)
   for (; seed <= seed_upper; seed++)
   {
     std::cout << "seed: " << seed << std::endl;
-    if (!test(seed))
+    if (!test<ObjectMap>(seed) || !test<SwissObjectMap>(seed))
       return 1;
 
     current_alloc_pool()->debug_check_empty();
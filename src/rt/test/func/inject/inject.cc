@@ -0,0 +1,142 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <memory>
+#include <test/harness.h>
+#include <thread>
+#include <vector>
+
+/**
+ * Tests behaviours injected from threads outside the runtime.
+ *
+ * A number of producer threads wait for the runtime to start, then send
+ * behaviours to a set of receiver cowns, round robin, so that every behaviour
+ * passes through a scheduler thread's inbox. Some of the behaviours request a
+ * leak detector run, and two of the receivers form a cycle that only the leak
+ * detector can collect, so that collections overlap with the injections.
+ *
+ * Every behaviour has its own id, and checks that it is the first to run with
+ * that id. Once the runtime has stopped and the producers have been joined,
+ * every id must have run exactly once.
+ **/
+
+struct Receiver : public VCown<Receiver>
+{
+  Receiver* other = nullptr;
+  size_t msgs = 0;
+
+  void trace(ObjectStack& st) const
+  {
+    if (other != nullptr)
+      st.push(other);
+  }
+};
+
+static std::unique_ptr<std::atomic<size_t>[]> runs;
+
+struct Receive : public VBehaviour<Receive>
+{
+  Receiver* r;
+  size_t id;
+
+  Receive(Receiver* r, size_t id) : r(r), id(id) {}
+
+  void f()
+  {
+    check(runs[id].fetch_add(1, std::memory_order_relaxed) == 0);
+    r->msgs++;
+
+    if ((id % 8) == 0)
+      Scheduler::want_ld();
+  }
+};
+
+static void
+produce(std::vector<Receiver*> receivers, size_t first_id, size_t count)
+{
+  while (!Scheduler::can_inject())
+    std::this_thread::yield();
+
+  for (size_t i = 0; i < count; i++)
+  {
+    auto* r = receivers[(first_id + i) % receivers.size()];
+    Cown::schedule<Receive>(r, r, first_id + i);
+  }
+
+  auto* alloc = ThreadAlloc::get();
+  for (auto* r : receivers)
+    Cown::release(alloc, r);
+
+  Scheduler::remove_external_event_source();
+}
+
+void test_inject(
+  SystematicTestHarness& h,
+  size_t producer_count,
+  size_t receiver_count,
+  size_t messages)
+{
+  Scheduler& sched = Scheduler::get();
+  sched.init(h.cores);
+
+  const auto total = producer_count * messages;
+  runs = std::make_unique<std::atomic<size_t>[]>(total);
+
+  auto* alloc = ThreadAlloc::get();
+  std::vector<Receiver*> receivers;
+  for (size_t i = 0; i < receiver_count; i++)
+    receivers.push_back(new Receiver);
+
+  // Make a cycle between the first two receivers.
+  receivers[0]->other = receivers[1];
+  receivers[1]->other = receivers[0];
+  Cown::acquire(receivers[0]);
+  Cown::acquire(receivers[1]);
+
+  // Each producer holds a reference to every receiver, and an external event
+  // source, until it has finished.
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < producer_count; p++)
+  {
+    for (auto* r : receivers)
+      Cown::acquire(r);
+    Scheduler::add_external_event_source();
+
+    producers.emplace_back(produce, receivers, p * messages, messages);
+  }
+
+  for (auto* r : receivers)
+    Cown::release(alloc, r);
+
+  sched.run();
+
+  for (auto& t : producers)
+    t.join();
+
+  for (size_t id = 0; id < total; id++)
+    check(runs[id].load(std::memory_order_relaxed) == 1);
+  runs = nullptr;
+
+  if (h.detect_leaks)
+    snmalloc::current_alloc_pool()->debug_check_empty();
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+  const auto producers = h.opt.is<size_t>("--producers", 3);
+  const auto receivers = h.opt.is<size_t>("--receivers", 5);
+  const auto messages = h.opt.is<size_t>("--messages", 200);
+
+  // The producers must be joined before checking for leaks, so this does not
+  // use `h.run`.
+  for (size_t seed = h.seed_lower; seed < h.seed_upper; seed++)
+  {
+    std::cout << "Seed: " << seed << std::endl;
+#ifdef USE_SYSTEMATIC_TESTING
+    Systematic::set_seed(seed);
+#endif
+    test_inject(h, producers, receivers, messages);
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests scheduling lambdas as behaviours.
+ *
+ * A chain of cowns passes a token along using lambdas. Each lambda receives
+ * the cown it runs on as a capture, which is traced while the behaviour is
+ * pending. Every few hops, a lambda is also scheduled on two adjacent cowns at
+ * once.
+ *
+ * Each cown checks on destruction that it was visited the expected number of
+ * times, and each lambda marks its cowns as held while it runs, so that a
+ * lambda on two cowns can check that it holds both at once.
+ **/
+
+struct Node : public VCown<Node>
+{
+  Node* next = nullptr;
+  size_t visits = 0;
+  size_t visits_expected = 0;
+  bool held = false;
+
+  ~Node()
+  {
+    check(visits == visits_expected);
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    if (next != nullptr)
+      st.push(next);
+  }
+};
+
+static void pass(Node* node, size_t hops)
+{
+  Cown::schedule(
+    node,
+    [](Node* n, size_t h) {
+      check(!n->held);
+      n->held = true;
+      n->visits++;
+      yield();
+      n->held = false;
+
+      if (h == 0)
+        return;
+
+      if ((h % 4) == 0)
+      {
+        Cown* both[2] = {n, n->next};
+        Cown::schedule(
+          2,
+          both,
+          [](Node* a, Node* b) {
+            check(a->next == b);
+            check(!a->held && !b->held);
+            a->held = true;
+            b->held = true;
+            a->visits++;
+            b->visits++;
+            yield();
+            check(a->held && b->held);
+            a->held = false;
+            b->held = false;
+          },
+          n,
+          n->next);
+      }
+
+      pass(n->next, h - 1);
+    },
+    node,
+    hops);
+}
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+  constexpr size_t chain_length = 8;
+
+  // Each node holds a reference to the next one. The node reached with `h`
+  // hops to go is visited once by the token, and once more by each lambda on
+  // two cowns scheduled with it or its predecessor.
+  Node* first = new Node;
+  Node* last = first;
+  for (size_t i = 0; i < chain_length; i++)
+  {
+    size_t h = chain_length - 1 - i;
+    last->visits_expected = 1;
+    if ((h != 0) && ((h % 4) == 0))
+      last->visits_expected++;
+    if ((i != 0) && (((h + 1) % 4) == 0))
+      last->visits_expected++;
+
+    if (i + 1 < chain_length)
+    {
+      last->next = new Node;
+      last = last->next;
+    }
+  }
+
+  pass(first, chain_length - 1);
+
+  Cown::release(alloc, first);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests pinned cowns.
+ *
+ * A number of cowns are pinned to scheduler threads, and many behaviours are
+ * sent to them, both alone and together with unpinned cowns, so that there is
+ * plenty of work for other threads to steal. Every behaviour involving a
+ * pinned cown checks that it is running on that cown's thread.
+ *
+ * Some of the pinned cowns hold references to each other, and one is only
+ * reachable from a cycle, so that the leak detector has to collect pinned
+ * cowns.
+ *
+ * Pinning is only allowed until a cown is sent a message, which is checked
+ * on a cown that is sent work without being pinned.
+ **/
+
+struct Pinned : public VCown<Pinned>
+{
+  Pinned* other = nullptr;
+  size_t count = 0;
+
+  void trace(ObjectStack& st) const
+  {
+    if (other != nullptr)
+      st.push(other);
+  }
+};
+
+struct Unpinned : public VCown<Unpinned>
+{
+  size_t count = 0;
+};
+
+static void check_thread(Pinned* p)
+{
+  check(Scheduler::local() == p->pinned_thread());
+}
+
+struct Alone : public VBehaviour<Alone>
+{
+  Pinned* p;
+  size_t remaining;
+
+  Alone(Pinned* p, size_t remaining) : p(p), remaining(remaining) {}
+
+  void f()
+  {
+    check_thread(p);
+    p->count++;
+
+    if (remaining > 0)
+      Cown::schedule<Alone>(p, p, remaining - 1);
+  }
+};
+
+struct Together : public VBehaviour<Together>
+{
+  Pinned* p;
+  Unpinned* q;
+
+  Together(Pinned* p, Unpinned* q) : p(p), q(q) {}
+
+  void f()
+  {
+    check_thread(p);
+    p->count++;
+    q->count++;
+  }
+};
+
+struct Spin : public VBehaviour<Spin>
+{
+  Unpinned* q;
+  size_t remaining;
+
+  Spin(Unpinned* q, size_t remaining) : q(q), remaining(remaining) {}
+
+  void f()
+  {
+    q->count++;
+
+    if (remaining > 0)
+      Cown::schedule<Spin>(q, q, remaining - 1);
+  }
+};
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+  constexpr size_t pinned_count = 6;
+  constexpr size_t unpinned_count = 6;
+
+  Pinned* pinned[pinned_count];
+  for (size_t i = 0; i < pinned_count; i++)
+  {
+    pinned[i] = new Pinned;
+    pinned[i]->pin();
+  }
+
+  Unpinned* unpinned[unpinned_count];
+  for (size_t i = 0; i < unpinned_count; i++)
+  {
+    unpinned[i] = new Unpinned;
+    check(unpinned[i]->can_pin());
+  }
+
+  // Make a cycle between the first two pinned cowns.
+  pinned[0]->other = pinned[1];
+  pinned[1]->other = pinned[0];
+  Cown::acquire(pinned[0]);
+  Cown::acquire(pinned[1]);
+
+  for (size_t i = 0; i < pinned_count; i++)
+    Cown::schedule<Alone>(pinned[i], pinned[i], (size_t)20);
+
+  for (size_t i = 0; i < unpinned_count; i++)
+  {
+    Cown::schedule<Spin>(unpinned[i], unpinned[i], (size_t)20);
+    check(!unpinned[i]->can_pin());
+
+    for (size_t j = 0; j < pinned_count; j++)
+    {
+      Cown* cowns[2] = {unpinned[i], pinned[j]};
+      Cown::schedule<Together>(2, cowns, pinned[j], unpinned[i]);
+    }
+  }
+
+  for (size_t i = 0; i < pinned_count; i++)
+    Cown::release(alloc, pinned[i]);
+  for (size_t i = 0; i < unpinned_count; i++)
+    Cown::release(alloc, unpinned[i]);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <test/harness.h>
+
+/**
+ * Tests for promises.
+ *
+ * A number of clients send requests to a server. Each request carries a
+ * promise, which the server fulfils with its response. The client registers a
+ * continuation on the promise, which checks the response on the client.
+ *
+ * Each client also waits on all of its responses with `when_all`, and checks
+ * that they have all arrived.
+ *
+ * Finally, a continuation is registered on a promise that is never fulfilled.
+ * When the promise is released, the continuation must be dropped without
+ * running, releasing its reference to the client.
+ **/
+
+static constexpr size_t requests = 8;
+
+struct Server : public VCown<Server>
+{
+  size_t handled = 0;
+};
+
+struct Client : public VCown<Client>
+{
+  size_t responses = 0;
+};
+
+using Response = Promise<size_t>;
+
+struct Request : public VBehaviour<Request>
+{
+  Server* server;
+  Response* response;
+  size_t n;
+
+  Request(Server* server, Response* response, size_t n)
+  : server(server), response(response), n(n)
+  {}
+
+  void f()
+  {
+    server->handled++;
+    response->fulfill(n * n);
+    Cown::release(ThreadAlloc::get(), response);
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    st.push(response);
+  }
+};
+
+struct OnResponse : public VBehaviour<OnResponse>
+{
+  Client* client;
+  Response* response;
+  size_t n;
+
+  OnResponse(Client* client, Response* response, size_t n)
+  : client(client), response(response), n(n)
+  {}
+
+  void f()
+  {
+    check(response->is_fulfilled());
+    check(response->get() == n * n);
+    client->responses++;
+    Cown::release(ThreadAlloc::get(), response);
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    st.push(response);
+  }
+};
+
+struct OnAllResponses : public VBehaviour<OnAllResponses>
+{
+  Client* client;
+  Response** responses;
+
+  OnAllResponses(Client* client, Response** responses)
+  : client(client), responses(responses)
+  {}
+
+  void f()
+  {
+    size_t sum = 0;
+    for (size_t i = 0; i < requests; i++)
+    {
+      check(responses[i]->is_fulfilled());
+      sum += responses[i]->get();
+      Cown::release(ThreadAlloc::get(), responses[i]);
+    }
+
+    check(sum == ((requests - 1) * requests * (2 * requests - 1)) / 6);
+    ThreadAlloc::get()->dealloc(responses, requests * sizeof(Response*));
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    for (size_t i = 0; i < requests; i++)
+      st.push(responses[i]);
+  }
+};
+
+struct Never : public VBehaviour<Never>
+{
+  Client* client;
+
+  Never(Client* client) : client(client) {}
+
+  void f()
+  {
+    check(false);
+  }
+
+  void trace(ObjectStack& st) const
+  {
+    st.push(client);
+  }
+};
+
+void run_test()
+{
+  auto* alloc = ThreadAlloc::get();
+  auto* server = new Server;
+
+  for (size_t c = 0; c < 4; c++)
+  {
+    auto* client = new Client;
+    auto** all = (Response**)alloc->alloc(requests * sizeof(Response*));
+
+    for (size_t n = 0; n < requests; n++)
+    {
+      auto* response = new Response;
+      all[n] = response;
+
+      // References held by the continuations and by the request.
+      Cown::acquire(response);
+      Cown::acquire(response);
+      Cown::acquire(response);
+
+      response->then<OnResponse>(client, client, response, n);
+      Cown::schedule<Request>(server, server, response, n);
+    }
+
+    PromiseBase* promises[requests];
+    for (size_t n = 0; n < requests; n++)
+      promises[n] = all[n];
+    PromiseBase::when_all<OnAllResponses>(
+      requests, promises, 1, (Cown**)&client, client, all);
+
+    // Release the references held by this function.
+    for (size_t n = 0; n < requests; n++)
+      Cown::release(alloc, all[n]);
+
+    // This continuation is dropped when the promise is released. The
+    // reference to the client transferred to it must be released with it.
+    auto* never = new Response;
+    Cown::acquire(client);
+    never->then<Never, YesTransfer>(client, client);
+    Cown::release(alloc, never);
+
+    Cown::release(alloc, client);
+  }
+
+  Cown::release(alloc, server);
+}
+
+int main(int argc, char** argv)
+{
+  SystematicTestHarness h(argc, argv);
+
+  h.run(run_test);
+
+  return 0;
+}
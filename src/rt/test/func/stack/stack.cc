@@ -0,0 +1,118 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+#include <ds/stack.h>
+#include <test/harness.h>
+
+/**
+ * Tests the block structured stack.
+ *
+ * Bulk pushes are made onto stacks holding a varying number of elements, so
+ * that they start from an empty stack, from a partially filled block and from
+ * a full block, and some of them cross into a new block. The elements must
+ * then be popped in reverse order.
+ *
+ * The per-thread block cache is checked to supply the blocks of a new stack
+ * from those released by an earlier one.
+ **/
+
+struct Item
+{};
+
+using ItemStack = Stack<Item, Alloc>;
+
+static constexpr size_t BLOCK_ITEMS = 63;
+static constexpr size_t ITEM_COUNT = 4 * BLOCK_ITEMS;
+
+static Item items[ITEM_COUNT];
+
+void test_push_many(Alloc* alloc, size_t before, size_t count)
+{
+  ItemStack s(alloc);
+
+  for (size_t i = 0; i < before; i++)
+    s.push(&items[i]);
+
+  Item* bulk[BLOCK_ITEMS];
+  for (size_t i = 0; i < count; i++)
+    bulk[i] = &items[before + i];
+  s.push_many(bulk, count);
+
+  for (size_t i = before + count; i > 0; i--)
+  {
+    check(!s.empty());
+    check(s.pop() == &items[i - 1]);
+  }
+  check(s.empty());
+}
+
+void test_push_variadic(Alloc* alloc, size_t before)
+{
+  ItemStack s(alloc);
+
+  for (size_t i = 0; i < before; i++)
+    s.push(&items[i]);
+
+  s.push(&items[before], &items[before + 1], &items[before + 2]);
+
+  for (size_t i = before + 3; i > 0; i--)
+    check(s.pop() == &items[i - 1]);
+  check(s.empty());
+}
+
+void test_block_cache(Alloc* alloc)
+{
+  ItemStack::BlockCache::enable();
+
+  {
+    ItemStack s(alloc);
+    for (size_t i = 0; i < ITEM_COUNT; i++)
+      s.push(&items[i]);
+  }
+
+  // The blocks of the stack above have been cached on this thread.
+  void* block = ItemStack::BlockCache::take();
+  check(block != nullptr);
+  check(ItemStack::BlockCache::put(block));
+
+  {
+    // Fill a stack of the same size, which takes every cached block.
+    ItemStack s(alloc);
+    for (size_t i = 0; i < ITEM_COUNT; i++)
+      s.push(&items[i]);
+    check(ItemStack::BlockCache::take() == nullptr);
+
+    for (size_t i = ITEM_COUNT; i > 0; i--)
+      check(s.pop() == &items[i - 1]);
+  }
+
+  ItemStack::BlockCache::flush(alloc);
+  check(ItemStack::BlockCache::take() == nullptr);
+
+  // Flushing disables the cache, so released blocks go back to the allocator.
+  {
+    ItemStack s(alloc);
+    s.push(&items[0]);
+  }
+  check(ItemStack::BlockCache::take() == nullptr);
+}
+
+int main(int, char**)
+{
+  auto* alloc = ThreadAlloc::get();
+
+  // Each starting point is: an empty stack, a partially filled block, a full
+  // block, and a block one short of full.
+  const size_t starts[] = {0, 10, BLOCK_ITEMS, BLOCK_ITEMS - 1};
+  for (auto before : starts)
+  {
+    for (size_t count = 0; count <= BLOCK_ITEMS; count++)
+      test_push_many(alloc, before, count);
+
+    test_push_variadic(alloc, before);
+  }
+
+  test_block_cache(alloc);
+
+  current_alloc_pool()->debug_check_empty();
+  return 0;
+}
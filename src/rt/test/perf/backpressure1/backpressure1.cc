@@ -11,6 +11,9 @@
  * higher rate than they could process the messages. The muted proxies may also
  * experience similar queue growth if the backpressure is not corretly
  * propagated from the receiver set.
+ *
+ * The receivers may be given bounded queues with `--queue_capacity`, so that
+ * their senders are muted as soon as the queue is full.
  */
 
 #include "test/log.h"
@@ -139,9 +142,13 @@ int main(int argc, char** argv)
   auto receivers = opt.is<size_t>("--receivers", 1);
   auto proxies = opt.is<size_t>("--proxies", 0);
   auto duration = opt.is<size_t>("--duration", 10'000);
+  auto overload_threshold = opt.is<size_t>(
+    "--overload_threshold", Status::default_overload_threshold);
+  auto queue_capacity = opt.is<size_t>("--queue_capacity", 0);
   logger::cout() << "cores: " << cores << ", senders: " << senders
                  << ", receivers: " << receivers << ", duration: " << duration
-                 << "ms" << std::endl;
+                 << "ms, overload_threshold: " << overload_threshold
+                 << ", queue_capacity: " << queue_capacity << std::endl;
 
 #ifdef USE_SYSTEMATIC_TESTING
   Systematic::enable_logging();
@@ -150,6 +157,7 @@ int main(int argc, char** argv)
   UNUSED(seed);
 #endif
   Scheduler::set_detect_leaks(true);
+  Scheduler::set_overload_threshold((uint32_t)overload_threshold);
   auto& sched = Scheduler::get();
   sched.set_fair(true);
   sched.init(cores);
@@ -157,7 +165,11 @@ int main(int argc, char** argv)
   auto* alloc = ThreadAlloc::get();
 
   for (size_t r = 0; r < receivers; r++)
-    receiver_set.push_back(new (alloc) Receiver);
+  {
+    auto* receiver = new (alloc) Receiver;
+    receiver->set_queue_capacity(queue_capacity);
+    receiver_set.push_back(receiver);
+  }
 
   for (size_t p = 0; p < proxies; p++)
     proxy_chain.push_back(new (alloc) Proxy(p));
@@ -127,15 +127,19 @@ int main(int argc, char** argv)
   const auto senders = opt.is<size_t>("--senders", 100);
   const auto receivers = opt.is<size_t>("--receivers", 10);
   const auto duration = opt.is<size_t>("--duration", 10'000);
+  const auto overload_threshold = opt.is<size_t>(
+    "--overload_threshold", Status::default_overload_threshold);
   logger::cout() << "cores: " << cores << ", senders: " << senders
                  << ", receivers: " << receivers << ", duration: " << duration
-                 << "ms" << std::endl;
+                 << "ms, overload_threshold: " << overload_threshold
+                 << std::endl;
 
 #ifdef USE_SYSTEMATIC_TESTING
   Systematic::enable_logging();
   Systematic::set_seed(seed);
 #endif
   Scheduler::set_detect_leaks(true);
+  Scheduler::set_overload_threshold((uint32_t)overload_threshold);
   auto& sched = Scheduler::get();
   sched.set_fair(true);
   sched.init(cores);
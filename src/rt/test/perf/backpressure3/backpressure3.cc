@@ -119,15 +119,20 @@ int main(int argc, char** argv)
   const auto senders = opt.is<size_t>("--senders", 100);
   const auto duration =
     std::chrono::milliseconds(opt.is<size_t>("--duration", 10'000));
+  const auto overload_threshold = opt.is<size_t>(
+    "--overload_threshold", Status::default_overload_threshold);
 
   logger::cout() << "cores: " << cores << ", senders: " << senders
-                 << ", duration: " << duration.count() << "ms" << std::endl;
+                 << ", duration: " << duration.count()
+                 << "ms, overload_threshold: " << overload_threshold
+                 << std::endl;
 
 #ifdef USE_SYSTEMATIC_TESTING
   Systematic::enable_logging();
   Systematic::set_seed(seed);
 #endif
   Scheduler::set_detect_leaks(true);
+  Scheduler::set_overload_threshold((uint32_t)overload_threshold);
   auto& sched = Scheduler::get();
   sched.set_fair(true);
   sched.init(cores);
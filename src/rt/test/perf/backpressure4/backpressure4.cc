@@ -0,0 +1,174 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+
+/**
+ * This benchmark creates long mute chains. Many `Sender` cowns send messages
+ * into a number of `Link` chains, where each link forwards every message to
+ * the next link and the final links forward to a single slow `Receiver`.
+ *
+ * Once the receiver is overloaded, the final links are muted. Those links are
+ * themselves mutors of the links before them, and so on back to the senders,
+ * so the mute maps of the scheduler threads contain many entries whose mute
+ * sets contain other mutors. Unmuting the receiver must then unmute each chain
+ * in turn. The total throughput of the receiver is reported at the end of the
+ * run.
+ */
+
+#include "test/log.h"
+#include "test/opt.h"
+#include "verona.h"
+
+#include <chrono>
+
+using namespace verona::rt;
+using timer = std::chrono::high_resolution_clock;
+
+static size_t received = 0;
+
+struct Receiver : public VCown<Receiver>
+{
+  size_t work;
+
+  Receiver(size_t work_) : work(work_) {}
+};
+
+struct Receive : public VBehaviour<Receive>
+{
+  Receiver* r;
+
+  Receive(Receiver* r_) : r(r_) {}
+
+  void f()
+  {
+    // Simulate a slow receiver so that it becomes overloaded.
+    volatile size_t sink = 0;
+    for (size_t i = 0; i < r->work; i++)
+      sink = sink + i;
+
+    received++;
+  }
+};
+
+struct Link : public VCown<Link>
+{
+  Link* next;
+  Receiver* receiver;
+
+  Link(Link* next_, Receiver* receiver_) : next(next_), receiver(receiver_) {}
+
+  void trace(ObjectStack& st) const
+  {
+    if (next != nullptr)
+      st.push(next);
+    else
+      st.push(receiver);
+  }
+};
+
+struct Forward : public VBehaviour<Forward>
+{
+  Link* link;
+
+  Forward(Link* link_) : link(link_) {}
+
+  void f()
+  {
+    if (link->next != nullptr)
+      Cown::schedule<Forward>(link->next, link->next);
+    else
+      Cown::schedule<Receive>(link->receiver, link->receiver);
+  }
+};
+
+struct Sender : public VCown<Sender>
+{
+  Link* head;
+  timer::time_point start = timer::now();
+  timer::duration duration;
+
+  Sender(Link* head_, timer::duration duration_)
+  : head(head_), duration(duration_)
+  {}
+
+  void trace(ObjectStack& st) const
+  {
+    st.push(head);
+  }
+};
+
+struct Send : public VBehaviour<Send>
+{
+  Sender* s;
+
+  Send(Sender* s_) : s(s_) {}
+
+  void f()
+  {
+    Cown::schedule<Forward>(s->head, s->head);
+
+    if ((timer::now() - s->start) < s->duration)
+      Cown::schedule<Send>(s, s);
+  }
+};
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+  const auto seed = opt.is<size_t>("--seed", 5489);
+  const auto cores = opt.is<size_t>("--cores", 4);
+  const auto chains = opt.is<size_t>("--chains", 16);
+  const auto depth = opt.is<size_t>("--depth", 8);
+  const auto senders = opt.is<size_t>("--senders", 8);
+  const auto work = opt.is<size_t>("--work", 1'000);
+  const auto duration =
+    std::chrono::milliseconds(opt.is<size_t>("--duration", 10'000));
+  logger::cout() << "cores: " << cores << ", chains: " << chains
+                 << ", depth: " << depth << ", senders per chain: " << senders
+                 << ", work: " << work << ", duration: " << duration.count()
+                 << "ms" << std::endl;
+
+#ifdef USE_SYSTEMATIC_TESTING
+  Systematic::enable_logging();
+  Systematic::set_seed(seed);
+#else
+  UNUSED(seed);
+#endif
+  Scheduler::set_detect_leaks(true);
+  auto& sched = Scheduler::get();
+  sched.set_fair(true);
+  sched.init(cores);
+
+  auto* alloc = ThreadAlloc::get();
+  auto* receiver = new (alloc) Receiver(work);
+  const auto start = timer::now();
+
+  for (size_t c = 0; c < chains; c++)
+  {
+    Link* head = nullptr;
+    for (size_t d = 0; d < depth; d++)
+    {
+      // Each link holds a reference to the next link, or to the receiver.
+      if (head == nullptr)
+        Cown::acquire(receiver);
+      head = new (alloc) Link(head, receiver);
+    }
+
+    for (size_t i = 0; i < senders; i++)
+    {
+      Cown::acquire(head);
+      auto* s = new (alloc) Sender(head, duration);
+      Cown::schedule<Send, YesTransfer>(s, s);
+    }
+
+    Cown::release(alloc, head);
+  }
+
+  Cown::release(alloc, receiver);
+
+  sched.run();
+
+  const auto t =
+    std::chrono::duration_cast<std::chrono::milliseconds>(timer::now() - start);
+  logger::cout() << received << " messages received in " << t.count() << "ms"
+                 << std::endl;
+}
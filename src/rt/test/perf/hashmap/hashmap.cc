@@ -0,0 +1,114 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Compare the Robin Hood `ObjectMap` against the `SwissObjectMap`, which probes
+ * a group of control bytes at a time, for insertion, successful and
+ * unsuccessful lookups, iteration, and erasure.
+ */
+
+#include "ds/hashmap.h"
+#include "ds/swissmap.h"
+
+#include <iomanip>
+#include <iostream>
+#include <test/harness.h>
+#include <test/measuretime.h>
+#include <test/xoroshiro.h>
+
+using namespace snmalloc;
+
+struct Key : public VCown<Key>
+{};
+
+template<template<typename> class MapType>
+void bench(
+  const char* name,
+  std::vector<Key*>& keys,
+  std::vector<Key*>& missing,
+  size_t lookups)
+{
+  auto* alloc = ThreadAlloc::get();
+  MapType<std::pair<Key*, size_t>> map(alloc);
+  const auto size = keys.size();
+
+  DO_TIME(name << " insert: " << std::setw(10) << size, {
+    for (size_t i = 0; i < size; i++)
+      map.insert(alloc, std::make_pair(keys[i], i));
+  });
+
+  size_t found = 0;
+  DO_TIME(name << " find:   " << std::setw(10) << size, {
+    for (size_t n = 0; n < lookups; n++)
+    {
+      for (auto* k : keys)
+        found += map.find(k) != map.end();
+    }
+  });
+  check(found == (size * lookups));
+
+  size_t not_found = 0;
+  DO_TIME(name << " miss:   " << std::setw(10) << size, {
+    for (size_t n = 0; n < lookups; n++)
+    {
+      for (auto* k : missing)
+        not_found += map.find(k) == map.end();
+    }
+  });
+  check(not_found == (missing.size() * lookups));
+
+  size_t sum = 0;
+  DO_TIME(name << " iterate:" << std::setw(10) << size, {
+    for (size_t n = 0; n < lookups; n++)
+    {
+      for (auto it = map.begin(); it != map.end(); ++it)
+        sum += it.value();
+    }
+  });
+  check(sum == (lookups * ((size * (size - 1)) / 2)));
+
+  DO_TIME(name << " erase:  " << std::setw(10) << size, {
+    for (auto* k : keys)
+      map.erase(k);
+  });
+  check(map.size() == 0);
+
+  map.clear(alloc);
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+  const auto seed = opt.is<size_t>("--seed", 5489);
+  const auto max_size = opt.is<size_t>("--max_size", 1'000'000);
+  const auto lookups = opt.is<size_t>("--lookups", 4);
+
+  auto* alloc = ThreadAlloc::get();
+  xoroshiro::p128r64 rng{seed};
+
+  for (size_t size = 16; size <= max_size; size *= 4)
+  {
+    std::vector<Key*> keys;
+    std::vector<Key*> missing;
+    for (size_t i = 0; i < size; i++)
+    {
+      keys.push_back(new (alloc) Key);
+      missing.push_back(new (alloc) Key);
+    }
+
+    // Look up keys in a different order than they were allocated in.
+    for (size_t i = size - 1; i > 0; i--)
+      std::swap(keys[i], keys[rng.next() % (i + 1)]);
+
+    bench<ObjectMap>("ObjectMap     ", keys, missing, lookups);
+    bench<SwissObjectMap>("SwissObjectMap", keys, missing, lookups);
+
+    for (auto* k : keys)
+      Cown::release(alloc, k);
+    for (auto* k : missing)
+      Cown::release(alloc, k);
+  }
+
+  snmalloc::current_alloc_pool()->debug_check_empty();
+  return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Measures the throughput of behaviours scheduled from threads outside the
+ * runtime.
+ *
+ * A number of producer threads, which are not scheduler threads, each send a
+ * fixed number of behaviours to a set of receiver cowns, round robin. The
+ * behaviours pass through the scheduler threads' inboxes. Each producer holds
+ * an external event source until it is done, so that the runtime is not torn
+ * down under it.
+ *
+ * Reports the rate at which the producers injected behaviours, and the rate at
+ * which they were run.
+ */
+
+#include "test/log.h"
+#include "test/opt.h"
+#include "verona.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace verona::rt;
+using timer = std::chrono::high_resolution_clock;
+
+struct Receiver : public VCown<Receiver>
+{
+  size_t msgs = 0;
+};
+
+static std::atomic<size_t> remaining;
+static timer::time_point finished;
+
+struct Receive : public VBehaviour<Receive>
+{
+  Receiver* r;
+
+  Receive(Receiver* r) : r(r) {}
+
+  void f()
+  {
+    r->msgs++;
+
+    if (remaining.fetch_sub(1, std::memory_order_relaxed) == 1)
+      finished = timer::now();
+  }
+};
+
+static void
+produce(std::vector<Receiver*>& receivers, size_t offset, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    auto* r = receivers[(offset + i) % receivers.size()];
+    Cown::schedule<Receive>(r, r);
+  }
+
+  auto* alloc = ThreadAlloc::get();
+  for (auto* r : receivers)
+    Cown::release(alloc, r);
+
+  Scheduler::remove_external_event_source();
+}
+
+static double rate(size_t count, timer::duration d)
+{
+  return (double)count / std::chrono::duration<double>(d).count();
+}
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+  const auto cores = opt.is<size_t>("--cores", 4);
+  const auto producers = opt.is<size_t>("--producers", 4);
+  const auto receivers = opt.is<size_t>("--receivers", 100);
+  const auto messages = opt.is<size_t>("--messages", 100'000);
+  logger::cout() << "cores: " << cores << ", producers: " << producers
+                 << ", receivers: " << receivers
+                 << ", messages per producer: " << messages << std::endl;
+
+  auto& sched = Scheduler::get();
+  sched.init(cores);
+
+  auto* alloc = ThreadAlloc::get();
+  std::vector<Receiver*> receiver_set;
+  for (size_t i = 0; i < receivers; i++)
+    receiver_set.push_back(new (alloc) Receiver);
+
+  remaining = producers * messages;
+
+  // Each producer holds a reference to every receiver, and an external event
+  // source, until it has finished.
+  std::vector<std::thread> threads;
+  const auto start = timer::now();
+  for (size_t p = 0; p < producers; p++)
+  {
+    for (auto* r : receiver_set)
+      Cown::acquire(r);
+    Scheduler::add_external_event_source();
+
+    threads.emplace_back(produce, std::ref(receiver_set), p, messages);
+  }
+
+  for (auto* r : receiver_set)
+    Cown::release(alloc, r);
+
+  std::thread joiner([&threads, start, producers, messages]() {
+    for (auto& t : threads)
+      t.join();
+
+    logger::cout() << "injected: "
+                   << rate(producers * messages, timer::now() - start)
+                   << " behaviours/s" << std::endl;
+  });
+
+  sched.run();
+  joiner.join();
+
+  logger::cout() << "completed: "
+                 << rate(producers * messages, finished - start)
+                 << " behaviours/s" << std::endl;
+}
@@ -0,0 +1,61 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Compares the cost of a hot loop that logs through `VERONA_LOG()` with the
+ * same loop calling `Systematic::cout()` directly, and with no logging at all.
+ *
+ * The logged operand has a side effect, so the optimiser cannot remove it from
+ * the `Systematic::cout()` loop. Unless systematic testing or the flight
+ * recorder is compiled in, `VERONA_LOG()` must not evaluate it, and its loop
+ * should take the same time as the loop without logging.
+ */
+
+#include <test/harness.h>
+#include <test/log.h>
+#include <test/measuretime.h>
+
+static std::atomic<size_t> evaluated{0};
+
+static size_t operand(size_t n)
+{
+  evaluated.fetch_add(1, std::memory_order_relaxed);
+  return n;
+}
+
+void test_log()
+{
+  // Used to prevent the loops from being optimised away.
+  static volatile size_t sink = 0;
+
+  constexpr size_t count = 10000000;
+
+  DO_TIME(
+    "no_logging      ", for (size_t n = 0; n < count; n++) { sink = n; });
+
+  DO_TIME(
+    "verona_log      ", for (size_t n = 0; n < count; n++) {
+      sink = n;
+      VERONA_LOG() << operand(n) << std::endl;
+    });
+  const auto verona_log_evaluated = evaluated.exchange(0);
+
+  DO_TIME(
+    "systematic_cout ", for (size_t n = 0; n < count; n++) {
+      sink = n;
+      Systematic::cout() << operand(n) << std::endl;
+    });
+  const auto cout_evaluated = evaluated.exchange(0);
+
+  logger::cout() << "operands evaluated: VERONA_LOG " << verona_log_evaluated
+                 << ", Systematic::cout " << cout_evaluated << std::endl;
+
+  check(Systematic::logging || (verona_log_evaluated == 0));
+  check(cout_evaluated == count);
+}
+
+int main(int, char**)
+{
+  test_log();
+  return 0;
+}
@@ -14,6 +14,10 @@
  * may randomly choose to include itself in the forwarded `Ping` multi-message
  * along with the selected recipient. By default 5% of `Ping` messages will
  * become these multi-messages.
+ *
+ * With `--temp_allocs N`, each `Ping` also allocates and fills N temporary
+ * buffers of `--temp_bytes` bytes, either from snmalloc or, with `--scratch`,
+ * from the scheduler thread's scratch memory.
  */
 
 #include "test/log.h"
@@ -30,6 +34,10 @@ namespace rt = verona::rt;
 static rt::Cown** all_cowns = nullptr;
 static size_t all_cowns_count = 0;
 
+static size_t temp_allocs = 0;
+static size_t temp_bytes = 0;
+static bool use_scratch = false;
+
 namespace ubench
 {
   struct Pinger : public rt::VCown<Pinger>
@@ -39,6 +47,7 @@ namespace ubench
     size_t select_mod = 0;
     bool running = false;
     size_t count = 0;
+    size_t checksum = 0;
 
     Pinger(vector<Pinger*>& pingers_, size_t seed, size_t percent_multimessage)
     : pingers(pingers_), rng(seed)
@@ -75,6 +84,33 @@ namespace ubench
     }
   };
 
+  /// Fill a temporary buffer, so that its allocation cannot be elided.
+  static void use_temporary(Pinger* pinger, uint8_t* buf)
+  {
+    buf[0] = (uint8_t)pinger->count;
+    buf[temp_bytes - 1] = buf[0];
+    pinger->checksum += buf[temp_bytes - 1];
+  }
+
+  static void temporaries(Pinger* pinger)
+  {
+    for (size_t i = 0; i < temp_allocs; i++)
+    {
+      if (use_scratch)
+      {
+        auto buf = rt::Scratch::make<uint8_t>(temp_bytes);
+        use_temporary(pinger, buf.data());
+      }
+      else
+      {
+        auto* alloc = sn::ThreadAlloc::get();
+        auto* buf = (uint8_t*)alloc->alloc(temp_bytes);
+        use_temporary(pinger, buf);
+        alloc->dealloc(buf, temp_bytes);
+      }
+    }
+  }
+
   struct Ping : public rt::VBehaviour<Ping>
   {
     Pinger* pinger;
@@ -88,6 +124,7 @@ namespace ubench
         return;
 
       pinger->count++;
+      temporaries(pinger);
 
       recipients[0] = pinger;
       const bool send_multimessage = (pinger->pingers.size() > 1) &&
@@ -235,13 +272,20 @@ int main(int argc, char** argv)
   const auto initial_pings = opt.is<size_t>("--initial_pings", 5);
   const auto percent_multimessage = opt.is<size_t>("--percent_multimessage", 5);
   check(percent_multimessage <= 100);
+  const auto trace = opt.has("--trace");
+  temp_allocs = opt.is<size_t>("--temp_allocs", 0);
+  temp_bytes = opt.is<size_t>("--temp_bytes", 64);
+  use_scratch = opt.has("--scratch");
+  check(temp_bytes > 0);
 
   logger::cout() << "cores: " << cores
                  << ", report_interval: " << report_interval.count()
                  << ", pingers: " << pingers
                  << ", initial_pings: " << initial_pings
                  << ", percent_mutlimessage: " << percent_multimessage
-                 << std::endl;
+                 << ", temp_allocs: " << temp_allocs
+                 << ", temp_bytes: " << temp_bytes
+                 << ", scratch: " << use_scratch << std::endl;
 
   auto* alloc = sn::ThreadAlloc::get();
 #ifdef USE_SYSTEMATIC_TESTING
@@ -250,6 +294,9 @@ int main(int argc, char** argv)
 #else
   UNUSED(seed);
 #endif
+  if (trace)
+    rt::Trace::enable();
+
   auto& sched = rt::Scheduler::get();
   sched.set_fair(true);
   sched.init(cores);
@@ -271,5 +318,10 @@ int main(int argc, char** argv)
 
   sched.run();
   alloc->dealloc(all_cowns, all_cowns_count * sizeof(rt::Cown*));
+
+  // Write the scheduler events recorded during the run, for viewing in
+  // chrome://tracing or Perfetto.
+  if (trace)
+    check(rt::Trace::dump("ubench.trace.json"));
   return 0;
 }
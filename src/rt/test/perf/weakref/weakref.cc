@@ -0,0 +1,142 @@
+// Copyright Microsoft and Project Verona Contributors.
+// SPDX-License-Identifier: MIT
+
+/**
+ * Measures the cost of holding and upgrading large numbers of weak references
+ * to cowns.
+ *
+ * A directory of weak references is built over a set of cowns, with each cown
+ * referenced a number of times in a row. The directory is built once with a
+ * weak reference per entry, and once with a weak reference table. Then the
+ * whole directory is upgraded to strong references and released, in batches,
+ * once one reference at a time and once with the bulk operations.
+ *
+ * Everything runs in a single behaviour, so the cowns are owned by a
+ * scheduler thread as they would be in a real program.
+ */
+
+#include "test/log.h"
+#include "test/opt.h"
+#include "verona.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace verona::rt;
+using timer = std::chrono::high_resolution_clock;
+
+struct Entry : public VCown<Entry>
+{};
+
+struct Directory : public VCown<Directory>
+{};
+
+static double rate(size_t count, timer::duration d)
+{
+  return (double)count / std::chrono::duration<double>(d).count();
+}
+
+struct Bench : public VBehaviour<Bench>
+{
+  size_t cowns;
+  size_t repeat;
+  size_t batch;
+  size_t rounds;
+
+  Bench(size_t cowns, size_t repeat, size_t batch, size_t rounds)
+  : cowns(cowns), repeat(repeat), batch(batch), rounds(rounds)
+  {}
+
+  void f()
+  {
+    auto* alloc = ThreadAlloc::get();
+
+    std::vector<Cown*> entries;
+    for (size_t i = 0; i < cowns; i++)
+      entries.push_back(new (alloc) Entry);
+
+    const size_t refs = cowns * repeat;
+    std::vector<Cown*> weak;
+    for (size_t i = 0; i < refs; i++)
+      weak.push_back(entries[i / repeat]);
+
+    auto start = timer::now();
+    for (auto* c : weak)
+      c->weak_acquire();
+    logger::cout() << "weak refs:   " << rate(refs, timer::now() - start)
+                   << " acquires/s" << std::endl;
+
+    start = timer::now();
+    WeakRefTable<> table(alloc);
+    for (auto* c : weak)
+      table.add(alloc, c);
+    logger::cout() << "weak table:  " << rate(refs, timer::now() - start)
+                   << " adds/s" << std::endl;
+
+    std::vector<Cown*> strong(batch);
+
+    start = timer::now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+      for (size_t i = 0; i < refs; i += batch)
+      {
+        size_t n = std::min(batch, refs - i);
+        for (size_t j = 0; j < n; j++)
+        {
+          Cown* c = weak[i + j];
+          strong[j] = c->acquire_strong_from_weak() ? c : nullptr;
+        }
+        for (size_t j = 0; j < n; j++)
+        {
+          if (strong[j] != nullptr)
+            Cown::release(alloc, strong[j]);
+        }
+      }
+    }
+    logger::cout() << "single:      "
+                   << rate(refs * rounds, timer::now() - start) << " upgrades/s"
+                   << std::endl;
+
+    start = timer::now();
+    for (size_t r = 0; r < rounds; r++)
+    {
+      for (size_t i = 0; i < refs; i += batch)
+      {
+        size_t n = std::min(batch, refs - i);
+        table.upgrade(n, &weak[i], strong.data());
+        Cown::release(alloc, n, strong.data());
+      }
+    }
+    logger::cout() << "bulk:        "
+                   << rate(refs * rounds, timer::now() - start) << " upgrades/s"
+                   << std::endl;
+
+    for (auto* c : weak)
+      c->weak_release(alloc);
+    table.dealloc(alloc);
+
+    for (auto* c : entries)
+      Cown::release(alloc, c);
+  }
+};
+
+int main(int argc, char** argv)
+{
+  opt::Opt opt(argc, argv);
+  const auto cowns = opt.is<size_t>("--cowns", 100'000);
+  const auto repeat = opt.is<size_t>("--repeat", 8);
+  const auto batch = opt.is<size_t>("--batch", 1024);
+  const auto rounds = opt.is<size_t>("--rounds", 10);
+  logger::cout() << "cowns: " << cowns << ", refs per cown: " << repeat
+                 << ", batch: " << batch << ", rounds: " << rounds
+                 << std::endl;
+
+  auto& sched = Scheduler::get();
+  sched.init(1);
+
+  auto* d = new Directory;
+  Cown::schedule<Bench, YesTransfer>(d, cowns, repeat, batch, rounds);
+
+  sched.run();
+}
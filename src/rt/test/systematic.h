@@ -612,4 +612,32 @@ namespace Systematic
     static SysLog cout_log;
     return cout_log;
   }
+
+  /// True if anything can observe the output of `Systematic::cout()`.
+  static constexpr bool logging =
+#if defined(USE_SYSTEMATIC_TESTING) || defined(USE_FLIGHT_RECORDER)
+    true;
+#else
+    false;
+#endif
 } // namespace Systematic
+
+/**
+ * Log to `Systematic::cout()`, e.g.
+ *
+ *   VERONA_LOG() << "Cown " << c << " scheduled" << std::endl;
+ *
+ * Unless systematic testing or the flight recorder is compiled in, the whole
+ * statement is discarded, so none of the operands are evaluated. Calling
+ * `Systematic::cout()` directly relies on the optimiser to remove them, which
+ * it cannot do if they have side effects or live in another translation unit.
+ *
+ * The operands are still type checked in every build. The macro expands to an
+ * `if`, so brace it when it is the body of another `if` to avoid a dangling
+ * `else` warning.
+ */
+#define VERONA_LOG() \
+  if constexpr (!Systematic::logging) \
+  {} \
+  else \
+    Systematic::cout()
@@ -9,6 +9,7 @@
 
 #include "cpp/vbehaviour.h"
 #include "cpp/vobject.h"
+#include "cpp/vpromise.h"
 #include "object/object.h"
 #include "region/externalreference.h"
 #include "region/freeze.h"
@@ -20,6 +21,7 @@
 #include "sched/noticeboard.h"
 #include "sched/schedulerthread.h"
 #include "sched/spmcq.h"
+#include "sched/weakrefs.h"
 #include "test/systematic.h"
 
 #include <snmalloc.h>
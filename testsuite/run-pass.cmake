@@ -13,8 +13,10 @@ if(EXPECTED_DUMP)
   CheckDump(${EXPECTED_DUMP} ${ACTUAL_DUMP})
 endif()
 
+separate_arguments(INTERPRETER_FLAGS UNIX_COMMAND "${INTERPRETER_FLAGS}")
+
 CheckStatus(
-  COMMAND ${INTERPRETER} ${BYTECODE_OUTPUT} 
+  COMMAND ${INTERPRETER} ${BYTECODE_OUTPUT} ${INTERPRETER_FLAGS}
   EXPECTED_STATUS 0
   OUTPUT_FILE ${INTERPRETER_LOG})
 
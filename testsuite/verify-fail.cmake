@@ -0,0 +1,26 @@
+include(${CMAKE_CURRENT_LIST_DIR}/common.cmake)
+
+PrepareTest(VERONAC_FLAGS EXPECTED_DUMP ACTUAL_DUMP)
+
+set(BYTECODE_OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${TEST_NAME}.vbc)
+set(INTERPRETER_LOG ${CMAKE_CURRENT_BINARY_DIR}/${TEST_NAME}.out)
+
+CheckStatus(
+  COMMAND ${PYTHON_EXECUTABLE} ${ASSEMBLE_BYTECODE_PY} ${TEST_FILE}
+    --output=${BYTECODE_OUTPUT}
+  EXPECTED_STATUS 0)
+
+# The interpreter aborts when it finds invalid bytecode, so there is no single
+# exit status to expect.
+string (REPLACE ";" " " cmd_str "${INTERPRETER} ${BYTECODE_OUTPUT}")
+message(STATUS "Executing \"${cmd_str}\"")
+execute_process(
+  COMMAND ${INTERPRETER} ${BYTECODE_OUTPUT}
+  RESULT_VARIABLE code
+  ERROR_FILE ${INTERPRETER_LOG})
+
+if("${code}" STREQUAL "0")
+  message(FATAL_ERROR " \"${cmd_str}\" succeeded, expected it to fail")
+endif()
+
+FileCheck(${TEST_FILE} ${INTERPRETER_LOG})
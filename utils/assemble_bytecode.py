@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+
+# Assemble a textual description of a bytecode program, so that the interpreter
+# can be tested on programs the compiler would never emit.
+#
+# The opcodes, their numbering and their operands are read from
+# src/interpreter/bytecode.h, so the assembler follows changes to the format.
+#
+# Input format, one item per line, with `//` starting a comment:
+#
+#   descriptor Main methods=1 fields=0
+#     method 0 main         // method selector 0 is the function `main`
+#     field 0               // field selector 0
+#     finaliser fin         // optional
+#   entry Main 0            // main descriptor and selector
+#   u64 U64                 // optional
+#
+#   function main argc=1 retc=1 locals=2
+#     Int64 r0 42
+#     Return
+#
+# Instructions are written as the opcode's name followed by its operands,
+# optionally separated by commas. Registers are written `rN`, register lists
+# `[r1, r2]`, strings in double quotes, descriptors and code pointers by name
+# and binary operators by name. Jump offsets are plain integers.
+#
+# Usage:
+#   assemble_bytecode.py input.vasm -o output.vbc
+
+import argparse
+import ast
+import os.path
+import re
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+BYTECODE_H = os.path.join(ROOT, "src", "interpreter", "bytecode.h")
+
+MAGIC_NUMBER = 0xF38932C3
+INVALID_DESCRIPTOR = 0xFFFFFFFF
+
+
+class AssemblyError(Exception):
+  pass
+
+
+def parse_enum(header, name):
+  match = re.search(r"enum class %s : uint8_t\s*\{(.*?)\};" % name, header,
+                    re.DOTALL)
+  if not match:
+    raise AssemblyError("enum %s not found in %s" % (name, BYTECODE_H))
+
+  body = re.sub(r"//[^\n]*", "", match.group(1))
+  values = {}
+  for entry in body.split(","):
+    entry = entry.strip()
+    if entry and "=" not in entry:
+      values[entry] = len(values)
+  return values
+
+
+def parse_specs(header):
+  specs = {}
+  pattern = (r"struct OpcodeSpec<Opcode::(\w+)>\s*\{\s*"
+             r"using Operands\s*=\s*OpcodeOperands<(.*?)>;")
+  for match in re.finditer(pattern, header, re.DOTALL):
+    operands = [o.strip() for o in match.group(2).split(",")]
+    specs[match.group(1)] = [o for o in operands if o]
+  return specs
+
+
+def tokenize(line):
+  return re.findall(r'"(?:[^"\\]|\\.)*"|\[[^\]]*\]|[^\s,]+', line)
+
+
+def attributes(tokens):
+  result = {}
+  for token in tokens:
+    key, _, value = token.partition("=")
+    result[key] = int(value, 0)
+  return result
+
+
+class Descriptor:
+  def __init__(self, name, method_slots, field_slots):
+    self.name = name
+    self.method_slots = method_slots
+    self.field_slots = field_slots
+    self.methods = []
+    self.fields = []
+    self.finaliser = None
+
+
+class Function:
+  def __init__(self, name, argc, retc, locals):
+    self.name = name
+    self.argc = argc
+    self.retc = retc
+    self.locals = locals
+    self.instructions = []
+    self.address = None
+
+
+class Assembler:
+  def __init__(self, header):
+    self.opcodes = parse_enum(header, "Opcode")
+    self.operators = parse_enum(header, "BinaryOperator")
+    self.specs = parse_specs(header)
+    self.descriptors = []
+    self.functions = []
+    self.entry = None
+    self.u64 = None
+
+  def parse(self, text):
+    descriptor = None
+    function = None
+    for number, line in enumerate(text.splitlines(), 1):
+      tokens = tokenize(line.split("//", 1)[0])
+      if not tokens:
+        continue
+
+      try:
+        keyword, args = tokens[0], tokens[1:]
+        if keyword == "descriptor":
+          attrs = attributes(args[1:])
+          descriptor = Descriptor(
+            args[0], attrs.get("methods", 0), attrs.get("fields", 0))
+          self.descriptors.append(descriptor)
+          function = None
+        elif keyword == "method":
+          descriptor.methods.append((int(args[0], 0), args[1]))
+        elif keyword == "field":
+          descriptor.fields.append(int(args[0], 0))
+        elif keyword == "finaliser":
+          descriptor.finaliser = args[0]
+        elif keyword == "entry":
+          self.entry = (args[0], int(args[1], 0))
+        elif keyword == "u64":
+          self.u64 = args[0]
+        elif keyword == "function":
+          attrs = attributes(args[1:])
+          function = Function(
+            args[0], attrs["argc"], attrs["retc"], attrs["locals"])
+          self.functions.append(function)
+          descriptor = None
+        elif function is not None:
+          function.instructions.append((keyword, args))
+        else:
+          raise AssemblyError("unexpected '%s'" % keyword)
+      except (AssemblyError, AttributeError, IndexError, KeyError,
+              ValueError) as e:
+        raise AssemblyError("line %d: %s" % (number, e))
+
+    if self.entry is None:
+      raise AssemblyError("missing entry")
+
+  def descriptor_index(self, name):
+    for i, descriptor in enumerate(self.descriptors):
+      if descriptor.name == name:
+        return i
+    return int(name, 0)
+
+  def function_address(self, name):
+    for function in self.functions:
+      if function.name == name:
+        return function.address
+    raise AssemblyError("unknown function '%s'" % name)
+
+  def encode_operand(self, kind, token):
+    if kind == "Register":
+      if not token.startswith("r"):
+        raise AssemblyError("expected a register, found '%s'" % token)
+      return struct.pack("<B", int(token[1:], 0))
+    elif kind == "RegisterSpan":
+      registers = tokenize(token.strip("[]"))
+      return struct.pack("<B", len(registers)) + b"".join(
+        self.encode_operand("Register", r) for r in registers)
+    elif kind == "BinaryOperator":
+      if token in self.operators:
+        return struct.pack("<B", self.operators[token])
+      return struct.pack("<B", int(token, 0))
+    elif kind == "DescriptorIdx":
+      return struct.pack("<I", self.descriptor_index(token))
+    elif kind == "CodePtr":
+      return struct.pack("<I", self.function_address(token))
+    elif kind == "SelectorIdx":
+      return struct.pack("<I", int(token, 0))
+    elif kind == "uint8_t":
+      return struct.pack("<B", int(token, 0))
+    elif kind == "int16_t":
+      return struct.pack("<h", int(token, 0))
+    elif kind == "uint64_t":
+      return struct.pack("<Q", int(token, 0) & 0xFFFFFFFFFFFFFFFF)
+    elif kind == "std::string_view":
+      return self.encode_string(ast.literal_eval(token))
+    raise AssemblyError("unsupported operand type %s" % kind)
+
+  def encode_string(self, value):
+    data = value.encode("utf-8")
+    return struct.pack("<H", len(data)) + data
+
+  def encode_instruction(self, name, args):
+    if name not in self.opcodes:
+      raise AssemblyError("unknown opcode '%s'" % name)
+    kinds = self.specs.get(name, [])
+    if len(args) != len(kinds):
+      raise AssemblyError("%s takes %d operands, found %d" %
+                          (name, len(kinds), len(args)))
+    return struct.pack("<B", self.opcodes[name]) + b"".join(
+      self.encode_operand(k, a) for k, a in zip(kinds, args))
+
+  def encode_function(self, function):
+    body = b"".join(
+      self.encode_instruction(name, args)
+      for name, args in function.instructions)
+    return (self.encode_string(function.name) +
+            struct.pack("<BBBI", function.argc, function.retc,
+                        function.locals, len(body)) + body)
+
+  def encode_descriptor(self, descriptor):
+    finaliser = 0
+    if descriptor.finaliser is not None:
+      finaliser = self.function_address(descriptor.finaliser)
+
+    data = self.encode_string(descriptor.name)
+    data += struct.pack("<IIIII", descriptor.method_slots,
+                        len(descriptor.methods), descriptor.field_slots,
+                        len(descriptor.fields), finaliser)
+    for selector, function in descriptor.methods:
+      data += struct.pack("<II", selector, self.function_address(function))
+    for selector in descriptor.fields:
+      data += struct.pack("<I", selector)
+    return data
+
+  def encode_header(self):
+    u64 = INVALID_DESCRIPTOR
+    if self.u64 is not None:
+      u64 = self.descriptor_index(self.u64)
+
+    data = struct.pack("<II", MAGIC_NUMBER, len(self.descriptors))
+    data += b"".join(self.encode_descriptor(d) for d in self.descriptors)
+    data += struct.pack("<III", self.descriptor_index(self.entry[0]),
+                        self.entry[1], u64)
+    return data
+
+  def assemble(self):
+    # The size of the header does not depend on the addresses of functions,
+    # so it can be computed with placeholder addresses first.
+    for function in self.functions:
+      function.address = 0
+    address = len(self.encode_header())
+
+    # Likewise, function sizes do not depend on each other's addresses.
+    for function in self.functions:
+      function.address = address
+      address += len(self.encode_function(function))
+
+    return self.encode_header() + b"".join(
+      self.encode_function(f) for f in self.functions)
+
+
+def main():
+  parser = argparse.ArgumentParser(
+    description="Assemble a textual bytecode program.")
+  parser.add_argument("input")
+  parser.add_argument("-o", "--output", required=True)
+  args = parser.parse_args()
+
+  with open(BYTECODE_H) as f:
+    header = f.read()
+  with open(args.input) as f:
+    text = f.read()
+
+  try:
+    assembler = Assembler(header)
+    assembler.parse(text)
+    data = assembler.assemble()
+  except AssemblyError as e:
+    print("%s: %s" % (args.input, e), file=sys.stderr)
+    sys.exit(1)
+
+  with open(args.output, "wb") as f:
+    f.write(data)
+
+
+if __name__ == "__main__":
+  main()
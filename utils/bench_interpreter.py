@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+
+# Benchmark the bytecode interpreter on the demo programs.
+#
+# Each program in testsuite/demo/run-pass is compiled once with veronac, then
+# run a number of times with the interpreter. The minimum and median wall-clock
+# times are reported for each program.
+#
+# If a baseline interpreter is given, every program is also run with it, and
+# the speedup of the interpreter over the baseline is reported for each
+# program, followed by the geometric mean speedup over all of them.
+#
+# Usage:
+#   bench_interpreter.py --veronac BUILD/dist/veronac \
+#     --interpreter BUILD/dist/interpreter [--baseline OLD/interpreter]
+
+import argparse
+import glob
+import os
+import os.path
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEMO_DIR = os.path.join(ROOT, "testsuite", "demo", "run-pass")
+
+
+def compile_program(veronac, source, output):
+  subprocess.run([veronac, source, "--output=" + output], check=True,
+                 stdout=subprocess.DEVNULL)
+
+
+def time_program(interpreter, bytecode, runs, extra_args):
+  times = []
+  for _ in range(runs):
+    start = time.perf_counter()
+    subprocess.run([interpreter, bytecode] + extra_args, check=True,
+                   stdout=subprocess.DEVNULL)
+    times.append(time.perf_counter() - start)
+  return min(times), statistics.median(times)
+
+
+def main():
+  parser = argparse.ArgumentParser(
+    description="Benchmark the interpreter on the demo programs.")
+  parser.add_argument("--veronac", required=True)
+  parser.add_argument("--interpreter", required=True)
+  parser.add_argument("--baseline")
+  parser.add_argument("--runs", type=int, default=10)
+  parser.add_argument("--filter", default="*",
+                      help="Glob pattern of the programs to run")
+  parser.add_argument("interpreter_args", nargs="*",
+                      help="Extra arguments passed to the interpreters")
+  args = parser.parse_args()
+
+  sources = sorted(glob.glob(os.path.join(DEMO_DIR, args.filter + ".verona")))
+  if not sources:
+    print("No programs found in %s" % DEMO_DIR, file=sys.stderr)
+    sys.exit(1)
+
+  header = "%-20s %10s %10s" % ("program", "min (s)", "median (s)")
+  if args.baseline:
+    header += " %10s %10s" % ("base (s)", "speedup")
+  print(header)
+
+  speedups = []
+  with tempfile.TemporaryDirectory() as tmp:
+    for source in sources:
+      name = os.path.splitext(os.path.basename(source))[0]
+      bytecode = os.path.join(tmp, name + ".vbc")
+      compile_program(args.veronac, source, bytecode)
+
+      best, median = time_program(
+        args.interpreter, bytecode, args.runs, args.interpreter_args)
+      line = "%-20s %10.4f %10.4f" % (name, best, median)
+
+      if args.baseline:
+        _, base = time_program(
+          args.baseline, bytecode, args.runs, args.interpreter_args)
+        line += " %10.4f %9.2fx" % (base, base / median)
+        speedups.append(base / median)
+
+      print(line)
+
+  if speedups:
+    print("%-20s %10s %10s %10s %9.2fx" % (
+      "geomean", "", "", "", statistics.geometric_mean(speedups)))
+
+
+if __name__ == "__main__":
+  main()